@@ -0,0 +1,60 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/* Merges OutputContainer files, e.g. the per-rank containers of a 
+ * simulation, into a single container. Streams with the same name, size
+ * and metadata are combined, other streams which share a name are renamed
+ * to name@k, where k is the number of the input file. Chunks are copied 
+ * unchanged in the order of their first time step. */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "auryn_global.h"
+#include "auryn_definitions.h"
+#include "Logger.h"
+#include "OutputContainer.h"
+
+using namespace std;
+
+int main(int ac, char* av[]) 
+{
+	if ( ac < 3 ) {
+		cout << "Usage: aucmerge output input [input ...]" << "\n";
+		return 1;
+	}
+
+	logger = new Logger("",0,WARNING,NONE);
+
+	int errcode = 0;
+	try {
+		vector<string> inputs(av+2,av+ac);
+		const boost::uint64_t records = OutputContainer::merge(av[1],inputs);
+		ContainerReader merged(av[1]);
+		cout << "Merged " << records << " records in " << merged.get_index().size() << " chunks of " 
+			<< merged.get_num_streams() << " streams." << endl;
+	} catch ( exception & e ) {
+		cerr << "error: " << e.what() << endl;
+		errcode = 1;
+	}
+
+	delete logger;
+	return errcode;
+}
@@ -0,0 +1,148 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Converts binary spike files written by BinarySpikeMonitor or 
+ * BinarySpikeWriter to the ras text format of SpikeMonitor or, with 
+ * --indexed, delta-encoded files to indexed files which can be replayed. 
+ * With --partitions the indexed file is split by neuron ID such that each
+ * rank of a distributed replay only reads its own neurons. */
+
+#include <iostream>
+#include <stdio.h>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include "auryn_global.h"
+#include "auryn_definitions.h"
+#include "Logger.h"
+#include "BinarySpikeFile.h"
+
+using namespace std;
+
+namespace po = boost::program_options;
+
+int main(int ac, char* av[]) 
+{
+	string infilename;
+	string outfilename;
+	bool indexed = false;
+	unsigned int partitions = 1;
+	double from = 0.0;
+	double to = -1.0;
+
+    try {
+
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("help", "produce help message")
+            ("input", po::value<string>(), "binary spike file")
+            ("output", po::value<string>(), "output file")
+            ("indexed", "write an indexed binary spike file instead of text")
+            ("partitions", po::value<unsigned int>(), "number of partitions of the indexed file, a multiple of the number of ranks which replay it")
+            ("from", po::value<double>(), "first time to convert in s")
+            ("to", po::value<double>(), "last time to convert in s")
+        ;
+
+        po::positional_options_description pos;
+        pos.add("input", 1);
+        pos.add("output", 1);
+
+        po::variables_map vm;        
+        po::store(po::command_line_parser(ac, av).options(desc).positional(pos).run(), vm);
+        po::notify(vm);    
+
+        if (vm.count("help") || !vm.count("input") || !vm.count("output")) {
+            cout << "Usage: spk2ras [options] input output" << "\n";
+            cout << desc << "\n";
+            return 1;
+        }
+
+        infilename = vm["input"].as<string>();
+        outfilename = vm["output"].as<string>();
+
+        if (vm.count("indexed")) {
+			indexed = true;
+        } 
+
+        if (vm.count("partitions")) {
+			indexed = true;
+			partitions = vm["partitions"].as<unsigned int>();
+        } 
+
+        if (vm.count("from")) {
+			from = vm["from"].as<double>();
+        } 
+
+        if (vm.count("to")) {
+			to = vm["to"].as<double>();
+        } 
+    }
+    catch(exception& e) {
+        cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    catch(...) {
+        cerr << "Exception of unknown type!\n";
+    }
+
+	logger = new Logger("",0,WARNING,NONE);
+
+	int errcode = 0;
+	try {
+		BinarySpikeReader reader(infilename);
+		const AurynFloat timestep = reader.get_header().dt;
+		const AurynTime tfrom = (AurynTime)(from/timestep+0.5);
+		const AurynTime tto = to < 0 ? reader.get_header().last_time : (AurynTime)(to/timestep+0.5);
+
+		AurynTime t;
+		NeuronID i;
+		unsigned long count = 0;
+		if ( indexed ) {
+			BinarySpikeWriter writer(outfilename,timestep,BINARYSPIKEFILE_INDEX_INTERVAL,BINARYSPIKE_INDEXED,partitions);
+			writer.set_size(reader.get_header().size);
+			while ( reader.next(t,i) && t <= tto ) {
+				if ( t < tfrom ) continue;
+				writer.write(t,i);
+				++count;
+			}
+			writer.close();
+		} else {
+			FILE * outfile = fopen(outfilename.c_str(),"w");
+			if ( outfile == NULL ) {
+				cerr << "Can't open output file " << outfilename << endl;
+				return 1;
+			}
+			while ( reader.next(t,i) && t <= tto ) {
+				if ( t < tfrom ) continue;
+				fprintf(outfile,"%f  %u\n",timestep*t,i);
+				++count;
+			}
+			fclose(outfile);
+		}
+		cout << "Converted " << count << " spikes." << endl;
+	} catch ( exception & e ) {
+		cerr << "error: " << e.what() << endl;
+		errcode = 1;
+	}
+
+	delete logger;
+	return errcode;
+}
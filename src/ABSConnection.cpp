@@ -30,7 +30,7 @@ void ABSConnection::init(AurynWeight maxw)
 	if ( dst->get_post_size() == 0 ) return;
 
 	tr_post = new EulerTrace(dst->get_post_size(),tau_post);
-	tr_post->set_target(dst->get_mem_ptr());
+	tr_post->set_target(dst->get_state_vector("mem"));
 
 	voltage_curve_post 
 		= new AurynFloat[ABS_VOLTAGE_CURVE_SIZE];
@@ -96,14 +96,13 @@ void ABSConnection::propagate_forward()
 	NeuronID * ind = w->get_row_begin(0); // first element of index array
 	AurynWeight * data = w->get_data_begin();
 	AurynWeight value;
-	TransmitterType transmitter = get_transmitter();
 	SpikeContainer::const_iterator spikes_end = src->get_spikes()->end();
 	// process spikes
 	for (SpikeContainer::const_iterator spike = src->get_spikes()->begin() ; // spike = pre_spike
 			spike != spikes_end ; ++spike ) {
 		for (NeuronID * c = w->get_row_begin(*spike) ; c != w->get_row_end(*spike) ; ++c ) {
 			value = data[c-ind]; 
-			dst->tadd( *c , value , transmitter );
+			transmit( *c , value );
 			if (data[c-ind]>0 && data[c-ind]<get_max_weight())
 			  data[c-ind] += dw_fwd(*c);
 		}
@@ -119,6 +118,11 @@ void ABSConnection::propagate_backward()
 
 void ABSConnection::propagate()
 {
+	if ( consolidated ) {
+		SparseConnection::propagate();
+		tr_post->follow();
+		return;
+	}
 	// propagate
 	propagate_forward();
 	propagate_backward();
@@ -30,7 +30,7 @@ AIF2Group::AIF2Group( NeuronID size, AurynFloat load, NeuronID total ) : AIFGrou
 void AIF2Group::calculate_scale_constants()
 {
 	AIFGroup::calculate_scale_constants();
-	scale_adapt2 = exp(-dt/tau_adapt2);
+	scale_adapt2 = exp(-(adapt_interval*dt)/tau_adapt2);
 }
 
 void AIF2Group::init()
@@ -86,8 +86,10 @@ void AIF2Group::integrate_linear_nmda_synapses()
 	// decay of ampa and gaba channel, i.e. multiply by exp(-dt/tau)
     auryn_vector_float_scale(scale_ampa,g_ampa);
     auryn_vector_float_scale(scale_gaba,g_gaba);
-    auryn_vector_float_scale(scale_adapt1,g_adapt1);
-    auryn_vector_float_scale(scale_adapt2,g_adapt2);
+	if ( adapt_update_step() ) {
+		auryn_vector_float_scale(scale_adapt1,g_adapt1);
+		auryn_vector_float_scale(scale_adapt2,g_adapt2);
+	}
 
     // compute dg_nmda = (g_ampa-g_nmda)*dt/tau_nmda and add to g_nmda
 	AurynFloat mul_nmda = dt/tau_nmda;
@@ -114,19 +116,13 @@ void AIF2Group::check_thresholds()
 {
 	auryn_vector_float_clip( mem, e_rev );
 
-	float * thr_ptr = thr->data;
-	for ( float * i = mem->data ; i != mem->data+get_rank_size() ; ++i ) { // it's important to use rank_size here otherwise there might be spikes from units that do not exist
-    	if ( *i > ( thr_rest + *thr_ptr ) ) {
-			NeuronID unit = i-mem->data;
-			push_spike(unit);
-		    set_val (mem, unit, e_rest); // reset
-	        set_val (thr, unit, dthr); //refractory
-			add_val (g_adapt1, unit, dg_adapt1);
-			add_val (g_adapt2, unit, dg_adapt2);
-		} 
-		thr_ptr++;
-	}
-
+	// it's important to use rank_size here otherwise there might be spikes from units that do not exist
+	threshold_crossings.clear();
+	auryn_vector_float_check_thresholds( mem, thr, thr_rest, e_rest, dthr, get_rank_size(), 
+			&threshold_crossings, g_adapt1, dg_adapt1 );
+	for ( SpikeContainer::const_iterator i = threshold_crossings.begin() ; i != threshold_crossings.end() ; ++i ) 
+		add_val (g_adapt2, *i, dg_adapt2);
+	push_spikes( &threshold_crossings );
 }
 
 void AIF2Group::evolve()
@@ -136,5 +132,10 @@ void AIF2Group::evolve()
 	check_thresholds();
 }
 
+bool AIF2Group::at_rest()
+{
+	return AIFGroup::at_rest() && within_rest_tolerance(g_adapt2,0.0);
+}
+
 
 
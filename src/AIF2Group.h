@@ -41,6 +41,8 @@ protected:
 	void calculate_scale_constants();
 	void integrate_linear_nmda_synapses();
 	void check_thresholds();
+	/*! Returns true if also g_adapt2 is within rest_tolerance of zero */
+	virtual bool at_rest();
 
 public:
 	AIF2Group( NeuronID size, AurynFloat load = 1.0, NeuronID total = 0 );
@@ -26,7 +26,11 @@
 #include "System.h"
 #include <gsl/gsl_blas.h>
 
-/*! \brief A simple extension of IFGroup with spike triggered adaptation */
+/*! \brief A simple extension of IFGroup with spike triggered adaptation 
+ *
+ * With CODE_USE_FUSED_NEURON_KERNELS (the default) the state vectors t_exc,
+ * t_inh and t_leak are not updated and hold stale values if recorded.
+ */
 class AIFGroup : public NeuronGroup
 {
 private:
@@ -42,6 +46,10 @@ protected:
 	AurynFloat scale_ampa,scale_gaba, scale_thr;
 	AurynFloat scale_adapt1;
 	AurynFloat tau_adapt1;
+	/*! Number of time steps between two updates of the adaptation conductances */
+	unsigned int adapt_interval;
+	/*! Time step offset of the adaptation updates to stagger them across groups */
+	unsigned int adapt_phase;
 
 
 	AurynFloat e_rest,e_rev,thr_rest,tau_mem,tau_thr,dthr;
@@ -53,6 +61,19 @@ protected:
 	void integrate_linear_nmda_synapses();
 	void integrate_membrane();
 	void check_thresholds();
+	/*! Performs the same Euler step as integrate_linear_nmda_synapses(),
+	 * integrate_membrane() and check_thresholds() in a single pass over the
+	 * state vectors without temporary vectors. The arithmetic is carried out 
+	 * in the same order, which gives the same results as the multi-pass
+	 * implementation up to compiler reassociation (see 
+	 * CODE_USE_FUSED_NEURON_KERNELS). Note that t_exc, t_inh and t_leak are 
+	 * not updated. */
+	void integrate_fused();
+	/*! Returns true if the adaptation conductances are updated in the current time step */
+	bool adapt_update_step();
+	/*! Returns true if mem, thr, all conductances and g_adapt1 are within rest_tolerance of rest 
+	 * (approximate, see NeuronGroup::set_rest_tolerance) */
+	virtual bool at_rest();
 public:
 	AurynFloat dg_adapt1;
 
@@ -70,7 +91,10 @@ public:
 	AurynFloat get_tau_adapt();
 	void random_adapt(AurynState mean, AurynState sigma);
 	void set_ampa_nmda_ratio(AurynFloat ratio);
-	void calculate_scale_constants();
+	/*! Integrates the slow adaptation conductances only every k time steps with the 
+	 * exact decay over k*dt. Spike triggered increments are applied immediately. */
+	void set_adapt_subsampling(unsigned int k);
+	virtual void calculate_scale_constants();
 
 
 	void clear();
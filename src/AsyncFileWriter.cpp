@@ -0,0 +1,149 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AsyncFileWriter.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+AsyncFileWriter::AsyncFileWriter(string filename)
+{
+	fname = filename;
+	fd = ::open(filename.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+	if ( fd < 0 ) {
+		stringstream oss;
+		oss << "AsyncFileWriter:: Can't open " << filename;
+		logger->msg(oss.str(),ERROR);
+		throw AurynOpenFileException();
+	}
+
+	fill = 0;
+	handed = 0;
+	is_open = true;
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+	close();
+}
+
+void AsyncFileWriter::hand_over()
+{
+	if ( fill == 0 ) return;
+	// looked up every time, processes forked by ParameterSweep have their own service
+	AsyncIOService::instance()->write(fd,buffer,fill);
+	handed += fill;
+	fill = 0;
+}
+
+void AsyncFileWriter::write_slow(const void * data, size_t size)
+{
+	if ( !is_open ) return;
+	hand_over();
+	if ( size < ASYNCFILEWRITER_BUFFER_SIZE ) {
+		memcpy(buffer,data,size);
+		fill = size;
+	} else { // large writes go to the service directly
+		AsyncIOService::instance()->write(fd,data,size);
+		handed += size;
+	}
+}
+
+boost::uint64_t AsyncFileWriter::tell()
+{
+	return handed+fill;
+}
+
+void AsyncFileWriter::flush()
+{
+	if ( !is_open ) return;
+	hand_over();
+	AsyncIOService::instance()->flush();
+}
+
+void AsyncFileWriter::write_at(boost::uint64_t offset, const void * data, size_t size)
+{
+	if ( !is_open ) return;
+	flush();
+	if ( pwrite(fd,data,size,offset) != (ssize_t)size ) {
+		stringstream oss;
+		oss << "AsyncFileWriter:: Could not write to " << fname;
+		logger->msg(oss.str(),ERROR);
+	}
+}
+
+void AsyncFileWriter::close()
+{
+	if ( !is_open ) return;
+	flush(); // queued blocks refer to fd
+	::close(fd);
+	is_open = false;
+}
+
+
+AsyncStreamBuffer::AsyncStreamBuffer(string filename) : writer(filename)
+{
+	setp(buffer,buffer+ASYNCSTREAMBUFFER_SIZE);
+}
+
+AsyncStreamBuffer::~AsyncStreamBuffer()
+{
+	sync();
+	writer.close();
+}
+
+AsyncStreamBuffer::int_type AsyncStreamBuffer::overflow(int_type c)
+{
+	sync();
+	if ( c != traits_type::eof() ) {
+		*pptr() = c;
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+streamsize AsyncStreamBuffer::xsputn(const char * s, streamsize n)
+{
+	if ( n > epptr()-pptr() ) {
+		sync();
+		if ( n > epptr()-pptr() ) { // pass long strings on directly
+			writer.write(s,n);
+			return n;
+		}
+	}
+	memcpy(pptr(),s,n);
+	pbump(n);
+	return n;
+}
+
+int AsyncStreamBuffer::sync()
+{
+	// only moves the data to the writer; the service writes it later
+	if ( pptr() > pbase() ) 
+		writer.write(pbase(),pptr()-pbase());
+	setp(buffer,buffer+ASYNCSTREAMBUFFER_SIZE);
+	return 0;
+}
+
+void AsyncStreamBuffer::flush()
+{
+	sync();
+	writer.flush();
+}
@@ -0,0 +1,109 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASYNCFILEWRITER_H_
+#define ASYNCFILEWRITER_H_
+
+#include "auryn_definitions.h"
+#include "AsyncIOService.h"
+
+#include <string>
+#include <cstring>
+#include <streambuf>
+#include <boost/cstdint.hpp>
+
+#define ASYNCFILEWRITER_BUFFER_SIZE 4096 //!< Size of the buffer of AsyncFileWriter
+#define ASYNCSTREAMBUFFER_SIZE 4096 //!< Size of the put area of AsyncStreamBuffer
+
+using namespace std;
+
+/*! \brief Output file which is written by the AsyncIOService
+ *
+ * Data passed to write() is collected in a small buffer and then appended 
+ * to the blocks of the AsyncIOService, which are shared by all files of the
+ * process. Full blocks are written to disk by the writer thread of the 
+ * service while the simulation fills the next block. The simulation only 
+ * waits if the disk can not keep up with the data rate. 
+ */
+class AsyncFileWriter
+{
+private:
+	int fd;
+	string fname;
+	char buffer [ASYNCFILEWRITER_BUFFER_SIZE];
+	size_t fill;
+	/*! Number of bytes handed to the service so far */
+	boost::uint64_t handed;
+	bool is_open;
+
+	/*! Hands the buffer to the service */
+	void hand_over();
+	void write_slow(const void * data, size_t size);
+
+public:
+	/*! Opens filename for writing. Throws AurynOpenFileException. */
+	AsyncFileWriter(string filename);
+	/*! Closes the file */
+	virtual ~AsyncFileWriter();
+
+	/*! Appends size bytes to the file */
+	void write(const void * data, size_t size) {
+		if ( fill+size <= ASYNCFILEWRITER_BUFFER_SIZE ) {
+			memcpy(buffer+fill,data,size);
+			fill += size;
+		} else write_slow(data,size);
+	}
+	/*! Returns the number of bytes written so far */
+	boost::uint64_t tell();
+	/*! Waits until all data is written to the file */
+	void flush();
+	/*! Flushes and overwrites size bytes at byte offset in the file */
+	void write_at(boost::uint64_t offset, const void * data, size_t size);
+	/*! Flushes and closes the file */
+	void close();
+};
+
+/*! \brief Stream buffer which writes through an AsyncFileWriter
+ *
+ * Used by Monitor for its text output stream. Flushing the stream (e.g. 
+ * with endl) does not wait for the disk; call flush() for that. 
+ */
+class AsyncStreamBuffer : public streambuf
+{
+private:
+	AsyncFileWriter writer;
+	char buffer [ASYNCSTREAMBUFFER_SIZE];
+
+protected:
+	virtual int_type overflow(int_type c);
+	virtual streamsize xsputn(const char * s, streamsize n);
+	virtual int sync();
+
+public:
+	/*! Opens filename for writing. Throws AurynOpenFileException. */
+	AsyncStreamBuffer(string filename);
+	virtual ~AsyncStreamBuffer();
+	/*! Waits until all data is written to the file */
+	void flush();
+};
+
+extern Logger * logger;
+
+#endif /*ASYNCFILEWRITER_H_*/
@@ -0,0 +1,274 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AsyncIOService.h"
+
+#include <unistd.h>
+#include <sys/time.h>
+
+AsyncIOService * AsyncIOService::service = NULL;
+bool AsyncIOService::fork_handler_installed = false;
+
+AsyncIOService * AsyncIOService::instance()
+{
+	if ( service == NULL ) {
+		if ( !fork_handler_installed ) {
+			pthread_atfork(NULL,NULL,reset_after_fork);
+			fork_handler_installed = true;
+		}
+		service = new AsyncIOService();
+	}
+	return service;
+}
+
+void AsyncIOService::reset_after_fork()
+{
+	// the writer thread of the parent does not exist in the child, its 
+	// instance is dropped without cleanup
+	service = NULL;
+}
+
+AsyncIOService::AsyncIOService(unsigned int n)
+{
+	current = NULL;
+	max_queue = max(n,1u);
+	busy = false;
+	stop = false;
+	stats.bytes = 0;
+	stats.blocks = 0;
+	stats.stalls = 0;
+	stats.stall_time = 0.0;
+	stats.peak_queue = 0;
+	stats.errors = 0;
+
+	pthread_mutex_init(&current_mutex,NULL);
+	pthread_mutex_init(&mutex,NULL);
+	pthread_cond_init(&cond_queued,NULL);
+	pthread_cond_init(&cond_written,NULL);
+	if ( pthread_create(&thread,NULL,run_writer,this) ) {
+		logger->msg("AsyncIOService:: Can't start writer thread",ERROR);
+		throw AurynOpenFileException();
+	}
+}
+
+AsyncIOService::~AsyncIOService()
+{
+	flush();
+	pthread_mutex_lock(&mutex);
+	stop = true;
+	pthread_cond_signal(&cond_queued);
+	pthread_mutex_unlock(&mutex);
+	pthread_join(thread,NULL);
+
+	for ( unsigned int i = 0 ; i < free_blocks.size() ; ++i ) {
+		delete [] free_blocks[i]->data;
+		delete free_blocks[i];
+	}
+	pthread_cond_destroy(&cond_written);
+	pthread_cond_destroy(&cond_queued);
+	pthread_mutex_destroy(&mutex);
+	pthread_mutex_destroy(&current_mutex);
+	if ( service == this ) service = NULL;
+}
+
+void * AsyncIOService::run_writer(void * service)
+{
+	((AsyncIOService *)service)->write_blocks();
+	return NULL;
+}
+
+void AsyncIOService::write_blocks()
+{
+	pthread_mutex_lock(&mutex);
+	while ( true ) {
+		while ( queue.empty() && !stop ) 
+			pthread_cond_wait(&cond_queued,&mutex);
+		if ( queue.empty() ) break; // stop with nothing left to write
+
+		IOBlock * block = queue.front();
+		queue.pop_front();
+		busy = true;
+		pthread_mutex_unlock(&mutex);
+
+		bool failed = false;
+		for ( unsigned int i = 0 ; i < block->segments.size() ; ++i ) {
+			const IOSegment & segment = block->segments[i];
+			const char * data = block->data+segment.begin;
+			size_t left = segment.size;
+			while ( left > 0 ) {
+				const ssize_t n = ::write(segment.fd,data,left);
+				if ( n <= 0 ) { // the writer thread must not log
+					failed = true;
+					break;
+				}
+				data += n;
+				left -= n;
+			}
+		}
+
+		pthread_mutex_lock(&mutex);
+		busy = false;
+		stats.bytes += block->fill;
+		stats.blocks++;
+		if ( failed ) stats.errors++;
+		block->fill = 0;
+		block->segments.clear();
+		if ( free_blocks.size() < ASYNCIOSERVICE_MAX_FREE ) {
+			free_blocks.push_back(block);
+		} else {
+			delete [] block->data;
+			delete block;
+		}
+		pthread_cond_broadcast(&cond_written);
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+IOBlock * AsyncIOService::acquire()
+{
+	IOBlock * block = NULL;
+	pthread_mutex_lock(&mutex);
+	if ( !free_blocks.empty() ) {
+		block = free_blocks.back();
+		free_blocks.pop_back();
+	}
+	pthread_mutex_unlock(&mutex);
+
+	if ( block == NULL ) {
+		block = new IOBlock;
+		block->data = new char [ASYNCIOSERVICE_BLOCK_SIZE];
+		block->fill = 0;
+	}
+	return block;
+}
+
+void AsyncIOService::submit(IOBlock * block)
+{
+	if ( block->fill == 0 ) {
+		release(block);
+		return;
+	}
+
+	pthread_mutex_lock(&mutex);
+	if ( queue.size() >= max_queue ) { // backpressure
+		struct timeval start, end;
+		gettimeofday(&start,NULL);
+		while ( queue.size() >= max_queue ) 
+			pthread_cond_wait(&cond_written,&mutex);
+		gettimeofday(&end,NULL);
+		stats.stalls++;
+		stats.stall_time += (end.tv_sec-start.tv_sec)+1e-6*(end.tv_usec-start.tv_usec);
+	}
+	queue.push_back(block);
+	stats.peak_queue = max(stats.peak_queue,(unsigned int)queue.size());
+	pthread_cond_signal(&cond_queued);
+	pthread_mutex_unlock(&mutex);
+}
+
+void AsyncIOService::release(IOBlock * block)
+{
+	block->fill = 0;
+	block->segments.clear();
+	pthread_mutex_lock(&mutex);
+	if ( free_blocks.size() < ASYNCIOSERVICE_MAX_FREE ) {
+		free_blocks.push_back(block);
+		block = NULL;
+	}
+	pthread_mutex_unlock(&mutex);
+	if ( block != NULL ) {
+		delete [] block->data;
+		delete block;
+	}
+}
+
+void AsyncIOService::write(int fd, const void * data, size_t size)
+{
+	const char * bytes = (const char *)data;
+	pthread_mutex_lock(&current_mutex);
+	while ( size > 0 ) {
+		if ( current == NULL ) 
+			current = acquire();
+		const size_t n = min(size,ASYNCIOSERVICE_BLOCK_SIZE-current->fill);
+		// segments are appended in order, the last one ends at fill
+		if ( !current->segments.empty() && current->segments.back().fd == fd ) {
+			current->segments.back().size += n;
+		} else {
+			IOSegment segment;
+			segment.fd = fd;
+			segment.begin = current->fill;
+			segment.size = n;
+			current->segments.push_back(segment);
+		}
+		memcpy(current->data+current->fill,bytes,n);
+		current->fill += n;
+		bytes += n;
+		size -= n;
+		if ( current->fill == ASYNCIOSERVICE_BLOCK_SIZE ) {
+			submit(current);
+			current = NULL;
+		}
+	}
+	pthread_mutex_unlock(&current_mutex);
+}
+
+void AsyncIOService::flush()
+{
+	pthread_mutex_lock(&current_mutex);
+	if ( current != NULL ) {
+		submit(current);
+		current = NULL;
+	}
+	pthread_mutex_unlock(&current_mutex);
+
+	pthread_mutex_lock(&mutex);
+	while ( !queue.empty() || busy ) 
+		pthread_cond_wait(&cond_written,&mutex);
+	pthread_mutex_unlock(&mutex);
+}
+
+void AsyncIOService::set_max_queue(unsigned int n)
+{
+	pthread_mutex_lock(&mutex);
+	max_queue = max(n,1u);
+	pthread_mutex_unlock(&mutex);
+}
+
+IOStatistics AsyncIOService::get_statistics()
+{
+	pthread_mutex_lock(&mutex);
+	IOStatistics result = stats;
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+void AsyncIOService::log_statistics()
+{
+	const IOStatistics s = get_statistics();
+	stringstream oss;
+	oss << "AsyncIOService:: Wrote " << s.bytes/1048576.0 << "MB in " 
+		<< s.blocks << " blocks, peak queue " << s.peak_queue << ", "
+		<< s.stalls << " stalls (" << s.stall_time << "s)";
+	logger->msg(oss.str(),NOTIFICATION);
+	if ( s.errors > 0 ) {
+		oss.str("");
+		oss << "AsyncIOService:: " << s.errors << " blocks could not be written completely";
+		logger->msg(oss.str(),ERROR);
+	}
+}
@@ -0,0 +1,146 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASYNCIOSERVICE_H_
+#define ASYNCIOSERVICE_H_
+
+#include "auryn_definitions.h"
+
+#include <deque>
+#include <vector>
+#include <pthread.h>
+#include <sys/types.h>
+#include <boost/cstdint.hpp>
+
+#define ASYNCIOSERVICE_BLOCK_SIZE 262144 //!< Size of the shared aggregation blocks in bytes
+#define ASYNCIOSERVICE_MAX_QUEUE 64 //!< Maximum number of blocks waiting to be written
+#define ASYNCIOSERVICE_MAX_FREE 16 //!< Number of empty blocks kept for reuse
+
+using namespace std;
+
+/*! \brief Contiguous part of an IOBlock which belongs to one file */
+struct IOSegment
+{
+	/*! File descriptor the segment is written to */
+	int fd;
+	/*! Offset of the segment in the block */
+	size_t begin;
+	size_t size;
+};
+
+/*! \brief Memory block which aggregates the output of all clients and is written by AsyncIOService */
+struct IOBlock
+{
+	char * data;
+	size_t fill;
+	/*! Segments in the order they were appended */
+	vector<IOSegment> segments;
+};
+
+/*! \brief Statistics of an AsyncIOService */
+struct IOStatistics
+{
+	boost::uint64_t bytes;
+	boost::uint64_t blocks;
+	/*! Number of times a client had to wait because the queue was full */
+	boost::uint64_t stalls;
+	/*! Total time clients waited for the queue in seconds */
+	double stall_time;
+	/*! Largest number of blocks in the queue */
+	unsigned int peak_queue;
+	/*! Number of failed writes */
+	boost::uint64_t errors;
+};
+
+/*! \brief Per-rank service which writes the output of all monitors in a background thread
+ *
+ * Clients (AsyncFileWriter and through it the output streams of all 
+ * Monitor objects) buffer a few KB and pass them to write(), which 
+ * appends them to a block of ASYNCIOSERVICE_BLOCK_SIZE bytes shared by all 
+ * clients. Each block records which of its segments belongs to which file. 
+ * A single writer thread writes full blocks in the order they were 
+ * submitted, so the data of each file stays in order. Memory is bounded 
+ * independently of the number of clients: at most max_queue blocks wait to
+ * be written. If the queue is full, write() blocks until the writer catches
+ * up; these stalls are counted in the statistics. System flushes the 
+ * service at the end of each run.
+ *
+ * There is one instance per process, which is created on first use by 
+ * instance(). Clients look it up for every block they hand over, such that
+ * a process forked by ParameterSweep uses its own instance: the instance of
+ * the parent is dropped in the child, whose copy has no writer thread.
+ */
+class AsyncIOService
+{
+private:
+	static AsyncIOService * service;
+	static bool fork_handler_installed;
+
+	/*! Block filled by write() or NULL */
+	IOBlock * current;
+	deque<IOBlock *> queue;
+	vector<IOBlock *> free_blocks;
+	unsigned int max_queue;
+	/*! Set while the writer thread writes a block */
+	bool busy;
+	bool stop;
+	IOStatistics stats;
+	pthread_t thread;
+	/*! Protects current */
+	pthread_mutex_t current_mutex;
+	/*! Protects queue, free_blocks, busy, stop and stats */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond_queued;
+	pthread_cond_t cond_written;
+
+	static void * run_writer(void * service);
+	/*! Called in the child process after fork */
+	static void reset_after_fork();
+	void write_blocks();
+	/*! Returns an empty block */
+	IOBlock * acquire();
+	/*! Queues a block for writing, waits while the queue is full */
+	void submit(IOBlock * block);
+	/*! Returns a block which is not needed anymore */
+	void release(IOBlock * block);
+
+	AsyncIOService(unsigned int max_queue=ASYNCIOSERVICE_MAX_QUEUE);
+
+public:
+	/*! Returns the service of this process */
+	static AsyncIOService * instance();
+	/*! Stops the writer thread after all blocks are written */
+	virtual ~AsyncIOService();
+
+	/*! Appends size bytes for file descriptor fd */
+	void write(int fd, const void * data, size_t size);
+	/*! Waits until all data passed to write() is written */
+	void flush();
+	/*! Sets the maximum number of blocks waiting to be written */
+	void set_max_queue(unsigned int n);
+	/*! Returns a copy of the statistics */
+	IOStatistics get_statistics();
+	/*! Writes the statistics to the log */
+	void log_statistics();
+};
+
+extern Logger * logger;
+
+#endif /*ASYNCIOSERVICE_H_*/
@@ -50,6 +50,11 @@ AuditoryBeepGroup::~AuditoryBeepGroup()
 {
 }
 
+bool AuditoryBeepGroup::can_skip_steps()
+{
+	return false;
+}
+
 void AuditoryBeepGroup::evolve()
 {
 	if ( sys->get_clock() >= next_event ) {
@@ -56,6 +56,10 @@ private:
 
 	void init ( AurynFloat duration, AurynFloat mean_interval, AurynFloat rate );
 	
+protected:
+	/*! The rate changes in evolve(), no time steps can be skipped */
+	virtual bool can_skip_steps();
+
 public:
 
 	/*! Describes the background firing rate in silence */
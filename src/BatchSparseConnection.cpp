@@ -0,0 +1,146 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BatchSparseConnection.h"
+
+BatchSparseConnection::BatchSparseConnection(SpikingGroup * source, NeuronGroup * destination, NeuronID n, 
+		AurynWeight weight, AurynFloat sparseness, 
+		TransmitterType transmitter, string name) 
+: SparseConnection(source, destination, transmitter)
+{
+	set_name(name);
+	init_batch(n);
+
+	// each rank holds different trials which all need to see the same matrix
+	const bool distributed = dst->get_locked_range() > 1;
+	boost::mt19937 saved_gen = sparse_connection_gen;
+	if ( distributed ) {
+		unsigned int s = sparse_connection_gen();
+		broadcast(*communicator, s, 0);
+		seed(s);
+	}
+
+	AurynLong anticipatedsize = (AurynLong) (estimate_required_nonzero_entires ( sparseness*get_m_rows()*get_n_cols() ) );
+	allocate(anticipatedsize);
+	connect_random(weight,sparseness,skip_diagonal);
+
+	// the shared generator continues where it was such that the 
+	// connections created after this one do not depend on it
+	if ( distributed ) 
+		sparse_connection_gen = saved_gen;
+}
+
+BatchSparseConnection::BatchSparseConnection(SpikingGroup * source, NeuronGroup * destination, NeuronID n, 
+		const char * filename, TransmitterType transmitter) 
+: SparseConnection(source, destination, transmitter)
+{
+	init_batch(n);
+	allocate(1);
+	if ( !load_from_file(filename) ) 
+		throw AurynMMFileException();
+	if ( dst->evolve_locally() && ( get_m_rows()*trials != src->get_size() || get_n_cols()*trials != dst->get_size() ) )
+		throw AurynMatrixDimensionalityException();
+}
+
+BatchSparseConnection::~BatchSparseConnection()
+{
+}
+
+void BatchSparseConnection::init_batch(NeuronID n)
+{
+	trials = n;
+	if ( trials == 0 || src->get_size()%trials || dst->get_size()%trials || trials%dst->get_locked_range() ) {
+		stringstream oss;
+		oss << "BatchSparseConnection: ("<< get_name() <<"): Cannot split groups of size " 
+			<< src->get_size() << " and " << dst->get_size() << " into " << trials 
+			<< " trials on " << dst->get_locked_range() << " ranks.";
+		logger->msg(oss.str(),ERROR);
+		throw AurynBatchSizeException();
+	}
+	trial_stride = dst->get_locked_range();
+	trial_offset = communicator->rank()-dst->get_locked_rank();
+	local_trials = trials/trial_stride;
+	spiking_trials.reserve(local_trials);
+
+	// the matrix only spans a single trial
+	set_size(src->get_size()/trials,dst->get_size()/trials);
+	dist_optimized = false;
+
+	stringstream oss;
+	oss << "BatchSparseConnection: ("<< get_name() <<"): Sharing a " 
+		<< get_m_rows() << "x" << get_n_cols() << " matrix between " << trials 
+		<< " trials (" << local_trials << " on this rank)";
+	logger->msg(oss.str(),NOTIFICATION);
+}
+
+NeuronID BatchSparseConnection::get_trials()
+{
+	return trials;
+}
+
+bool BatchSparseConnection::push_back(NeuronID i, NeuronID j, AurynWeight weight) 
+{
+	w->push_back(i,j,weight);
+	return true;
+}
+
+void BatchSparseConnection::propagate()
+{
+	if ( !dst->evolve_locally() ) return;
+
+	SpikeContainer * spikes = src->get_spikes();
+	NeuronID * ind = w->get_ind_begin(); 
+	AurynWeight * data = w->get_data_begin();
+
+	// Spikes of one presynaptic neuron in different trials have consecutive 
+	// IDs and are gathered such that its row is read only once.
+	SpikeContainer::const_iterator spike = spikes->begin();
+	while ( spike != spikes->end() ) {
+		const NeuronID pre = *spike/trials;
+		spiking_trials.clear();
+		for ( ; spike != spikes->end() && *spike/trials == pre ; ++spike ) {
+			const NeuronID trial = *spike%trials;
+			if ( trial%trial_stride == trial_offset ) 
+				spiking_trials.push_back(trial/trial_stride);
+		}
+		if ( spiking_trials.empty() ) continue;
+
+		const NeuronID k = spiking_trials.size();
+		const NeuronID * tr = &spiking_trials[0];
+		for ( NeuronID * c = w->get_row_begin(pre) ; c != w->get_row_end(pre) ; ++c ) {
+			const AurynWeight value = data[c-ind]; 
+			AurynFloat * t = target + (*c)*local_trials;
+			for ( NeuronID l = 0 ; l < k ; ++l ) 
+				t[tr[l]] += value;
+		}
+	}
+}
+
+void BatchSparseConnection::mark_targets()
+{
+	SpikeContainer * spikes = src->get_spikes();
+	for ( SpikeContainer::const_iterator spike = spikes->begin() ; spike != spikes->end() ; ++spike ) {
+		const NeuronID pre = *spike/trials;
+		const NeuronID trial = *spike%trials;
+		if ( trial%trial_stride != trial_offset ) continue;
+		for ( NeuronID * c = w->get_row_begin(pre) ; c != w->get_row_end(pre) ; ++c ) 
+			dst->mark_input((*c)*local_trials+trial/trial_stride);
+	}
+}
@@ -0,0 +1,81 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BATCHSPARSECONNECTION_H_
+#define BATCHSPARSECONNECTION_H_
+
+#include "auryn_definitions.h"
+#include "SparseConnection.h"
+
+using namespace std;
+
+/*! \brief Connects several independent trials of the same network through one shared weight matrix
+ *
+ * Source and destination are ordinary groups which hold all trials, i.e. their 
+ * size is the number of neurons times the number of trials. The state of neuron 
+ * i in trial k is stored in unit i*trials+k such that the trial dimension is 
+ * interleaved in all state vectors. Trials can differ in their inputs (e.g. an 
+ * input group of the batched size draws independent spikes in each trial) and in 
+ * all parameters the destination group stores per unit (e.g. bg_current).
+ *
+ * The weight matrix has the size of a single trial. Propagation reads the row of 
+ * a presynaptic neuron once and delivers each weight to all trials in which that 
+ * neuron spiked, which shares the memory traffic of the matrix between trials. 
+ * The matrix is static; plasticity is not supported.
+ *
+ * When the destination is distributed, every rank holds the full matrix and a 
+ * subset of the trials. The number of trials then has to be a multiple of the 
+ * number of ranks.
+ */
+class BatchSparseConnection : public SparseConnection
+{
+private:
+	/*! Number of trials */
+	NeuronID trials;
+	/*! Number of trials on this rank */
+	NeuronID local_trials;
+	/*! Trial k is on this rank if k%trial_stride equals trial_offset */
+	NeuronID trial_stride, trial_offset;
+	/*! Local trial indices of the current presynaptic neuron */
+	vector<NeuronID> spiking_trials;
+
+	void init_batch(NeuronID n);
+
+public:
+	/*! Creates a random sparse matrix shared by n trials. Identical to the matrix of 
+	 * an equivalent SparseConnection between single-trial groups on a single rank. */
+	BatchSparseConnection(SpikingGroup * source, NeuronGroup * destination, NeuronID n, 
+			AurynWeight weight, AurynFloat sparseness=0.05, 
+			TransmitterType transmitter=GLUT, string name="BatchSparseConnection");
+	/*! Loads the single-trial matrix from a Matrix Market file as written by SparseConnection */
+	BatchSparseConnection(SpikingGroup * source, NeuronGroup * destination, NeuronID n, 
+			const char * filename, TransmitterType transmitter=GLUT);
+	virtual ~BatchSparseConnection();
+
+	/*! Returns the number of trials */
+	NeuronID get_trials();
+
+	/*! Stores all columns on every rank since each rank holds all neurons of some trials */
+	virtual bool push_back(NeuronID i, NeuronID j, AurynWeight weight);
+	virtual void propagate();
+	virtual void mark_targets();
+};
+
+#endif /*BATCHSPARSECONNECTION_H_*/
@@ -0,0 +1,486 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BinarySpikeFile.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+BinarySpikeFile::BinarySpikeFile(string filename, NeuronID stride, NeuronID residue)
+{
+	fd = ::open(filename.c_str(),O_RDONLY);
+	if ( fd < 0 ) {
+		stringstream oss;
+		oss << "BinarySpikeFile:: Can't open " << filename;
+		logger->msg(oss.str(),ERROR);
+		throw AurynOpenFileException();
+	}
+
+	struct stat st;
+	fstat(fd,&st);
+	map_size = st.st_size;
+	if ( map_size < sizeof(BinarySpikeHeader) ) {
+		::close(fd);
+		throw AurynSpikeFileException();
+	}
+
+	map = mmap(NULL,map_size,PROT_READ,MAP_SHARED,fd,0);
+	if ( map == MAP_FAILED ) {
+		::close(fd);
+		throw AurynOpenFileException();
+	}
+	madvise(map,map_size,MADV_SEQUENTIAL);
+
+	header = (const BinarySpikeHeader *) map;
+	if ( header->magic == BINARYSPIKEFILE_MAGIC && header->version == BINARYSPIKEFILE_VERSION_DELTA ) {
+		stringstream oss;
+		oss << "BinarySpikeFile:: " << filename << " is delta-encoded and can only be read with BinarySpikeReader. "
+			<< "Convert it with spk2ras --indexed first.";
+		logger->msg(oss.str(),ERROR);
+		unmap();
+		throw AurynSpikeFileException();
+	}
+	if ( header->magic != BINARYSPIKEFILE_MAGIC 
+			|| ( header->version != BINARYSPIKEFILE_VERSION && header->version != BINARYSPIKEFILE_VERSION_PARTITIONED )
+			|| sizeof(BinarySpikeHeader)+header->num_spikes*sizeof(BinarySpikeEvent) > map_size 
+			|| ( header->version == BINARYSPIKEFILE_VERSION_PARTITIONED && !map_partitions(max(stride,(NeuronID)1),residue) ) ) {
+		stringstream oss;
+		oss << "BinarySpikeFile:: " << filename << " is not a valid binary spike file";
+		logger->msg(oss.str(),ERROR);
+		unmap();
+		throw AurynSpikeFileException();
+	}
+
+	if ( header->version == BINARYSPIKEFILE_VERSION ) {
+		Segment all;
+		all.events = (const BinarySpikeEvent *) ((const char *)map+sizeof(BinarySpikeHeader));
+		all.num_spikes = header->num_spikes;
+		all.index = NULL;
+		all.index_size = 0;
+		if ( header->index_offset > 0 && header->index_offset < map_size && header->index_interval > 0 ) {
+			all.index = (const boost::uint64_t *) ((const char *)map+header->index_offset);
+			all.index_size = (map_size-header->index_offset)/sizeof(boost::uint64_t);
+		}
+		segments.push_back(all);
+	}
+
+	stringstream oss;
+	oss << "BinarySpikeFile:: Mapped " << filename << " with " << header->num_spikes << " spikes";
+	if ( header->version == BINARYSPIKEFILE_VERSION_PARTITIONED ) 
+		oss << ", reading " << segments.size() << " partitions";
+	logger->msg(oss.str(),NOTIFICATION);
+}
+
+bool BinarySpikeFile::map_partitions(NeuronID stride, NeuronID residue)
+{
+	const boost::uint64_t table_offset = header->index_offset;
+	if ( table_offset < sizeof(BinarySpikeHeader) || table_offset+sizeof(boost::uint64_t) > map_size || header->index_interval == 0 ) 
+		return false;
+	const boost::uint64_t num_partitions = *(const boost::uint64_t *) ((const char *)map+table_offset);
+	if ( num_partitions == 0 || table_offset+sizeof(boost::uint64_t)+num_partitions*sizeof(BinarySpikePartition) > map_size ) 
+		return false;
+	const BinarySpikePartition * table = (const BinarySpikePartition *) ((const char *)map+table_offset+sizeof(boost::uint64_t));
+	const BinarySpikeEvent * events = (const BinarySpikeEvent *) ((const char *)map+sizeof(BinarySpikeHeader));
+
+	// only the partitions of the selected neurons if the partitioning is compatible
+	const bool selective = num_partitions%stride == 0;
+	for ( boost::uint64_t p = 0 ; p < num_partitions ; ++p ) {
+		if ( table[p].first+table[p].num_spikes > header->num_spikes 
+				|| table[p].index_offset+table[p].index_size*sizeof(boost::uint64_t) > map_size ) 
+			return false;
+		if ( selective && p%stride != residue%stride ) continue;
+		Segment part;
+		part.events = events+table[p].first;
+		part.num_spikes = table[p].num_spikes;
+		part.index = (const boost::uint64_t *) ((const char *)map+table[p].index_offset);
+		part.index_size = table[p].index_size;
+		segments.push_back(part);
+	}
+	return true;
+}
+
+void BinarySpikeFile::unmap()
+{
+	munmap(map,map_size);
+	::close(fd);
+}
+
+BinarySpikeFile::~BinarySpikeFile()
+{
+	unmap();
+}
+
+bool BinarySpikeFile::is_binary_spike_file(string filename)
+{
+	ifstream infile(filename.c_str(),ios::binary);
+	boost::uint32_t magic = 0;
+	if ( !infile.read((char*)&magic,sizeof(magic)) ) 
+		return false;
+	return magic == BINARYSPIKEFILE_MAGIC;
+}
+
+boost::uint64_t BinarySpikeFile::get_num_spikes()
+{
+	return header->num_spikes;
+}
+
+unsigned int BinarySpikeFile::get_num_segments()
+{
+	return segments.size();
+}
+
+boost::uint64_t BinarySpikeFile::get_segment_size(unsigned int s)
+{
+	return segments[s].num_spikes;
+}
+
+AurynFloat BinarySpikeFile::get_dt()
+{
+	return header->dt;
+}
+
+NeuronID BinarySpikeFile::get_size()
+{
+	return header->size;
+}
+
+AurynTime BinarySpikeFile::get_last_time()
+{
+	return header->last_time;
+}
+
+const BinarySpikeEvent * BinarySpikeFile::get_events(unsigned int s)
+{
+	return segments[s].events;
+}
+
+boost::uint64_t BinarySpikeFile::find(AurynTime t, unsigned int s)
+{
+	const Segment & segment = segments[s];
+	boost::uint64_t lo = 0;
+	boost::uint64_t hi = segment.num_spikes;
+	if ( segment.index != NULL ) {
+		const boost::uint64_t k = t/header->index_interval;
+		if ( k >= segment.index_size ) return segment.num_spikes;
+		lo = segment.index[k];
+		if ( k+1 < segment.index_size ) hi = segment.index[k+1];
+	}
+	// binary search for the first spike with time >= t
+	while ( lo < hi ) {
+		const boost::uint64_t mid = lo+(hi-lo)/2;
+		if ( segment.events[mid].time < t ) lo = mid+1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+void BinarySpikeFile::prefetch(boost::uint64_t pos, boost::uint64_t count, unsigned int s)
+{
+	const Segment & segment = segments[s];
+	if ( pos >= segment.num_spikes ) return;
+	count = min(count,segment.num_spikes-pos);
+	const long pagesize = sysconf(_SC_PAGESIZE);
+	size_t begin = (const char *)(segment.events+pos)-(const char *)map;
+	const size_t end = begin+count*sizeof(BinarySpikeEvent);
+	begin -= begin%pagesize;
+	madvise((char*)map+begin,end-begin,MADV_WILLNEED);
+}
+
+
+BinarySpikeReader::BinarySpikeReader(string filename)
+{
+	infile.open(filename.c_str(),ios::in|ios::binary);
+	if ( !infile ) {
+		stringstream oss;
+		oss << "BinarySpikeReader:: Can't open " << filename;
+		logger->msg(oss.str(),ERROR);
+		throw AurynOpenFileException();
+	}
+
+	if ( !infile.read((char*)&header,sizeof(header)) 
+			|| header.magic != BINARYSPIKEFILE_MAGIC 
+			|| ( header.version != BINARYSPIKEFILE_VERSION 
+				&& header.version != BINARYSPIKEFILE_VERSION_DELTA 
+				&& header.version != BINARYSPIKEFILE_VERSION_PARTITIONED ) ) {
+		stringstream oss;
+		oss << "BinarySpikeReader:: " << filename << " is not a valid binary spike file";
+		logger->msg(oss.str(),ERROR);
+		throw AurynSpikeFileException();
+	}
+
+	encoding = header.version == BINARYSPIKEFILE_VERSION_DELTA ? BINARYSPIKE_DELTA : BINARYSPIKE_INDEXED;
+	count = 0;
+	last_time = 0;
+	last_neuron = 0;
+
+	partitioned = NULL;
+	if ( header.version == BINARYSPIKEFILE_VERSION_PARTITIONED ) {
+		infile.close();
+		partitioned = new BinarySpikeFile(filename);
+		positions.assign(partitioned->get_num_segments(),0);
+	}
+}
+
+BinarySpikeReader::~BinarySpikeReader()
+{
+	delete partitioned;
+	infile.close();
+}
+
+const BinarySpikeHeader & BinarySpikeReader::get_header()
+{
+	return header;
+}
+
+BinarySpikeEncoding BinarySpikeReader::get_encoding()
+{
+	return encoding;
+}
+
+bool BinarySpikeReader::read_varint(boost::uint32_t & value)
+{
+	value = 0;
+	for ( int shift = 0 ; shift < 35 ; shift += 7 ) {
+		const int c = infile.get();
+		if ( c == EOF ) return false;
+		value |= (boost::uint32_t)(c&0x7f) << shift;
+		if ( (c&0x80) == 0 ) return true;
+	}
+	return false;
+}
+
+bool BinarySpikeReader::next(AurynTime & time, NeuronID & neuron)
+{
+	if ( count >= header.num_spikes ) return false;
+
+	if ( partitioned != NULL ) {
+		// the partition with the earliest next spike
+		unsigned int next = positions.size();
+		for ( unsigned int p = 0 ; p < positions.size() ; ++p ) {
+			if ( positions[p] >= partitioned->get_segment_size(p) ) continue;
+			if ( next == positions.size() 
+					|| partitioned->get_events(p)[positions[p]].time < partitioned->get_events(next)[positions[next]].time ) 
+				next = p;
+		}
+		if ( next == positions.size() ) return false;
+		time = partitioned->get_events(next)[positions[next]].time;
+		neuron = partitioned->get_events(next)[positions[next]].neuron;
+		++positions[next];
+	} else if ( encoding == BINARYSPIKE_INDEXED ) {
+		BinarySpikeEvent event;
+		if ( !infile.read((char*)&event,sizeof(event)) ) return false;
+		time = event.time;
+		neuron = event.neuron;
+	} else {
+		boost::uint32_t dtime, dneuron;
+		if ( !read_varint(dtime) || !read_varint(dneuron) ) return false;
+		// undo the zigzag encoding of the signed neuron difference
+		last_time += dtime;
+		last_neuron += (NeuronID)((dneuron >> 1) ^ (-(boost::int32_t)(dneuron & 1)));
+		time = last_time;
+		neuron = last_neuron;
+	}
+	++count;
+	return true;
+}
+
+
+BinarySpikeWriter::BinarySpikeWriter(string filename, AurynFloat timestep, AurynTime index_interval, BinarySpikeEncoding enc, unsigned int num_partitions)
+{
+	outfile = new AsyncFileWriter(filename);
+
+	encoding = enc;
+	header.magic = BINARYSPIKEFILE_MAGIC;
+	header.version = encoding == BINARYSPIKE_DELTA ? BINARYSPIKEFILE_VERSION_DELTA : BINARYSPIKEFILE_VERSION;
+	header.dt = timestep;
+	header.size = 0;
+	header.num_spikes = 0;
+	header.index_offset = 0;
+	header.index_interval = max(index_interval,(AurynTime)1);
+	header.last_time = 0;
+	if ( encoding == BINARYSPIKE_INDEXED && num_partitions > 1 ) {
+		header.version = BINARYSPIKEFILE_VERSION_PARTITIONED;
+		partitions.resize(num_partitions);
+	}
+	outfile->write(&header,sizeof(header));
+	last_neuron = 0;
+	is_open = true;
+}
+
+BinarySpikeWriter::~BinarySpikeWriter()
+{
+	close();
+	delete outfile;
+}
+
+void BinarySpikeWriter::set_size(NeuronID size)
+{
+	header.size = max(header.size,size);
+}
+
+void BinarySpikeWriter::write(AurynTime time, NeuronID neuron)
+{
+	if ( header.num_spikes > 0 && time < header.last_time ) {
+		logger->msg("BinarySpikeWriter:: Spikes out of order. Dropping spike.",WARNING);
+		return;
+	}
+
+	if ( encoding == BINARYSPIKE_DELTA ) {
+		write_delta(time,neuron);
+	} else if ( !partitions.empty() ) {
+		BinarySpikeEvent event;
+		event.time = time;
+		event.neuron = neuron;
+		partitions[neuron%partitions.size()].push_back(event);
+	} else {
+		while ( (boost::uint64_t)index.size()*header.index_interval <= time ) 
+			index.push_back(header.num_spikes);
+
+		BinarySpikeEvent event;
+		event.time = time;
+		event.neuron = neuron;
+		outfile->write(&event,sizeof(event));
+	}
+
+	header.num_spikes++;
+	header.last_time = time;
+	header.size = max(header.size,neuron+1);
+}
+
+void BinarySpikeWriter::write_delta(AurynTime time, NeuronID neuron)
+{
+	unsigned char buffer [10];
+	int len = 0;
+
+	boost::uint32_t value = time-header.last_time; // last_time starts at 0
+	while ( value >= 0x80 ) {
+		buffer[len++] = (value&0x7f) | 0x80;
+		value >>= 7;
+	}
+	buffer[len++] = value;
+
+	// zigzag encoding maps small negative differences to small numbers
+	const boost::int32_t diff = (boost::int32_t)(neuron-last_neuron);
+	value = ((boost::uint32_t)diff << 1) ^ (boost::uint32_t)(diff >> 31);
+	while ( value >= 0x80 ) {
+		buffer[len++] = (value&0x7f) | 0x80;
+		value >>= 7;
+	}
+	buffer[len++] = value;
+
+	outfile->write(buffer,len);
+	last_neuron = neuron;
+}
+
+void BinarySpikeWriter::write_partitions()
+{
+	// spikes, then the partition table and the time indices of the partitions
+	vector<BinarySpikePartition> table(partitions.size());
+	vector< vector<boost::uint64_t> > indices(partitions.size());
+	boost::uint64_t first = 0;
+	boost::uint64_t index_offset = sizeof(header)+header.num_spikes*sizeof(BinarySpikeEvent)
+		+sizeof(boost::uint64_t)+partitions.size()*sizeof(BinarySpikePartition);
+	for ( unsigned int p = 0 ; p < partitions.size() ; ++p ) {
+		const vector<BinarySpikeEvent> & spikes = partitions[p];
+		vector<boost::uint64_t> & part_index = indices[p];
+		for ( boost::uint64_t k = 0 ; k < spikes.size() ; ++k ) 
+			while ( (boost::uint64_t)part_index.size()*header.index_interval <= spikes[k].time ) 
+				part_index.push_back(k);
+		part_index.push_back(spikes.size()); // end of the last interval
+
+		if ( !spikes.empty() ) 
+			outfile->write(&spikes[0],spikes.size()*sizeof(BinarySpikeEvent));
+		table[p].first = first;
+		table[p].num_spikes = spikes.size();
+		table[p].index_offset = index_offset;
+		table[p].index_size = part_index.size();
+		first += spikes.size();
+		index_offset += part_index.size()*sizeof(boost::uint64_t);
+	}
+
+	header.index_offset = sizeof(header)+header.num_spikes*sizeof(BinarySpikeEvent);
+	const boost::uint64_t num_partitions = partitions.size();
+	outfile->write(&num_partitions,sizeof(num_partitions));
+	outfile->write(&table[0],table.size()*sizeof(BinarySpikePartition));
+	for ( unsigned int p = 0 ; p < partitions.size() ; ++p ) 
+		outfile->write(&indices[p][0],indices[p].size()*sizeof(boost::uint64_t));
+	partitions.clear();
+}
+
+void BinarySpikeWriter::flush()
+{
+	if ( is_open ) outfile->flush();
+}
+
+void BinarySpikeWriter::close()
+{
+	if ( !is_open ) return;
+	if ( !partitions.empty() ) {
+		write_partitions();
+	} else if ( encoding == BINARYSPIKE_INDEXED ) {
+		header.index_offset = sizeof(header)+header.num_spikes*sizeof(BinarySpikeEvent);
+		index.push_back(header.num_spikes); // end of the last interval
+		outfile->write(&index[0],index.size()*sizeof(boost::uint64_t));
+	}
+	outfile->write_at(0,&header,sizeof(header));
+	outfile->close();
+	is_open = false;
+}
+
+static bool earlier_spike(const pair<AurynTime,NeuronID> & a, const pair<AurynTime,NeuronID> & b)
+{
+	return a.first < b.first;
+}
+
+void BinarySpikeWriter::convert_ras(string rasfile, string binfile, AurynFloat timestep, unsigned int num_partitions)
+{
+	ifstream infile(rasfile.c_str());
+	if ( !infile ) {
+		stringstream oss;
+		oss << "BinarySpikeWriter:: Can't open " << rasfile;
+		logger->msg(oss.str(),ERROR);
+		throw AurynOpenFileException();
+	}
+
+	vector< pair<AurynTime,NeuronID> > spikes;
+	char buffer[256];
+	while ( infile.getline(buffer,255) ) {
+		if ( buffer[0] == '#' ) continue;
+		double t;
+		NeuronID i;
+		if ( sscanf(buffer,"%lf %u",&t,&i) != 2 ) continue;
+		spikes.push_back(make_pair((AurynTime)(t/timestep+0.5),i));
+	}
+	infile.close();
+	// ras files of several ranks or monitors may be concatenated
+	stable_sort(spikes.begin(),spikes.end(),earlier_spike);
+
+	BinarySpikeWriter writer(binfile,timestep,BINARYSPIKEFILE_INDEX_INTERVAL,BINARYSPIKE_INDEXED,num_partitions);
+	for ( vector< pair<AurynTime,NeuronID> >::const_iterator iter = spikes.begin() ; iter != spikes.end() ; ++iter ) 
+		writer.write(iter->first,iter->second);
+	writer.close();
+
+	stringstream oss;
+	oss << "BinarySpikeWriter:: Converted " << spikes.size() << " spikes from " << rasfile << " to " << binfile;
+	logger->msg(oss.str(),NOTIFICATION);
+}
@@ -0,0 +1,240 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BINARYSPIKEFILE_H_
+#define BINARYSPIKEFILE_H_
+
+#include "auryn_definitions.h"
+#include "AsyncFileWriter.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#define BINARYSPIKEFILE_MAGIC 0x4b505342 //!< "BSPK" in little endian
+#define BINARYSPIKEFILE_VERSION 1
+#define BINARYSPIKEFILE_VERSION_DELTA 2 //!< Version tag of delta-encoded files
+#define BINARYSPIKEFILE_VERSION_PARTITIONED 3 //!< Version tag of indexed files partitioned by neuron ID
+#define BINARYSPIKEFILE_INDEX_INTERVAL 10000 //!< Default number of time steps per entry of the time index
+
+using namespace std;
+
+/*! \brief Record layout of binary spike files 
+ *
+ * BINARYSPIKE_INDEXED files store fixed size records and a time index and can
+ * be mapped by BinarySpikeFile for replay and seeking. BINARYSPIKE_DELTA 
+ * files store each spike as variable length integers of the time and neuron 
+ * ID differences to the previous spike, which typically takes 2-4 instead of
+ * 8 bytes per spike. They can only be read sequentially with 
+ * BinarySpikeReader.
+ */
+enum BinarySpikeEncoding { BINARYSPIKE_INDEXED, BINARYSPIKE_DELTA };
+
+/*! \brief Header at the beginning of a binary spike file */
+struct BinarySpikeHeader 
+{
+	boost::uint32_t magic;
+	boost::uint32_t version;
+	/*! Length of a time step in seconds the spike times are given in */
+	AurynFloat dt;
+	/*! Largest neuron ID plus one */
+	NeuronID size;
+	boost::uint64_t num_spikes;
+	/*! Byte offset of the time index, 0 if the file has no index */
+	boost::uint64_t index_offset;
+	/*! Number of time steps per index entry */
+	AurynTime index_interval;
+	/*! Time of the last spike */
+	AurynTime last_time;
+};
+
+/*! \brief A single spike in a binary spike file */
+struct BinarySpikeEvent
+{
+	AurynTime time;
+	NeuronID neuron;
+};
+
+/*! \brief Entry of the partition table of a partitioned binary spike file */
+struct BinarySpikePartition
+{
+	/*! Record number of the first spike of the partition */
+	boost::uint64_t first;
+	boost::uint64_t num_spikes;
+	/*! Byte offset of the time index of the partition */
+	boost::uint64_t index_offset;
+	/*! Number of entries of the time index */
+	boost::uint64_t index_size;
+};
+
+/*! \brief Read-only memory mapped view of a binary spike file
+ *
+ * A binary spike file starts with a BinarySpikeHeader followed by the spikes 
+ * as BinarySpikeEvent records sorted by time. After the spikes follows the 
+ * time index, an array of 64 bit record numbers where entry k is the first 
+ * spike with time >= k*index_interval. All values are stored in the byte 
+ * order of the machine. The file is mapped into memory and the kernel reads 
+ * ahead sequentially; prefetch() can be used to request the pages of 
+ * upcoming spikes early.
+ *
+ * Partitioned files store the spikes of neuron i in partition i%P. Each 
+ * partition is a block of records sorted by time with its own time index 
+ * (record numbers relative to the partition). The header's index_offset 
+ * points to the number of partitions P (64 bit) followed by P 
+ * BinarySpikePartition entries. 
+ *
+ * The spikes are accessed in segments. A file which is not partitioned is a
+ * single segment. When a file is opened for the neurons i with 
+ * i%stride == residue and its number of partitions is a multiple of stride,
+ * the segments are the partitions holding these neurons, so that only their
+ * pages are ever read. Otherwise all partitions are segments and the caller
+ * has to drop the spikes of other neurons.
+ */
+class BinarySpikeFile
+{
+private:
+	int fd;
+	void * map;
+	size_t map_size;
+	const BinarySpikeHeader * header;
+	/*! A block of spikes sorted by time with its time index */
+	struct Segment {
+		const BinarySpikeEvent * events;
+		boost::uint64_t num_spikes;
+		const boost::uint64_t * index;
+		boost::uint64_t index_size;
+	};
+	vector<Segment> segments;
+
+	/*! Adds the segments of a partitioned file, returns false if the partition table is invalid */
+	bool map_partitions(NeuronID stride, NeuronID residue);
+	void unmap();
+
+public:
+	/*! Maps the file filename and selects the segments which hold the 
+	 * neurons i with i%stride == residue. Throws AurynOpenFileException or 
+	 * AurynSpikeFileException. */
+	BinarySpikeFile(string filename, NeuronID stride=1, NeuronID residue=0);
+	virtual ~BinarySpikeFile();
+
+	/*! Returns true if filename exists and starts with the binary spike file magic number */
+	static bool is_binary_spike_file(string filename);
+
+	/*! Returns the number of spikes in the file */
+	boost::uint64_t get_num_spikes();
+	/*! Returns the number of selected segments */
+	unsigned int get_num_segments();
+	/*! Returns the number of spikes in segment s */
+	boost::uint64_t get_segment_size(unsigned int s=0);
+	/*! Returns the time step of the spike times in seconds */
+	AurynFloat get_dt();
+	/*! Returns the largest neuron ID in the file plus one */
+	NeuronID get_size();
+	/*! Returns the time of the last spike */
+	AurynTime get_last_time();
+	/*! Returns the spike records of segment s */
+	const BinarySpikeEvent * get_events(unsigned int s=0);
+	/*! Returns the number of the first spike in segment s with time >= t */
+	boost::uint64_t find(AurynTime t, unsigned int s=0);
+	/*! Asks the kernel to read the pages holding count spikes of segment s starting with spike pos */
+	void prefetch(boost::uint64_t pos, boost::uint64_t count, unsigned int s=0);
+};
+
+/*! \brief Sequential reader for indexed and delta-encoded binary spike files 
+ *
+ * The spikes of partitioned files are merged in time order from the mapped
+ * partitions. */
+class BinarySpikeReader
+{
+private:
+	ifstream infile;
+	BinarySpikeHeader header;
+	BinarySpikeEncoding encoding;
+	boost::uint64_t count;
+	AurynTime last_time;
+	NeuronID last_neuron;
+	/*! Mapped partitioned file or NULL */
+	BinarySpikeFile * partitioned;
+	/*! Next spike of each partition of a partitioned file */
+	vector<boost::uint64_t> positions;
+
+	bool read_varint(boost::uint32_t & value);
+
+public:
+	/*! Opens filename. Throws AurynOpenFileException or AurynSpikeFileException. */
+	BinarySpikeReader(string filename);
+	virtual ~BinarySpikeReader();
+
+	/*! Returns the header of the file */
+	const BinarySpikeHeader & get_header();
+	/*! Returns the encoding of the file */
+	BinarySpikeEncoding get_encoding();
+	/*! Reads the next spike. Returns false at the end of the file. */
+	bool next(AurynTime & time, NeuronID & neuron);
+};
+
+/*! \brief Writes spikes sorted by time to a binary spike file 
+ *
+ * The spikes are collected in memory blocks which an AsyncFileWriter writes
+ * to disk in a background thread. Indexed files get their time index on 
+ * close. Indexed files with more than one partition keep all spikes in 
+ * memory and write them on close, partition by partition. Replaying such a
+ * file on a number of ranks which divides the number of partitions lets 
+ * each rank read only the spikes of its own neurons.
+ */
+class BinarySpikeWriter
+{
+private:
+	AsyncFileWriter * outfile;
+	BinarySpikeHeader header;
+	BinarySpikeEncoding encoding;
+	vector<boost::uint64_t> index;
+	/*! Spikes of each partition, only used for more than one partition */
+	vector< vector<BinarySpikeEvent> > partitions;
+	NeuronID last_neuron;
+	bool is_open;
+
+	void write_delta(AurynTime time, NeuronID neuron);
+	void write_partitions();
+
+public:
+	/*! Opens filename for writing. Spike times are in units of timestep 
+	 * seconds. Indexed files are split into num_partitions partitions by 
+	 * neuron ID. */
+	BinarySpikeWriter(string filename, AurynFloat timestep=dt, AurynTime index_interval=BINARYSPIKEFILE_INDEX_INTERVAL, BinarySpikeEncoding encoding=BINARYSPIKE_INDEXED, unsigned int num_partitions=1);
+	virtual ~BinarySpikeWriter();
+
+	/*! Sets the size stored in the header if it is larger than the largest neuron ID written */
+	void set_size(NeuronID size);
+	/*! Appends a spike. Times have to be non-decreasing. */
+	void write(AurynTime time, NeuronID neuron);
+	/*! Writes the buffered spikes to the file. The header is only valid after close(). */
+	void flush();
+	/*! Writes the time index and the final header and closes the file */
+	void close();
+
+	/*! Converts a ras text file (lines of time in seconds and neuron ID) to a binary spike file */
+	static void convert_ras(string rasfile, string binfile, AurynFloat timestep=dt, unsigned int num_partitions=1);
+};
+
+extern Logger * logger;
+
+#endif /*BINARYSPIKEFILE_H_*/
@@ -0,0 +1,115 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BinarySpikeMonitor.h"
+
+BinarySpikeMonitor::BinarySpikeMonitor(SpikingGroup * source, string filename, NeuronID from, NeuronID to, BinarySpikeEncoding encoding) 
+	: Monitor()
+{
+	init(source,filename,from,to,encoding);
+}
+
+BinarySpikeMonitor::BinarySpikeMonitor(SpikingGroup * source, string filename, NeuronID to)
+	: Monitor()
+{
+	init(source,filename,0,to,BINARYSPIKE_INDEXED);
+}
+
+BinarySpikeMonitor::BinarySpikeMonitor(SpikingGroup * source, string filename, BinarySpikeEncoding encoding)
+	: Monitor()
+{
+	init(source,filename,0,source->get_size(),encoding);
+}
+
+BinarySpikeMonitor::BinarySpikeMonitor(SpikingGroup * source, OutputContainer * out, string streamname)
+	: Monitor()
+{
+	sys->register_monitor(this);
+	n_from = 0;
+	n_to = source->get_size();
+	n_every = 1;
+	src = source;
+	offset = 0;
+	writer = NULL;
+	container = out;
+	stream = container->add_stream(streamname,CONTAINER_SPIKES,1,&n_to,sizeof(n_to));
+}
+
+BinarySpikeMonitor::~BinarySpikeMonitor()
+{
+	free();
+}
+
+void BinarySpikeMonitor::init(SpikingGroup * source, string filename, NeuronID from, NeuronID to, BinarySpikeEncoding encoding)
+{
+	sys->register_monitor(this);
+
+	fname = filename;
+	n_from = from;
+	n_to = to;
+	n_every = 1;
+	src = source;
+	offset = 0;
+	container = NULL;
+	writer = new BinarySpikeWriter(filename,dt,BINARYSPIKEFILE_INDEX_INTERVAL,encoding);
+	writer->set_size(n_to);
+}
+
+void BinarySpikeMonitor::free()
+{
+	if ( writer == NULL ) return;
+	writer->close();
+	delete writer;
+}
+
+void BinarySpikeMonitor::set_offset(NeuronID of)
+{
+	offset = of;
+	if ( writer != NULL ) 
+		writer->set_size(n_to+offset);
+}
+
+void BinarySpikeMonitor::set_every(NeuronID every)
+{
+	n_every = every;
+}
+
+void BinarySpikeMonitor::propagate()
+{
+	const AurynTime now = sys->get_clock();
+	SpikeContainer * spikes = src->get_spikes_immediate();
+	for ( SpikeContainer::const_iterator it = spikes->begin() ; it != spikes->end() ; ++it ) {
+		if ( *it >= n_from && *it < n_to && (*it%n_every==0) ) {
+			const NeuronID i = *it+offset;
+			if ( container != NULL ) 
+				container->append(stream,now,&i);
+			else
+				writer->write(now,i);
+		}
+	}
+}
+
+void BinarySpikeMonitor::flush()
+{
+	if ( container != NULL ) 
+		container->flush();
+	else
+		writer->flush();
+}
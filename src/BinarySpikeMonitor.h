@@ -0,0 +1,76 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BINARYSPIKEMONITOR_H_
+#define BINARYSPIKEMONITOR_H_
+
+#include "auryn_definitions.h"
+#include "SpikingGroup.h"
+#include "Monitor.h"
+#include "System.h"
+#include "BinarySpikeFile.h"
+#include "OutputContainer.h"
+
+using namespace std;
+
+/*! \brief Records spikes from a SpikingGroup to a binary spike file
+ *
+ * Works like SpikeMonitor but writes the spikes as BinarySpikeEvent records 
+ * with the simulation clock as time stamp (see BinarySpikeFile). The files 
+ * are a fraction of the size of ras files and can be played back by 
+ * ReplayGroup or FileInputGroup without parsing. Like SpikeMonitor each rank
+ * records the spikes of its own neurons, so filename should differ between 
+ * ranks. The file is completed when the monitor is destroyed.
+ *
+ * The spikes are buffered in memory and written to disk by a background 
+ * thread, so recording all neurons of a large network costs only a few 
+ * percent of the run time. With BINARYSPIKE_DELTA the file is about half 
+ * as large but has to be converted with spk2ras before it can be replayed.
+ * spk2ras also converts both formats to the ras text format of SpikeMonitor.
+ * Alternatively the spikes can be written as a stream of an OutputContainer.
+ */
+class BinarySpikeMonitor : Monitor
+{
+private:
+	NeuronID n_from;
+	NeuronID n_to;
+	NeuronID n_every;
+	SpikingGroup * src;
+	NeuronID offset;
+	BinarySpikeWriter * writer;
+	OutputContainer * container;
+	unsigned int stream;
+	void init(SpikingGroup * source, string filename, NeuronID from, NeuronID to, BinarySpikeEncoding encoding);
+	void free();
+	
+public:
+	BinarySpikeMonitor(SpikingGroup * source, string filename, BinarySpikeEncoding encoding=BINARYSPIKE_INDEXED);
+	BinarySpikeMonitor(SpikingGroup * source, string filename, NeuronID to);
+	BinarySpikeMonitor(SpikingGroup * source, string filename, NeuronID from, NeuronID to, BinarySpikeEncoding encoding=BINARYSPIKE_INDEXED);
+	/*! Writes the spikes to the stream streamname of container. The stream metadata is the group size. */
+	BinarySpikeMonitor(SpikingGroup * source, OutputContainer * container, string streamname);
+	void set_offset(NeuronID of);
+	void set_every(NeuronID every);
+	virtual ~BinarySpikeMonitor();
+	void propagate();
+	virtual void flush();
+};
+
+#endif /*BINARYSPIKEMONITOR_H_*/
@@ -77,22 +77,23 @@ void Connection::set_transmitter(TransmitterType transmitter)
 {
 	trans = transmitter;
 	if ( dst->evolve_locally() ) {
-		switch ( transmitter ) {
-			case GABA:
-				set_transmitter(dst->get_gaba_ptr()->data);
-				break;
-			case MEM:
-				set_transmitter(dst->get_mem_ptr()->data);
-				break;
-			case NMDA:
-				set_transmitter(dst->get_nmda_ptr()->data);
-				break;
-			case GLUT:
-			case AMPA:
-			default:
-				set_transmitter(dst->get_ampa_ptr()->data);
-		}
-	} else set_transmitter(NULL);
+		set_transmitter(dst->get_input_vector(transmitter)->data);
+		track_targets = dst->tracks_input();
+	} else {
+		set_transmitter(NULL);
+		track_targets = false;
+	}
+}
+
+bool Connection::tracks_targets()
+{
+	return track_targets;
+}
+
+void Connection::mark_targets()
+{
+	for ( NeuronID i = 0 ; i < dst->get_rank_size() ; ++i ) 
+		dst->mark_input(i);
 }
 
 void Connection::set_transmitter(float * ptr)
@@ -147,3 +148,8 @@ void Connection::evolve()
 {
 
 }
+
+bool Connection::is_quiescent() 
+{
+	return false;
+}
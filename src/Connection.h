@@ -51,6 +51,8 @@ protected:
 	NeuronGroup * dst;
 	TransmitterType trans;
 	AurynFloat * target;
+	/*! Set if dst records which units receive input (see NeuronGroup::mark_input) */
+	bool track_targets;
 
 public:
 	Connection();
@@ -83,6 +85,10 @@ public:
 	virtual void finalize() = 0;
 	virtual void propagate() = 0;
 	virtual void evolve();
+	/*! Returns true if a call to propagate() in the current time step would 
+	 * have no effect. System then skips the call. The default implementation 
+	 * returns false. */
+	virtual bool is_quiescent();
 
 	/*! DEPRECATED. (Such connections should not be registered in the first place) Calls propagate only if the postsynaptic NeuronGroup exists on the local rank. */
 	void conditional_propagate();
@@ -96,6 +102,14 @@ public:
 	/*! Same as transmit but checks if the target neuron exists */
 	void safe_transmit(NeuronID id, AurynWeight amount);
 
+	/*! Returns true if dst records which units receive input, in which case 
+	 * System calls mark_targets after each propagate() */
+	bool tracks_targets();
+	/*! Reports the units which received input in the last propagate() to dst 
+	 * with NeuronGroup::mark_input. Keeps the bookkeeping out of transmit for 
+	 * all other targets. The default marks all units of dst. */
+	virtual void mark_targets();
+
 	/*! Returns a vector of ConnectionsID of a block specified by the arguments */
 	virtual vector<neuron_pair>  get_block(NeuronID lo_row, NeuronID lo_col, NeuronID hi_row,  NeuronID hi_col) = 0;
 
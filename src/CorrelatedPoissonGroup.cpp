@@ -20,11 +20,15 @@
 
 #include "CorrelatedPoissonGroup.h"
 
-boost::mt19937 CorrelatedPoissonGroup::gen = boost::mt19937(); 
+unsigned int CorrelatedPoissonGroup::num_instances = 0;
 
 void CorrelatedPoissonGroup::init(AurynDouble  rate, NeuronID gsize, AurynDouble timedelay )
 {
+	prefetcher = NULL;
 	sys->register_spiking_group(this);
+	// independent streams such that later instances don't restart earlier ones
+	const int s = communicator->rank()+1000003*num_instances;
+	++num_instances;
 	if ( evolve_locally() ) {
 		lambda = rate;
 
@@ -61,7 +65,7 @@ void CorrelatedPoissonGroup::init(AurynDouble  rate, NeuronID gsize, AurynDouble
 
 		dist = new boost::uniform_01<> ();
 		die  = new boost::variate_generator<boost::mt19937&, boost::uniform_01<> > ( gen, *dist );
-		seed(communicator->rank()); // seeding problem
+		seed(s);
 
 		x = new NeuronID [ngroups];
 		for ( int i = 0 ; i < ngroups ; ++i ) {
@@ -70,7 +74,7 @@ void CorrelatedPoissonGroup::init(AurynDouble  rate, NeuronID gsize, AurynDouble
 		}
 
 		oss.str("");
-		oss << "CorrelatedPoissonGroup:: Seeding with " << communicator->rank();
+		oss << "CorrelatedPoissonGroup:: Seeding with " << s;
 		logger->msg(oss.str(),NOTIFICATION);
 	}
 }
@@ -85,6 +89,8 @@ CorrelatedPoissonGroup::CorrelatedPoissonGroup(NeuronID n,
 
 CorrelatedPoissonGroup::~CorrelatedPoissonGroup()
 {
+	if ( prefetcher != NULL ) 
+		delete prefetcher;
 	if ( evolve_locally() ) {
 		delete dist;
 		delete die;
@@ -92,13 +98,24 @@ CorrelatedPoissonGroup::~CorrelatedPoissonGroup()
 	}
 }
 
+void CorrelatedPoissonGroup::check_not_prefetching(string what)
+{
+	if ( prefetcher == NULL ) return;
+	stringstream oss;
+	oss << "CorrelatedPoissonGroup:: Can't change the " << what << " while prefetching.";
+	logger->msg(oss.str(),ERROR);
+	throw AurynPrefetcherException();
+}
+
 void CorrelatedPoissonGroup::set_rate(AurynDouble  rate)
 {
+	check_not_prefetching("rate");
 	lambda = rate;
 }
 
 void CorrelatedPoissonGroup::set_threshold(AurynDouble  threshold)
 {
+	check_not_prefetching("threshold");
 	thr = max(1e-6,threshold);
 }
 
@@ -109,9 +126,22 @@ AurynDouble  CorrelatedPoissonGroup::get_rate()
 
 
 void CorrelatedPoissonGroup::evolve()
+{
+	if ( prefetcher != NULL ) 
+		prefetcher->pop(sys->get_clock(),spikes);
+	else
+		generate(sys->get_clock(),spikes);
+}
+
+void CorrelatedPoissonGroup::produce_spikes(AurynTime t, SpikeContainer * out)
+{
+	generate(t,out);
+}
+
+void CorrelatedPoissonGroup::generate(AurynTime now, SpikeContainer * out)
 {
 	// check if the group has timed out
-	if ( tstop && sys->get_clock() > tstop ) return;
+	if ( tstop && now > tstop ) return;
 
 	// move amplitude
 	amplitude += (target_amplitude-amplitude)*dt/tau_amplitude;
@@ -123,58 +153,72 @@ void CorrelatedPoissonGroup::evolve()
 	o += 2.0*((AurynDouble)(*die)()-0.5)*sqrt(dt/timescale)*amplitude;
 
 	int len = delay*ngroups;
-	delay_o[sys->get_clock()%len] = max(thr,o*lambda);
+	delay_o[now%len] = max(thr,o*lambda);
 
 	for ( int g = 0 ; g < ngroups ; ++g ) {
-		AurynDouble grouprate = delay_o[(sys->get_clock()-(g+offset)*delay)%len];
+		AurynDouble grouprate = delay_o[(now-(g+offset)*delay)%len];
 		AurynDouble r = -log(1-(AurynDouble)(*die)())/(dt*grouprate); // think before tempering with this! 
 		// I already broke the corde here once!
 		x[g] = (NeuronID)(r); 
 		while ( x[g] < groupsize ) {
-			push_spike ( g*groupsize + x[g] );
+			out->push_back( rank2global( g*groupsize + x[g] ) );
 			AurynDouble r = -log(1-(AurynDouble)(*die)())/(dt*grouprate);
 			x[g] += (NeuronID)(r); 
 		}
 	}
 }
 
+void CorrelatedPoissonGroup::enable_prefetching(AurynTime batch_steps, unsigned int num_batches)
+{
+	if ( !evolve_locally() || prefetcher != NULL ) return;
+	prefetcher = new SpikePrefetcher(this,sys->get_clock(),batch_steps,num_batches);
+	logger->msg("CorrelatedPoissonGroup:: Generating spikes in a producer thread",NOTIFICATION);
+}
+
 void CorrelatedPoissonGroup::seed(int s)
 {
-		gen.seed(s); 
+	check_not_prefetching("seed"); // the producer thread draws from gen
+	gen.seed(s); 
 }
 
 void CorrelatedPoissonGroup::set_amplitude(AurynDouble amp)
 {
+	check_not_prefetching("amplitude");
 	amplitude = amp;
 	logger->parameter("amplitude",amplitude);
 }
 
 void CorrelatedPoissonGroup::set_target_amplitude(AurynDouble amp)
 {
+	check_not_prefetching("target amplitude");
 	target_amplitude = amp;
 	logger->parameter("target_amplitude",target_amplitude);
 }
 
 void CorrelatedPoissonGroup::set_timescale(AurynDouble scale)
 {
+	check_not_prefetching("timescale");
 	timescale = scale;
 	logger->parameter("timescale",timescale);
 }
 
 void CorrelatedPoissonGroup::set_tau_amplitude(AurynDouble tau)
 {
+	check_not_prefetching("tau_amplitude");
 	tau_amplitude = tau;
 	logger->parameter("tau_amplitude",tau_amplitude);
 }
 
 void CorrelatedPoissonGroup::set_offset(int off)
 {
+	check_not_prefetching("offset");
 	offset = off;
 	logger->parameter("offset",offset);
 }
 
 void CorrelatedPoissonGroup::set_stoptime(AurynDouble stoptime)
 {
+	check_not_prefetching("stoptime");
 	tstop = stoptime*dt;
 	logger->parameter("stoptime",stoptime);
 }
@@ -24,6 +24,7 @@
 #include "auryn_definitions.h"
 #include "System.h"
 #include "SpikingGroup.h"
+#include "SpikePrefetcher.h"
 
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int.hpp>
@@ -39,16 +40,29 @@ using namespace std;
  * The group can be used to provide a stimulus for Hebbian learning in
  * networks. When defined a given number of groups of given size are defined,
  * as well as a correlation time. 
+ *
+ * With enable_prefetching() the spikes are generated in a background thread
+ * ahead of the simulation. The setters and seed then throw 
+ * AurynPrefetcherException because the producer thread owns the state.
  */
-class CorrelatedPoissonGroup : public SpikingGroup
+class CorrelatedPoissonGroup : public SpikingGroup, public SpikeProducer
 {
 private:
 	AurynTime * clk;
-	static boost::mt19937 gen; 
+	/*! Random number generator of this instance */
+	boost::mt19937 gen; 
+	/*! Number of instances created so far, used to give each instance its own seed */
+	static unsigned int num_instances;
+	/*! Producer thread generating ahead or NULL */
+	SpikePrefetcher * prefetcher;
 	boost::uniform_01<> * dist;
 	boost::variate_generator<boost::mt19937&, boost::uniform_01<> > * die;
 
 	void init(AurynDouble rate, NeuronID gsize, AurynDouble timedelay );
+	/*! Generates the spikes of time step now */
+	void generate(AurynTime now, SpikeContainer * out);
+	/*! Throws AurynPrefetcherException if the producer thread owns the state */
+	void check_not_prefetching(string what);
 
 protected:
 	AurynDouble lambda;
@@ -91,6 +105,12 @@ public:
 			AurynDouble timedelay=50e-3 );
 	virtual ~CorrelatedPoissonGroup();
 	virtual void evolve();
+	/*! Implementation of SpikeProducer for the prefetcher */
+	virtual void produce_spikes(AurynTime t, SpikeContainer * out);
+	/*! Generates the spikes in a background thread in batches of batch_steps 
+	 * time steps. Afterwards the setters and seed throw 
+	 * AurynPrefetcherException. */
+	void enable_prefetching(AurynTime batch_steps=SPIKEPREFETCHER_BATCH_STEPS, unsigned int num_batches=SPIKEPREFETCHER_NUM_BATCHES);
 	void set_rate(AurynDouble rate);
 	void set_amplitude(AurynDouble ampl);
 	void set_target_amplitude(AurynDouble ampl);
@@ -100,6 +120,7 @@ public:
 	void set_threshold(AurynDouble threshold);
 	void set_stoptime(AurynDouble stoptime);
 	AurynDouble get_rate();
+	/*! Seeds the random number generator of this group */
 	void seed(int s);
 };
 
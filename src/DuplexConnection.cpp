@@ -41,6 +41,7 @@ void DuplexConnection::finalize() // finalize at this level is called only for r
 DuplexConnection::DuplexConnection(const char * filename) 
 : SparseConnection(filename)
 {
+	consolidated = false;
 	if ( dst->get_post_size() > 0 ) 
 		init();
 }
@@ -49,6 +50,7 @@ DuplexConnection::DuplexConnection(SpikingGroup * source, NeuronGroup * destinat
 		TransmitterType transmitter) 
 : SparseConnection(source, destination, transmitter)
 {
+	consolidated = false;
 }
 
 DuplexConnection::DuplexConnection(SpikingGroup * source, NeuronGroup * destination, 
@@ -56,6 +58,7 @@ DuplexConnection::DuplexConnection(SpikingGroup * source, NeuronGroup * destinat
 		TransmitterType transmitter) 
 : SparseConnection(source, destination, filename, transmitter)
 {
+	consolidated = false;
 	if ( dst->get_post_size() > 0 ) 
 		init();
 }
@@ -64,6 +67,7 @@ DuplexConnection::DuplexConnection(SpikingGroup * source, NeuronGroup * destinat
 DuplexConnection::DuplexConnection(NeuronID rows, NeuronID cols) 
 : SparseConnection(rows,cols)
 {
+	consolidated = false;
 	init();
 }
 
@@ -72,6 +76,7 @@ DuplexConnection::DuplexConnection( SpikingGroup * source, NeuronGroup * destina
 		TransmitterType transmitter, string name) 
 : SparseConnection(source,destination,weight,sparseness,transmitter, name)
 {
+	consolidated = false;
 	if ( dst->get_post_size() > 0 ) 
 		init();
 }
@@ -134,3 +139,42 @@ void DuplexConnection::compute_reverse_matrix()
 	}
 }
 
+
+void DuplexConnection::consolidate(AurynWeight quantum)
+{
+	if ( dst->get_post_size() == 0 ) return;
+
+	if ( quantum > 0.0 ) {
+		for ( AurynWeight * i = w->get_data_begin() ; i != w->get_data_end() ; ++i ) 
+			*i = quantum*floor(*i/quantum+0.5);
+	}
+
+	// keep an empty backward matrix such that backward loops remain valid
+	bkw->resize_buffer_and_clear(1);
+	bkw->fill_zeros();
+	consolidated = true;
+
+	stringstream oss;
+	oss << "DuplexConnection: ("<< get_name() << "): Consolidated";
+	if ( quantum > 0.0 ) 
+		oss << " with weight quantum " << quantum;
+	logger->msg(oss.str(),NOTIFICATION);
+}
+
+void DuplexConnection::unconsolidate()
+{
+	if ( !consolidated ) return;
+	consolidated = false;
+	// finalize rebuilds bkw and lets derived classes update their shortcuts
+	finalize(); 
+}
+
+bool DuplexConnection::is_consolidated()
+{
+	return consolidated;
+}
+
+bool DuplexConnection::is_quiescent()
+{
+	return false;
+}
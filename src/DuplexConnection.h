@@ -51,6 +51,8 @@ private:
 	void init();
 	void free();
 protected:
+	/*! Is true while the connection is consolidated (see consolidate()). */
+	bool consolidated;
 	void compute_reverse_matrix();
 public:
 	ForwardMatrix  * fwd;
@@ -64,6 +66,20 @@ public:
 
 	virtual ~DuplexConnection();
 	virtual void finalize();
+	/*! Always returns false since plastic connections also act on 
+	 * postsynaptic spikes and on their own state in propagate() */
+	virtual bool is_quiescent();
+
+	/*! Freezes the connection in its current state. The memory of the backward 
+	 * matrix is released and all plastic connections derived from this class 
+	 * fall back to the plain SparseConnection::propagate. Useful for testing phases after learning.
+	 * \param quantum If larger than zero, weights are rounded to the nearest 
+	 * multiple of quantum. */
+	virtual void consolidate(AurynWeight quantum=0.0);
+	/*! Recomputes the backward matrix of a consolidated connection and makes it plastic again. */
+	virtual void unconsolidate();
+	/*! Returns true if the connection is currently consolidated. */
+	bool is_consolidated();
 
 };
 
@@ -24,14 +24,16 @@ void EulerTrace::init(NeuronID n, AurynFloat timeconstant)
 {
 	size = n;
 	set_timeconstant(timeconstant);
-	state = gsl_vector_float_alloc ( calculate_vector_size(size) ); 
+	state = auryn_vector_float_alloc ( calculate_vector_size(size) ); 
+	state_is_owned = true;
 	setall(0.);
 	target_ptr = NULL;
 }
 
 void EulerTrace::free()
 {
-	gsl_vector_float_free (state);
+	if ( state_is_owned ) 
+		gsl_vector_float_free (state);
 
 	if ( target_ptr != NULL ) {
 		gsl_vector_float_free (update);
@@ -112,6 +114,22 @@ AurynFloat EulerTrace::get_tau()
 	return tau;
 }
 
+AurynFloat EulerTrace::get_scale_const()
+{
+	return scale_const;
+}
+
+void EulerTrace::bind(AurynFloat * storage)
+{
+	gsl_vector_float_view view = gsl_vector_float_view_array ( storage, state->size );
+	gsl_vector_float_memcpy ( &view.vector, state );
+	if ( state_is_owned ) 
+		gsl_vector_float_free (state);
+	state_view = view;
+	state = &state_view.vector;
+	state_is_owned = false;
+}
+
 void EulerTrace::inc(NeuronID i)
 {
    // gsl_vector_float_set (state, i, gsl_vector_float_get (state, i)+1);
@@ -46,6 +46,10 @@ private:
 	AurynFloat scale_const;
 	/*! Decay time constant in [s]. */
 	AurynFloat tau;
+	/*! View on external memory when the state is held by an EulerTraceBank. */
+	gsl_vector_float_view state_view;
+	/*! False if the state lives in external memory. */
+	bool state_is_owned;
 
 	void init(NeuronID n, AurynFloat timeconstant);
 	void free();
@@ -93,6 +97,15 @@ public:
 	void follow();
 	/*! Get decay time constant */
 	AurynFloat get_tau();
+	/*! Get the multiplicative factor applied in every evolve step */
+	AurynFloat get_scale_const();
+	/*! Moves the state into external memory of at least the size of 
+	 * the state vector (e.g. a slice of an EulerTraceBank). Current values
+	 * are copied over. The memory has to outlive the trace or the trace 
+	 * has to be bound again before it is freed.
+	 * \param storage pointer to the external (16 byte aligned) memory
+	 */ 
+	void bind(AurynFloat * storage);
 	/*! Get trace value of trace 
 	 * \param i index of trace to get
 	 */ 
@@ -0,0 +1,99 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "EulerTraceBank.h"
+
+void EulerTraceBank::init(NeuronID n, unsigned int k, unsigned int phase)
+{
+	size = n;
+	interval = max(k,1u);
+	countdown = phase%interval;
+	slice_size = calculate_vector_size(size);
+	state = NULL;
+}
+
+void EulerTraceBank::free()
+{
+	if ( state != NULL ) 
+		gsl_vector_float_free (state);
+}
+
+EulerTraceBank::EulerTraceBank(NeuronID n, unsigned int k, unsigned int phase)
+{
+	init(n,k,phase);
+}
+
+EulerTraceBank::~EulerTraceBank()
+{
+	free();
+}
+
+void EulerTraceBank::repack()
+{
+	gsl_vector_float * old_state = state;
+	state = auryn_vector_float_alloc ( traces.size()*slice_size ); 
+	for ( NeuronID k = 0 ; k < traces.size() ; ++k ) 
+		traces[k]->bind( state->data + k*slice_size );
+	if ( old_state != NULL ) 
+		gsl_vector_float_free (old_state);
+	scale_consts.resize(traces.size());
+}
+
+void EulerTraceBank::add(EulerTrace * trace)
+{
+	traces.push_back(trace);
+	repack();
+}
+
+void EulerTraceBank::inc(NeuronID i)
+{
+	for ( AurynFloat * ptr = state->data+i ; ptr < state->data+state->size ; ptr += slice_size )
+		(*ptr)++;
+}
+
+void EulerTraceBank::evolve()
+{
+	if ( traces.empty() ) return;
+	if ( interval > 1 ) {
+		if ( countdown > 0 ) {
+			countdown--;
+			return;
+		}
+		countdown = interval-1;
+		// exact decay over interval time steps
+		for ( NeuronID k = 0 ; k < traces.size() ; ++k ) 
+			scale_consts[k] = exp(-(interval*dt)/traces[k]->get_tau());
+	} else {
+		// time constants can change at runtime
+		for ( NeuronID k = 0 ; k < traces.size() ; ++k ) 
+			scale_consts[k] = traces[k]->get_scale_const();
+	}
+	auryn_vector_float_scale_blocks( &scale_consts[0], state, slice_size );
+}
+
+unsigned int EulerTraceBank::get_interval()
+{
+	return interval;
+}
+
+NeuronID EulerTraceBank::get_num_traces()
+{
+	return traces.size();
+}
@@ -0,0 +1,88 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EULERTRACEBANK_H_
+#define EULERTRACEBANK_H_
+
+#include "auryn_definitions.h"
+#include "EulerTrace.h"
+#include <vector>
+#include <gsl/gsl_vector_float.h>
+
+using namespace std;
+
+/*! \brief Stores several EulerTrace objects of the same size in one contiguous memory block and evolves them in a single pass.
+ *
+ * Groups that carry multiple traces (e.g. for triplet STDP with homeostasis) would otherwise 
+ * run one streaming pass over memory per trace and time step. The bank holds the states of all 
+ * traces as consecutive (SIMD aligned) slices of a single gsl_vector_float (structure of arrays).
+ * The registered EulerTrace objects keep working as before, but operate on their slice of the bank.
+ * evolve() decays all traces with their respective time constants in one loop and inc() 
+ * increments the same unit in all traces at once.
+ * Banks of slow traces can be integrated only every k-th time step with the exact decay over k*dt.
+ * Spikes are still added immediately, but a trace lags behind its full-rate counterpart by at 
+ * most a relative error of (k-1)*dt/tau. The phase allows to stagger the updates of several banks.
+ */
+class EulerTraceBank
+{
+private:
+	/*! The size of each trace. */
+	NeuronID size;
+	/*! The SIMD padded length of a single slice. */
+	NeuronID slice_size;
+	/*! The block of memory holding all traces. */
+	gsl_vector_float * state;
+	/*! The traces that are stored in the bank (not owned by the bank). */
+	vector<EulerTrace *> traces;
+	/*! Per trace multiplicative decay factors. */
+	vector<AurynFloat> scale_consts;
+	/*! Number of time steps between two updates. */
+	unsigned int interval;
+	/*! Number of time steps until the next update. */
+	unsigned int countdown;
+
+	void init(NeuronID n, unsigned int k, unsigned int phase);
+	void free();
+	/*! Reallocates the memory block and rebinds all traces to it. */
+	void repack();
+
+public:
+	/*! Default constructor 
+	 * \param n size of the traces that are going to be stored 
+	 * \param k number of time steps between two updates (sub-sampling factor)
+	 * \param phase time step within the first k steps at which the first update happens */
+	EulerTraceBank(NeuronID n, unsigned int k = 1, unsigned int phase = 0);
+	/*! Default destructor */
+	virtual ~EulerTraceBank();
+	/*! Moves the state of trace into the bank. 
+	 * Traces need to be of the same size as the bank. */
+	void add(EulerTrace * trace);
+	/*! Increments unit i in all traces of the bank by 1. */
+	void inc(NeuronID i);
+	/*! Performs the Euler step for all traces in a single pass. 
+	 * Has to be called every time step, also for sub-sampled banks. */
+	void evolve();
+	/*! Returns the sub-sampling factor of the bank */
+	unsigned int get_interval();
+	/*! Returns the number of traces held in the bank */
+	NeuronID get_num_traces();
+};
+
+#endif /*EULERTRACEBANK_H_*/
@@ -0,0 +1,339 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "EventIFGroup.h"
+
+EventIFGroup::EventIFGroup(NeuronID size, AurynFloat load, NeuronID total ) : NeuronGroup(size,load,total)
+{
+	sys->register_spiking_group(this);
+	if ( evolve_locally() ) init();
+}
+
+void EventIFGroup::calculate_scale_constants()
+{
+	decay_mem  = exp(-dt/tau_mem);
+	decay_ampa = exp(-dt/tau_ampa);
+	decay_gaba = exp(-dt/tau_gaba);
+	kernel_ampa = kernel(dt,tau_ampa);
+	kernel_gaba = kernel(dt,tau_gaba);
+}
+
+void EventIFGroup::init()
+{
+	e_rest = -70e-3;
+	e_thr = -50e-3;
+	tau_mem = 20e-3;
+	tau_ampa = 5e-3;
+	tau_gaba = 10e-3;
+	refractory_time = (AurynTime) (5.e-3/dt);
+
+	calculate_scale_constants();
+
+	bg_current = get_state_vector("bg_current");
+	i_exc = get_state_vector("i_exc");
+	i_inh = get_state_vector("i_inh");
+	mem_last = get_state_vector("mem_last");
+	last_update = state_arena->allocate<AurynTime>();
+	ref_until = state_arena->allocate<AurynTime>();
+	active = state_arena->allocate<unsigned char>();
+	enable_input_tracking();
+
+	clear();
+}
+
+void EventIFGroup::clear()
+{
+	clear_spikes();
+	for (NeuronID i = 0; i < get_rank_size(); i++) {
+	   gsl_vector_float_set (mem, i, e_rest);
+	   gsl_vector_float_set (mem_last, i, e_rest);
+	   gsl_vector_float_set (g_ampa, i, 0.);
+	   gsl_vector_float_set (g_gaba, i, 0.);
+	   gsl_vector_float_set (g_nmda, i, 0.);
+	   gsl_vector_float_set (i_exc, i, 0.);
+	   gsl_vector_float_set (i_inh, i, 0.);
+	   gsl_vector_float_set (bg_current, i, 0.);
+	   last_update[i] = sys->get_clock();
+	   ref_until[i] = 0;
+	   active[i] = 0;
+	}
+	active_units.clear();
+	clear_touched_units();
+}
+
+EventIFGroup::~EventIFGroup()
+{
+}
+
+AurynDouble EventIFGroup::kernel(AurynDouble h, AurynFloat tau_syn)
+{
+	if ( fabs(tau_syn-tau_mem) < 1e-9 ) 
+		return h/tau_mem*exp(-h/tau_mem);
+	return tau_syn/(tau_syn-tau_mem)*(exp(-h/tau_syn)-exp(-h/tau_mem));
+}
+
+void EventIFGroup::advance(NeuronID i, AurynTime t)
+{
+	AurynTime t0 = last_update[i];
+	if ( t0 >= t ) return;
+
+	AurynDouble v = mem_last->data[i]-e_rest;
+	AurynDouble ie = i_exc->data[i];
+	AurynDouble ii = i_inh->data[i];
+
+	// the membrane is clamped to rest during the refractory period
+	if ( ref_until[i] > t0 ) {
+		const AurynTime t1 = min(ref_until[i],t);
+		const AurynDouble h = (t1-t0)*dt;
+		ie *= exp(-h/tau_ampa);
+		ii *= exp(-h/tau_gaba);
+		v = 0.;
+		t0 = t1;
+	}
+
+	if ( t > t0 ) {
+		const AurynDouble ib = bg_current->data[i];
+		if ( t-t0 == 1 ) { 
+			v = ib + (v-ib)*decay_mem + ie*kernel_ampa - ii*kernel_gaba;
+			ie *= decay_ampa;
+			ii *= decay_gaba;
+		} else {
+			const AurynDouble h = (t-t0)*dt;
+			v = ib + (v-ib)*exp(-h/tau_mem) + ie*kernel(h,tau_ampa) - ii*kernel(h,tau_gaba);
+			ie *= exp(-h/tau_ampa);
+			ii *= exp(-h/tau_gaba);
+		}
+	}
+
+	mem_last->data[i] = v+e_rest;
+	i_exc->data[i] = ie;
+	i_inh->data[i] = ii;
+	last_update[i] = t;
+}
+
+bool EventIFGroup::may_cross(NeuronID i)
+{
+	// the membrane relaxes towards the sum of the currents which only decay in the absence of input
+	const AurynFloat v = mem_last->data[i]-e_rest;
+	const AurynFloat bound = max(v,bg_current->data[i]) 
+		+ max(i_exc->data[i],0.0f) + max(-i_inh->data[i],0.0f);
+	return e_rest+bound > e_thr;
+}
+
+void EventIFGroup::activate(NeuronID i)
+{
+	active[i] = 1;
+	active_units.push_back(i);
+	wake();
+}
+
+bool EventIFGroup::at_rest()
+{
+	return active_units.empty();
+}
+
+void EventIFGroup::receive(NeuronID i, AurynTime t)
+{
+	float * m = mem->data;
+	float * ml = mem_last->data;
+	const AurynFloat direct = m[i]-ml[i];
+	advance(i,t);
+	i_exc->data[i] += g_ampa->data[i]+g_nmda->data[i];
+	i_inh->data[i] += g_gaba->data[i];
+	g_ampa->data[i] = 0;
+	g_gaba->data[i] = 0;
+	g_nmda->data[i] = 0;
+	if ( ref_until[i] <= t ) 
+		ml[i] += direct;
+	m[i] = ml[i];
+	if ( !active[i] && may_cross(i) ) 
+		activate(i);
+}
+
+void EventIFGroup::collect_input(AurynTime t)
+{
+	float * ga = g_ampa->data;
+	float * gg = g_gaba->data;
+	float * gn = g_nmda->data;
+	float * m = mem->data;
+	float * ml = mem_last->data;
+
+	if ( !untracked_input ) {
+		// the touched units can be a superset, e.g. after zero weights
+		for ( vector<NeuronID>::const_iterator iter = touched_units.begin() ; iter != touched_units.end() ; ++iter ) {
+			const NeuronID i = *iter;
+			if ( ga[i] != 0 || gg[i] != 0 || gn[i] != 0 || m[i] != ml[i] ) 
+				receive(i,t);
+		}
+		clear_touched_units();
+		return;
+	}
+
+	clear_touched_units();
+#ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
+	const __m128 zero = _mm_setzero_ps();
+	for ( NeuronID i = 0 ; i < get_vector_size() ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS ) {
+		__m128 pending = _mm_cmpneq_ps( sse_load(ga+i), zero );
+		pending = _mm_or_ps( pending, _mm_cmpneq_ps( sse_load(gg+i), zero ) );
+		pending = _mm_or_ps( pending, _mm_cmpneq_ps( sse_load(gn+i), zero ) );
+		pending = _mm_or_ps( pending, _mm_cmpneq_ps( sse_load(m+i), sse_load(ml+i) ) );
+		int mask = _mm_movemask_ps( pending );
+		while ( mask ) {
+			const NeuronID unit = i+__builtin_ctz(mask);
+			mask &= mask-1;
+			if ( unit >= get_rank_size() ) break;
+			receive(unit,t);
+		}
+	}
+#else
+	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) {
+		if ( ga[i] != 0 || gg[i] != 0 || gn[i] != 0 || m[i] != ml[i] ) 
+			receive(i,t);
+	}
+#endif
+}
+
+void EventIFGroup::evolve()
+{
+	const AurynTime now = sys->get_clock();
+	collect_input(now);
+
+	float * m = mem->data;
+	float * ml = mem_last->data;
+
+	threshold_crossings.clear();
+	NeuronID k = 0;
+	for ( NeuronID j = 0 ; j < active_units.size() ; ++j ) {
+		const NeuronID i = active_units[j];
+		advance(i,now);
+		if ( ml[i] > e_thr ) {
+			threshold_crossings.push_back(i);
+			ml[i] = e_rest;
+			ref_until[i] = now+refractory_time;
+		}
+		m[i] = ml[i];
+		if ( may_cross(i) ) 
+			active_units[k++] = i;
+		else 
+			active[i] = 0;
+	}
+	active_units.resize(k);
+
+	sort(threshold_crossings.begin(),threshold_crossings.end());
+	push_spikes(&threshold_crossings);
+}
+
+void EventIFGroup::advance_keep_direct(NeuronID i, AurynTime t)
+{
+	const AurynFloat direct = mem->data[i]-mem_last->data[i];
+	advance(i,t);
+	mem->data[i] = mem_last->data[i]+direct;
+}
+
+void EventIFGroup::advance_all()
+{
+	const AurynTime now = sys->get_clock();
+	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) 
+		advance_keep_direct(i,now);
+}
+
+NeuronID EventIFGroup::get_num_active()
+{
+	return active_units.size();
+}
+
+void EventIFGroup::set_bg_current(NeuronID i, AurynFloat current) {
+	if ( localrank(i) ) {
+		NeuronID unit = global2rank(i);
+		advance_keep_direct(unit,sys->get_clock());
+		gsl_vector_float_set ( bg_current , unit , current ) ;
+		if ( !active[unit] && may_cross(unit) ) 
+			activate(unit);
+	}
+}
+
+AurynFloat EventIFGroup::get_bg_current(NeuronID i) {
+	if ( localrank(i) )
+		return gsl_vector_float_get ( bg_current , global2rank(i) ) ;
+	else 
+		return 0;
+}
+
+void EventIFGroup::set_tau_mem(AurynFloat taum)
+{
+	advance_all();
+	tau_mem = taum;
+	calculate_scale_constants();
+}
+
+void EventIFGroup::set_tau_ampa(AurynFloat taum)
+{
+	advance_all();
+	tau_ampa = taum;
+	calculate_scale_constants();
+}
+
+AurynFloat EventIFGroup::get_tau_ampa()
+{
+	return tau_ampa;
+}
+
+void EventIFGroup::set_tau_gaba(AurynFloat taum)
+{
+	advance_all();
+	tau_gaba = taum;
+	calculate_scale_constants();
+}
+
+AurynFloat EventIFGroup::get_tau_gaba()
+{
+	return tau_gaba;
+}
+
+void EventIFGroup::set_refractory_period(AurynDouble t)
+{
+	refractory_time = (AurynTime) (t/dt);
+}
+
+string EventIFGroup::get_output_line(NeuronID i)
+{
+	advance_keep_direct(i,sys->get_clock());
+	stringstream oss;
+	oss << gsl_vector_float_get (mem_last, i) << " " 
+		<< gsl_vector_float_get (i_exc, i) << " " 
+		<< gsl_vector_float_get (i_inh, i) << "\n";
+	return oss.str();
+}
+
+void EventIFGroup::load_input_line(NeuronID i, const char * buf)
+{
+		float vmem,vexc,vinh;
+		sscanf (buf,"%f %f %f",&vmem,&vexc,&vinh);
+		if ( localrank(i) ) {
+			NeuronID trans = global2rank(i);
+			set_mem(trans,vmem);
+			gsl_vector_float_set (mem_last, trans, vmem);
+			gsl_vector_float_set (i_exc, trans, vexc);
+			gsl_vector_float_set (i_inh, trans, vinh);
+			last_update[trans] = sys->get_clock();
+			if ( !active[trans] && may_cross(trans) ) 
+				activate(trans);
+		}
+}
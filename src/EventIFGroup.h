@@ -0,0 +1,125 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EVENTIFGROUP_H_
+#define EVENTIFGROUP_H_
+
+#include "auryn_definitions.h"
+#include "NeuronGroup.h"
+#include "System.h"
+#include <gsl/gsl_vector_float.h>
+#include <algorithm>
+
+/*! \brief Event-driven current based integrate and fire model with exact integration between inputs.
+ *
+ * The subthreshold dynamics tau_mem dV/dt = (e_rest-V) + I_bg + I_exc - I_inh with exponentially 
+ * decaying synaptic currents are linear and are solved exactly. Currents are measured in units of 
+ * the depolarization they would cause at steady state. Instead of integrating all neurons every 
+ * time step, a neuron is only advanced when it receives input or when its state allows a threshold
+ * crossing without further input. All other neurons remain untouched and keep the time stamp of 
+ * their last update. 
+ *
+ * Connections transmit as usual: AMPA (GLUT) and NMDA increment the excitatory current, GABA the 
+ * inhibitory current and MEM directly the membrane potential. g_ampa, g_nmda and g_gaba serve as 
+ * input buffers. Connections, stimulators and the input setters of NeuronGroup report the units 
+ * they write to (see NeuronGroup::enable_input_tracking), so that collecting the input only touches
+ * the units which received spikes. Once a raw pointer to the input vectors was handed out with 
+ * get_ampa_ptr() and friends the buffers are collected with a streaming SIMD scan over all units 
+ * for the rest of the simulation.
+ * Note that mem holds the membrane potential at the time of the last update of each neuron. 
+ * Call advance_all() to bring all neurons up to the current time before reading their state.
+ */
+class EventIFGroup : public NeuronGroup
+{
+private:
+	gsl_vector_float * bg_current;
+	gsl_vector_float * i_exc;
+	gsl_vector_float * i_inh;
+	/*! Membrane potential at the last update. Differences to mem are direct (MEM) inputs. */
+	gsl_vector_float * mem_last;
+	/*! Time of the last update of each neuron */
+	AurynTime * last_update;
+	/*! End of the refractory period of each neuron */
+	AurynTime * ref_until;
+	/*! Flags the neurons in active_units */
+	unsigned char * active;
+	/*! Neurons which are advanced every time step because they might cross threshold */
+	vector<NeuronID> active_units;
+
+	AurynTime refractory_time;
+	AurynFloat e_rest,e_thr,tau_mem;
+	AurynFloat tau_ampa,tau_gaba;
+
+	/*! Propagator constants for a single time step */
+	AurynDouble decay_mem, decay_ampa, decay_gaba, kernel_ampa, kernel_gaba;
+
+	void init();
+	void calculate_scale_constants();
+	/*! Response of the membrane to an exponentially decaying unit current with time constant tau_syn after time h */
+	AurynDouble kernel(AurynDouble h, AurynFloat tau_syn);
+	/*! Solves the dynamics of unit i exactly up to time t */
+	void advance(NeuronID i, AurynTime t);
+	/*! Advances unit i to time t and moves mem along so that pending direct (MEM) input is kept */
+	void advance_keep_direct(NeuronID i, AurynTime t);
+	/*! Returns false if unit i cannot reach threshold without further input */
+	bool may_cross(NeuronID i);
+	/*! Advances unit i to time t and adds its pending input to its state */
+	void receive(NeuronID i, AurynTime t);
+	/*! Calls receive for all units with pending input */
+	void collect_input(AurynTime t);
+	/*! Adds unit i to the active units */
+	void activate(NeuronID i);
+	/*! Returns true if no unit is active, since the group then has nothing to do until it receives input */
+	virtual bool at_rest();
+
+	virtual string get_output_line(NeuronID i);
+	virtual void load_input_line(NeuronID i, const char * buf);
+public:
+	/*! The default constructor of this NeuronGroup */
+	EventIFGroup(NeuronID size, AurynFloat load = 1.0, NeuronID total = 0);
+	virtual ~EventIFGroup();
+
+	/*! Controls the constant current input (per default set so zero) to neuron i */
+	void set_bg_current(NeuronID i, AurynFloat current);
+	/*! Gets the current background current value for neuron i */
+	AurynFloat get_bg_current(NeuronID i);
+	/*! Sets the membrane time constant (default 20ms) */
+	void set_tau_mem(AurynFloat taum);
+	/*! Sets the exponential time constant of excitatory currents (default 5ms) */
+	void set_tau_ampa(AurynFloat tau);
+	/*! Gets the exponential time constant of excitatory currents */
+	AurynFloat get_tau_ampa();
+	/*! Sets the exponential time constant of inhibitory currents (default 10ms) */
+	void set_tau_gaba(AurynFloat tau);
+	/*! Gets the exponential time constant of inhibitory currents */
+	AurynFloat get_tau_gaba();
+	/*! Sets the absolute refractory period (default 5ms) */
+	void set_refractory_period(AurynDouble t);
+	/*! Returns the number of neurons which are currently integrated every time step */
+	NeuronID get_num_active();
+	/*! Brings all neurons up to the current time */
+	void advance_all();
+	/*! Resets all neurons to defined and identical initial state. */
+	void clear();
+	/*! The evolve method internally used by System. */
+	void evolve();
+};
+
+#endif /*EVENTIFGROUP_H_*/
@@ -20,6 +20,11 @@
 
 #include "FileInputGroup.h"
 
+#include <algorithm>
+
+vector<FileInputGroup *> FileInputGroup::text_instances;
+bool FileInputGroup::fork_handler_installed = false;
+
 void FileInputGroup::init(const char * filename)
 {
 	sys->register_spiking_group(this);
@@ -29,17 +34,59 @@ void FileInputGroup::init(const char * filename)
 	therewasalastspike = false;
 
 	active = true;
+	binfile = NULL;
+	prefetcher = NULL;
+	time_scale = 1.0;
 
 	if ( evolve_locally() ) {
+		if ( BinarySpikeFile::is_binary_spike_file(filename) ) {
+			// only the partitions of the neurons on this rank
+			binfile = new BinarySpikeFile(filename,get_locked_range(),communicator->rank()-get_locked_rank());
+			time_scale = binfile->get_dt()/dt;
+			binpos.assign(binfile->get_num_segments(),0);
+			for ( unsigned int s = 0 ; s < binpos.size() ; ++s ) 
+				binfile->prefetch(0,FILEINPUTGROUP_PREFETCH,s);
+			return;
+		}
 		spkfile.open(filename,ifstream::in);
 		if (!spkfile) {
 		  cerr << "Can't open input file " << filename << endl;
 		  exit(1);
 		}
+		spkfile_name = filename;
+		filepos = 0;
+		if ( !fork_handler_installed ) {
+			pthread_atfork(NULL,NULL,reopen_after_fork);
+			fork_handler_installed = true;
+		}
+		text_instances.push_back(this);
+	}
+}
+
+void FileInputGroup::reopen_after_fork()
+{
+	// the file descriptor and with it the read position is shared with the 
+	// parent, whose producer threads may go on reading
+	for ( unsigned int i = 0 ; i < text_instances.size() ; ++i ) {
+		FileInputGroup * group = text_instances[i];
+		const ios::iostate state = group->spkfile.rdstate();
+		group->spkfile.close();
+		group->spkfile.clear();
+		group->spkfile.open(group->spkfile_name.c_str(),ifstream::in);
+		group->spkfile.seekg(group->filepos);
+		group->spkfile.setstate(state);
 	}
 }
 
-FileInputGroup::FileInputGroup(NeuronID n, const char * filename) : SpikingGroup(n, 0.0 ) // last 0 enforces RankLock
+AurynTime FileInputGroup::file2sim(AurynTime t)
+{
+	if ( time_scale == 1.0 ) return t;
+	return (AurynTime)(t*time_scale+0.5);
+}
+
+// a load multiplier of 0 enforces RankLock for text files
+FileInputGroup::FileInputGroup(NeuronID n, const char * filename) 
+: SpikingGroup(n, BinarySpikeFile::is_binary_spike_file(filename) ? FILEINPUTGROUP_LOAD_MULTIPLIER : 0.0 )
 {
 	playinloop = false;
 	dly = 0;
@@ -49,7 +96,7 @@ FileInputGroup::FileInputGroup(NeuronID n, const char * filename) : SpikingGroup
 
 FileInputGroup::FileInputGroup(NeuronID n, const char * filename, 
 		bool loop, AurynFloat delay) 
-: SpikingGroup( n , 0.0 )
+: SpikingGroup( n , BinarySpikeFile::is_binary_spike_file(filename) ? FILEINPUTGROUP_LOAD_MULTIPLIER : 0.0 )
 {
 	playinloop = loop;
 	dly = (AurynTime) (delay/dt);
@@ -59,45 +106,156 @@ FileInputGroup::FileInputGroup(NeuronID n, const char * filename,
 
 FileInputGroup::~FileInputGroup()
 {
+	delete prefetcher; // stops the producer before the files are closed
+	vector<FileInputGroup *>::iterator self = find(text_instances.begin(),text_instances.end(),this);
+	if ( self != text_instances.end() ) text_instances.erase(self);
 	spkfile.close();
+	delete binfile;
 }
 
 
 void FileInputGroup::evolve()
 {
+	if ( prefetcher != NULL ) {
+		prefetcher->pop(sys->get_clock(),spikes);
+		return;
+	}
 
 	if (active) {
-		NeuronID i;
-		AurynFloat t;
+		if ( binfile != NULL ) {
+			read_binary(sys->get_clock(),spikes);
+			AurynTime next;
+			if ( next_binary_spike(next) ) 
+				sleep_until( file2sim(next)+off ); // nothing to do before the next spike
+			else
+				sleep(); // reached the end of the file
+		} else {
+			read_text(sys->get_clock(),spikes);
+			if ( therewasalastspike ) 
+				sleep_until( ftime ); // nothing to do before the next spike
+			else if ( spkfile.eof() ) 
+				sleep(); // reached the end of the file
+		}
+	}
+	else { // keep track of time
+		off = sys->get_clock();
+		ftime = off;
+	}
+}
+
+void FileInputGroup::produce_spikes(AurynTime t, SpikeContainer * out)
+{
+	if ( binfile != NULL ) 
+		read_binary(t,out);
+	else
+		read_text(t,out);
+}
+
+void FileInputGroup::read_text(AurynTime now, SpikeContainer * out)
+{
+	NeuronID i;
+	AurynFloat t;
 
-		if (ftime == sys->get_clock() && therewasalastspike) {
-			if (localrank(lastspike))
-				spikes->push_back(lastspike);
-			therewasalastspike = false;
+	if (ftime == now && therewasalastspike) {
+		if (localrank(lastspike))
+			out->push_back(lastspike);
+		therewasalastspike = false;
+	}
+
+	while (ftime <= now && spkfile.getline(buffer, 256) ) {
+		filepos += spkfile.gcount();
+		istringstream line ( buffer ) ;
+		line >> t;
+		ftime = (AurynTime)(t/dt+0.5)+off;
+		line >> i;
+		if (ftime == now) {
+			if (localrank(i)) 
+				out->push_back(i);
+		} else {
+			lastspike = i;
+			therewasalastspike = true;
 		}
+	}
+
+	if ( playinloop && spkfile.eof() ) {
+		off = ftime+dly;
+		spkfile.clear();
+		spkfile.seekg(0,ios::beg);
+		filepos = 0;
+	}
+}
 
-		while (ftime <= sys->get_clock() && spkfile.getline(buffer, 256) ) {
-			istringstream line ( buffer ) ;
-			line >> t;
-			ftime = t/dt+off;
-			line >> i;
-			if (ftime == sys->get_clock()) {
-				if (localrank(lastspike)) 
-					spikes->push_back(i);
-			} else {
-				lastspike = i;
-				therewasalastspike = true;
+void FileInputGroup::read_binary(AurynTime now, SpikeContainer * out)
+{
+	while ( true ) {
+		bool ended = true;
+		boost::uint64_t num_spikes = 0;
+		for ( unsigned int s = 0 ; s < binpos.size() ; ++s ) {
+			const BinarySpikeEvent * events = binfile->get_events(s);
+			const boost::uint64_t num = binfile->get_segment_size(s);
+			boost::uint64_t pos = binpos[s];
+			while ( pos < num ) {
+				const AurynTime t = file2sim(events[pos].time)+off;
+				if ( t > now ) break;
+				// spikes before now were skipped by seek or while inactive
+				if ( t == now && localrank(events[pos].neuron) ) 
+					out->push_back(events[pos].neuron);
+				++pos;
+				if ( pos%FILEINPUTGROUP_PREFETCH == 0 ) 
+					binfile->prefetch(pos+FILEINPUTGROUP_PREFETCH,FILEINPUTGROUP_PREFETCH,s);
 			}
+			binpos[s] = pos;
+			if ( pos < num ) ended = false;
+			num_spikes += num;
 		}
-
-		if ( playinloop && spkfile.eof() ) {
-			off = ftime+dly;
-			spkfile.clear();
-			spkfile.seekg(0,ios::beg);
+		if ( !ended || !playinloop || num_spikes == 0 ) break;
+		// start over; the loop period is at least one time step and set by 
+		// the last spike of the whole file, not only of the partitions read here
+		off += max(file2sim(binfile->get_last_time())+dly,(AurynTime)1);
+		for ( unsigned int s = 0 ; s < binpos.size() ; ++s ) {
+			binpos[s] = 0;
+			binfile->prefetch(0,FILEINPUTGROUP_PREFETCH,s);
 		}
 	}
-	else { // keep track of time
-		off = sys->get_clock();
-		ftime = off;
+}
+
+bool FileInputGroup::next_binary_spike(AurynTime & t)
+{
+	bool found = false;
+	for ( unsigned int s = 0 ; s < binpos.size() ; ++s ) {
+		if ( binpos[s] >= binfile->get_segment_size(s) ) continue;
+		const AurynTime time = binfile->get_events(s)[binpos[s]].time;
+		if ( !found || time < t ) t = time;
+		found = true;
+	}
+	return found;
+}
+
+void FileInputGroup::enable_prefetching(AurynTime batch_steps, unsigned int num_batches)
+{
+	if ( !evolve_locally() || prefetcher != NULL ) return;
+	prefetcher = new SpikePrefetcher(this,sys->get_clock(),batch_steps,num_batches);
+	wake(); // the group has to pop every step
+	logger->msg("FileInputGroup:: Reading spikes in a producer thread",NOTIFICATION);
+}
+
+void FileInputGroup::seek(AurynFloat time)
+{
+	if ( !evolve_locally() ) return;
+	if ( prefetcher != NULL ) {
+		logger->msg("FileInputGroup:: Can't seek while prefetching.",WARNING);
+		return;
+	}
+	if ( binfile == NULL ) {
+		logger->msg("FileInputGroup:: Seeking requires a binary spike file.",WARNING);
+		return;
+	}
+	const AurynTime t = (AurynTime)(time/binfile->get_dt()+0.5);
+	for ( unsigned int s = 0 ; s < binpos.size() ; ++s ) {
+		binpos[s] = binfile->find(t,s);
+		binfile->prefetch(binpos[s],FILEINPUTGROUP_PREFETCH,s);
 	}
+	// modulo arithmetic makes the offset work when t lies after the current time 
+	off = sys->get_clock()-file2sim(t);
+	wake();
 }
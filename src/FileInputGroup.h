@@ -27,6 +27,12 @@
 #include "auryn_definitions.h"
 #include "System.h"
 #include "SpikingGroup.h"
+#include "BinarySpikeFile.h"
+#include "SpikePrefetcher.h"
+
+#define FILEINPUTGROUP_LOAD_MULTIPLIER 1.0
+/*! Number of spikes of a binary file the kernel is asked to read ahead */
+#define FILEINPUTGROUP_PREFETCH 65536
 
 /*! \brief Reads files from a ras file and emits them as SpikingGroup in a simulation.
  *
@@ -34,8 +40,24 @@
  * depending on the settings start over again at the beginning or do nothing.
  * This is controlled by the loop directive.  In addition to that it is
  * possible to specify a certain delay between loops.
+ *
+ * Besides ras text files the group reads binary spike files (see 
+ * BinarySpikeFile and BinarySpikeWriter::convert_ras) which are memory 
+ * mapped instead of parsed line by line. Groups reading binary files are 
+ * distributed round-robin across ranks like other groups and each rank only
+ * emits the spikes of its own neurons. If the file is partitioned into a 
+ * multiple of the number of ranks of the group, each rank only reads the 
+ * partitions of its own neurons. Otherwise every rank walks over all 
+ * records. Binary files also allow to seek to a given time in the file. 
+ * Groups reading text files are locked to one rank. Processes forked by
+ * ParameterSweep reopen text files at the same position, such that they
+ * do not share the read position with the parent and each other.
+ *
+ * With enable_prefetching() the file is read by a SpikePrefetcher in a 
+ * background thread ahead of the simulation. The group must then not be 
+ * deactivated or seeked anymore.
  */
-class FileInputGroup : public SpikingGroup
+class FileInputGroup : public SpikingGroup, public SpikeProducer
 {
 private:
 	AurynTime ftime;
@@ -46,16 +68,48 @@ private:
 	AurynTime off;
 	ifstream spkfile;
 	const char * fname;
+	/*! Name of the text file */
+	string spkfile_name;
+	/*! Bytes of the text file read so far */
+	streamoff filepos;
 	char buffer[255];
+	/*! Mapped binary spike file or NULL when reading a ras file */
+	BinarySpikeFile * binfile;
+	/*! Next spike in each segment of binfile */
+	vector<boost::uint64_t> binpos;
+	/*! Time step of binfile in units of dt */
+	AurynDouble time_scale;
+	/*! Producer thread reading ahead or NULL */
+	SpikePrefetcher * prefetcher;
+	/*! Groups of this process which read text files */
+	static vector<FileInputGroup *> text_instances;
+	static bool fork_handler_installed;
+	/*! Reopens the text files in a forked child */
+	static void reopen_after_fork();
 	void init(const char * filename );
+	/*! Converts a time in binfile to simulation time steps */
+	AurynTime file2sim(AurynTime t);
+	/*! Reads the spikes of time step now from the text file */
+	void read_text(AurynTime now, SpikeContainer * out);
+	/*! Reads the spikes of time step now from the binary file */
+	void read_binary(AurynTime now, SpikeContainer * out);
+	/*! Returns true and the time step of the next spike in binfile if there is one */
+	bool next_binary_spike(AurynTime & t);
 	
 public:
+	/*! Determines if the group plays the file. Call wake() after changing it 
+	 * during a simulation. */
 	bool active ;
 	FileInputGroup(NeuronID n, const char * filename );
 	FileInputGroup(NeuronID n, const char * filename , bool loop, AurynFloat delay );
 	virtual ~FileInputGroup();
 	virtual void evolve();
-
+	/*! Implementation of SpikeProducer for the prefetcher */
+	virtual void produce_spikes(AurynTime t, SpikeContainer * out);
+	/*! Reads the file in a background thread in batches of batch_steps time steps */
+	void enable_prefetching(AurynTime batch_steps=SPIKEPREFETCHER_BATCH_STEPS, unsigned int num_batches=SPIKEPREFETCHER_NUM_BATCHES);
+	/*! Continues playing the file at the given time in the file (in s) from the current time step on. Only binary files support seeking. */
+	void seek(AurynFloat time);
 };
 
 #endif /*FILEINPUTROUP_H_*/
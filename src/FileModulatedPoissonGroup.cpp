@@ -22,6 +22,7 @@
 
 void FileModulatedPoissonGroup::init ( string filename )
 {
+	prefetcher = NULL;
 	if ( !evolve_locally() ) return;
 
 	inputfile.open(filename.c_str(),ifstream::in);
@@ -41,17 +42,39 @@ FileModulatedPoissonGroup::FileModulatedPoissonGroup(NeuronID n,
 
 FileModulatedPoissonGroup::~FileModulatedPoissonGroup()
 {
+	if ( prefetcher != NULL ) {
+		delete prefetcher; // stops the producer before the file is closed
+		prefetching = false;
+	}
 	inputfile.close();
 }
 
+bool FileModulatedPoissonGroup::can_skip_steps()
+{
+	return false;
+}
+
 void FileModulatedPoissonGroup::evolve()
+{
+	if ( prefetcher != NULL ) 
+		prefetcher->pop(sys->get_clock(),spikes);
+	else
+		generate(sys->get_clock(),spikes);
+}
+
+void FileModulatedPoissonGroup::produce_spikes(AurynTime t, SpikeContainer * out)
+{
+	generate(t,out);
+}
+
+void FileModulatedPoissonGroup::generate(AurynTime now, SpikeContainer * out)
 {
 
 	AurynDouble t ;
 	AurynDouble r ;
 
 	// if there are datapoints in the rate file update linear interpolation
-	while (ftime <= sys->get_clock() && inputfile.getline(buffer, 256) ) {
+	while (ftime <= now && inputfile.getline(buffer, 256) ) {
 		istringstream line ( buffer );
 
 		// save first interpolation point
@@ -69,9 +92,18 @@ void FileModulatedPoissonGroup::evolve()
 
 	}
 
-	AurynDouble rate = rate_m*(sys->get_clock()-ltime)+rate_n;
+	AurynDouble rate = rate_m*(now-ltime)+rate_n;
 	if ( rate > 0.0 ) {
-		set_rate(rate);
-		PoissonGroup::evolve();
+		// the group never sleeps because it can't skip steps
+		change_rate(rate);
+		draw_spikes(out);
 	}
 }
+
+void FileModulatedPoissonGroup::enable_prefetching(AurynTime batch_steps, unsigned int num_batches)
+{
+	if ( !evolve_locally() || prefetcher != NULL ) return;
+	prefetcher = new SpikePrefetcher(this,sys->get_clock(),batch_steps,num_batches);
+	prefetching = true;
+	logger->msg("FileModulatedPoissonGroup:: Reading rates and generating spikes in a producer thread",NOTIFICATION);
+}
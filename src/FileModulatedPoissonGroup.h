@@ -25,6 +25,7 @@
 #include "System.h"
 #include "SpikingGroup.h"
 #include "PoissonGroup.h"
+#include "SpikePrefetcher.h"
 
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int.hpp>
@@ -36,8 +37,11 @@ using namespace std;
 /*! \brief A special Poisson generator that reads its instantaneous
  * firing rate from a tiser file. Datapoints in the rate file are
  * interpolated linearly.
+ *
+ * With enable_prefetching() the rate file is read and the spikes are 
+ * generated in a background thread ahead of the simulation.
  */
-class FileModulatedPoissonGroup : public PoissonGroup
+class FileModulatedPoissonGroup : public PoissonGroup, public SpikeProducer
 {
 private:
 	AurynTime ftime;
@@ -50,12 +54,26 @@ private:
 
 	ifstream inputfile;
 
+	/*! Producer thread generating ahead or NULL */
+	SpikePrefetcher * prefetcher;
+
 	void init ( string filename );
+	/*! Reads the rate file up to time step t and appends the spikes of t to out */
+	void generate(AurynTime t, SpikeContainer * out);
 	
+protected:
+	/*! The rate changes in evolve(), no time steps can be skipped */
+	virtual bool can_skip_steps();
+
 public:
 	FileModulatedPoissonGroup(NeuronID n, string filename );
 	virtual ~FileModulatedPoissonGroup();
 	virtual void evolve();
+	virtual void produce_spikes(AurynTime t, SpikeContainer * out);
+	/*! Reads the rate file and generates the spikes in a background thread 
+	 * in batches of batch_steps time steps. Afterwards set_rate and seed 
+	 * throw AurynPrefetcherException. */
+	void enable_prefetching(AurynTime batch_steps=SPIKEPREFETCHER_BATCH_STEPS, unsigned int num_batches=SPIKEPREFETCHER_NUM_BATCHES);
 };
 
 #endif /*FILEMODULATEDGROUP_H_*/
@@ -127,24 +127,127 @@ void IFGroup::check_thresholds()
 {
 	auryn_vector_float_clip( mem, e_rev );
 
-	float * thr_ptr = thr->data;
-	for ( float * i = mem->data ; i != mem->data+get_rank_size() ; ++i ) { // it's important to use rank_size here otherwise there might be spikes from units that do not exist
-    	if ( *i > ( thr_rest + *thr_ptr ) ) {
-			NeuronID unit = i-mem->data;
+	// it's important to use rank_size here otherwise there might be spikes from units that do not exist
+	threshold_crossings.clear();
+	auryn_vector_float_check_thresholds( mem, thr, thr_rest, e_rest, dthr, get_rank_size(), 
+			&threshold_crossings );
+	push_spikes( &threshold_crossings );
+}
+
+void IFGroup::integrate_fused()
+{
+	const NeuronID n = get_vector_size();
+	float * ga = g_ampa->data;
+	float * gg = g_gaba->data;
+	float * gn = g_nmda->data;
+	float * th = thr->data;
+	float * m = mem->data;
+
+	const float mul_nmda = dt/tau_nmda;
+	const float mul_tau_mem = dt/tau_mem;
+
+#ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
+	const __m128 s_ampa = _mm_set1_ps(scale_ampa);
+	const __m128 s_gaba = _mm_set1_ps(scale_gaba);
+	const __m128 s_thr = _mm_set1_ps(scale_thr);
+	const __m128 a_nmda = _mm_set1_ps(mul_nmda);
+	const __m128 a_nmda_neg = _mm_set1_ps(-mul_nmda);
+	const __m128 c_ampa = _mm_set1_ps(-A_ampa);
+	const __m128 c_nmda = _mm_set1_ps(-A_nmda);
+	const __m128 c_rev = _mm_set1_ps(-e_rev);
+	const __m128 c_rest = _mm_set1_ps(-e_rest);
+	const __m128 a_mem = _mm_set1_ps(mul_tau_mem);
+	const __m128 a_mem_neg = _mm_set1_ps(-mul_tau_mem);
+	const __m128 lo = _mm_set1_ps(e_rev);
+	const __m128 hi = _mm_set1_ps(0.);
+	const __m128 c_thr = _mm_set1_ps(thr_rest);
+
+	for ( NeuronID i = 0 ; i < n ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS ) {
+		// synapses
+		__m128 v_ampa = _mm_mul_ps( sse_load(ga+i), s_ampa );
+		__m128 v_gaba = _mm_mul_ps( sse_load(gg+i), s_gaba );
+		__m128 v_nmda = _mm_add_ps( _mm_mul_ps( a_nmda, v_ampa ), sse_load(gn+i) );
+		v_nmda = _mm_add_ps( _mm_mul_ps( a_nmda_neg, v_nmda ), v_nmda );
+		sse_store( ga+i, v_ampa );
+		sse_store( gg+i, v_gaba );
+		sse_store( gn+i, v_nmda );
+
+		// currents
+		__m128 v_mem = sse_load(m+i);
+		__m128 v_exc = _mm_mul_ps( v_ampa, c_ampa );
+		v_exc = _mm_add_ps( _mm_mul_ps( c_nmda, v_nmda ), v_exc );
+		v_exc = _mm_mul_ps( v_exc, v_mem );
+		__m128 v_inh = _mm_mul_ps( _mm_add_ps( v_mem, c_rev ), v_gaba );
+		__m128 v_leak = _mm_add_ps( v_mem, c_rest );
+
+		// membrane and moving threshold
+		__m128 v_thr = _mm_mul_ps( sse_load(th+i), s_thr );
+		v_mem = _mm_add_ps( _mm_mul_ps( a_mem, v_exc ), v_mem );
+		v_mem = _mm_add_ps( _mm_mul_ps( a_mem_neg, v_inh ), v_mem );
+		v_mem = _mm_add_ps( _mm_mul_ps( a_mem_neg, v_leak ), v_mem );
+		v_mem = _mm_max_ps( _mm_min_ps( v_mem, hi ), lo );
+		sse_store( m+i, v_mem );
+		sse_store( th+i, v_thr );
+
+		// spikes
+		int mask = _mm_movemask_ps( _mm_cmpgt_ps( v_mem, _mm_add_ps( c_thr, v_thr ) ) );
+		while ( mask ) {
+			NeuronID unit = i+__builtin_ctz(mask);
+			mask &= mask-1;
+			// padding units beyond rank_size must not spike
+			if ( unit >= get_rank_size() ) break;
 			push_spike(unit);
-		    set_val (mem, unit, e_rest); // reset
-	        set_val (thr, unit, dthr); //refractory
-		} 
-		thr_ptr++;
+			m[unit] = e_rest; // reset
+			th[unit] = dthr; //refractory
+		}
 	}
+#else
+	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) {
+		ga[i] *= scale_ampa;
+		gg[i] *= scale_gaba;
+		gn[i] = mul_nmda * ga[i] + gn[i];
+		gn[i] = -mul_nmda * gn[i] + gn[i];
+
+		float exc = -A_nmda * gn[i] + ga[i] * -A_ampa;
+		exc *= m[i];
+		float inh = (m[i] - e_rev) * gg[i];
+		float leak = m[i] - e_rest;
 
+		th[i] *= scale_thr;
+		m[i] = mul_tau_mem * exc + m[i];
+		m[i] = -mul_tau_mem * inh + m[i];
+		m[i] = -mul_tau_mem * leak + m[i];
+		if ( m[i] > 0. ) m[i] = 0.;
+		if ( m[i] < e_rev ) m[i] = e_rev;
+
+		if ( m[i] > ( thr_rest + th[i] ) ) {
+			push_spike(i);
+			m[i] = e_rest; // reset
+			th[i] = dthr; //refractory
+		}
+	}
+#endif
 }
 
 void IFGroup::evolve()
 {
+#ifdef CODE_USE_FUSED_NEURON_KERNELS
+	integrate_fused();
+#else
 	integrate_linear_nmda_synapses();
 	integrate_membrane();
 	check_thresholds();
+#endif
+}
+
+bool IFGroup::at_rest()
+{
+	if ( rest_tolerance <= 0.0 ) return false;
+	return within_rest_tolerance(mem,e_rest) 
+		&& within_rest_tolerance(thr,0.0) 
+		&& within_rest_tolerance(g_ampa,0.0) 
+		&& within_rest_tolerance(g_gaba,0.0) 
+		&& within_rest_tolerance(g_nmda,0.0);
 }
 
 
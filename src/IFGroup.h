@@ -36,6 +36,9 @@
  * equation. The amplitude between the individual contributions can be 
  * ajusted via set_ampa_nmda_ratio. The voltage dependence of NMDA is 
  * ignored in this model.
+ *
+ * With CODE_USE_FUSED_NEURON_KERNELS (the default) the state vectors t_exc,
+ * t_inh and t_leak are not updated and hold stale values if recorded.
  */
 class IFGroup : public NeuronGroup
 {
@@ -54,6 +57,16 @@ private:
 	void integrate_membrane();
 	void integrate_linear_nmda_synapses();
 	void check_thresholds();
+	/*! Performs the same Euler step as the separate integration and 
+	 * threshold functions in a single pass over the state vectors without 
+	 * temporary vectors. The arithmetic is carried out in the same order, 
+	 * which gives the same results as the multi-pass implementation up to
+	 * compiler reassociation (see CODE_USE_FUSED_NEURON_KERNELS). Note that 
+	 * t_exc, t_inh and t_leak are not updated. */
+	void integrate_fused();
+	/*! Returns true if mem, thr and all conductances are within rest_tolerance of rest 
+	 * (approximate, see NeuronGroup::set_rest_tolerance) */
+	virtual bool at_rest();
 public:
 	/*! Default constructor.
 	 *
@@ -71,6 +71,11 @@ void IdentityConnection::finalize()
 {
 }
 
+bool IdentityConnection::is_quiescent()
+{
+	return src->get_spikes()->empty();
+}
+
 void IdentityConnection::propagate()
 {
 	SpikeContainer::const_iterator spikes_end = src->get_spikes()->end();
@@ -85,6 +90,17 @@ void IdentityConnection::propagate()
 	}
 }
 
+void IdentityConnection::mark_targets()
+{
+	SpikeContainer::const_iterator spikes_end = src->get_spikes()->end();
+	for (SpikeContainer::const_iterator spike = src->get_spikes()->begin() ;
+			spike != spikes_end ; ++spike ) {
+		const NeuronID id = ( *spike/every ) + offset;
+		if ( *spike%every == 0 && dst->localrank(id) )
+			dst->mark_input(dst->global2rank(id));
+	}
+}
+
 AurynWeight IdentityConnection::get_data(NeuronID i)
 {
 	return 0;
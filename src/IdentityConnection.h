@@ -68,6 +68,9 @@ public:
 	void finalize();
 	AurynLong get_nonzero();
 	virtual void propagate();
+	virtual void mark_targets();
+	/*! Returns true if there are no presynaptic spikes to propagate */
+	virtual bool is_quiescent();
 
 	virtual void stats(AurynFloat &mean, AurynFloat &std);
 	virtual bool write_to_file(const char * filename);
@@ -0,0 +1,245 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "InhomogeneousPoissonGroup.h"
+
+void InhomogeneousPoissonGroup::init(AurynFloat rate)
+{
+	sys->register_spiking_group(this);
+	rates = NULL;
+	rates_changed = true;
+	rates_exposed = false;
+	max_rate = 0.0;
+	x = 0;
+	rate_source = NULL;
+	source_gain = 1.0;
+	source_offset = 0.0;
+	// different streams on each rank and for each instance
+	const int s = communicator->rank()+1000003*get_uid();
+	seed(s);
+
+	if ( evolve_locally() ) {
+		rates = get_state_vector("rate");
+		gsl_vector_float_set_zero(rates); // padding must not spike 
+		set_rate(rate);
+
+		stringstream oss;
+		oss << "InhomogeneousPoissonGroup:: Seeding with " << s;
+		logger->msg(oss.str(),NOTIFICATION);
+	}
+}
+
+InhomogeneousPoissonGroup::InhomogeneousPoissonGroup(NeuronID n, AurynFloat rate) 
+: SpikingGroup( n , INHOMOGENEOUSPOISSON_LOAD_MULTIPLIER*rate ) 
+{
+	init(rate);
+}
+
+InhomogeneousPoissonGroup::~InhomogeneousPoissonGroup()
+{
+}
+
+void InhomogeneousPoissonGroup::set_rate(AurynFloat rate)
+{
+	if ( !evolve_locally() ) return;
+	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) 
+		rates->data[i] = rate;
+	rates_changed = true;
+}
+
+void InhomogeneousPoissonGroup::set_rate(NeuronID i, AurynFloat rate)
+{
+	if ( rates != NULL && localrank(i) ) {
+		rates->data[global2rank(i)] = rate;
+		rates_changed = true;
+	}
+}
+
+AurynFloat InhomogeneousPoissonGroup::get_rate(NeuronID i)
+{
+	if ( rates != NULL && localrank(i) ) 
+		return rates->data[global2rank(i)];
+	return 0.0;
+}
+
+gsl_vector_float * InhomogeneousPoissonGroup::get_rates_ptr()
+{
+	// the vector may be changed at any time from now on
+	rates_exposed = true;
+	return rates;
+}
+
+void InhomogeneousPoissonGroup::load_rates(string filename)
+{
+	ifstream infile(filename.c_str());
+	if (!infile) {
+		stringstream oss;
+		oss << "InhomogeneousPoissonGroup:: Can't open rate file " << filename;
+		logger->msg(oss.str(),ERROR);
+		throw AurynOpenFileException();
+	}
+
+	char buffer[256];
+	NeuronID count = 0;
+	while ( infile.getline(buffer,255) ) {
+		if ( buffer[0] == '#' ) continue;
+		NeuronID i;
+		AurynFloat rate;
+		if ( sscanf(buffer,"%u %f",&i,&rate) != 2 ) continue;
+		if ( i < get_size() ) {
+			set_rate(i,rate);
+			++count;
+		}
+	}
+	infile.close();
+
+	stringstream oss;
+	oss << "InhomogeneousPoissonGroup:: Read " << count << " rates from " << filename;
+	logger->msg(oss.str(),NOTIFICATION);
+}
+
+void InhomogeneousPoissonGroup::set_rate_source(gsl_vector_float * source, AurynFloat gain, AurynFloat offset)
+{
+	if ( rates != NULL && source != NULL && source->size < rates->size ) {
+		logger->msg("InhomogeneousPoissonGroup:: Rate source is smaller than the group.",ERROR);
+		return;
+	}
+	rate_source = source;
+	source_gain = gain;
+	source_offset = offset;
+}
+
+void InhomogeneousPoissonGroup::seed(int s)
+{
+	// initialize each lane with splitmix32 so that nearby seeds give unrelated streams 
+	boost::uint32_t z = 2654435769u*(boost::uint32_t)(s+1);
+	for ( int k = 0 ; k < 16 ; ++k ) {
+		z += 0x9e3779b9u;
+		boost::uint32_t t = z;
+		t = (t^(t>>16))*0x85ebca6bu;
+		t = (t^(t>>13))*0xc2b2ae35u;
+		t ^= t>>16;
+		rng_state[k] = t ? t : 1; 
+	}
+}
+
+boost::uint32_t InhomogeneousPoissonGroup::next_random()
+{
+	// xorshift128 on lane 0 
+	boost::uint32_t t = rng_state[0]^(rng_state[0]<<11);
+	rng_state[0] = rng_state[4]; rng_state[4] = rng_state[8]; rng_state[8] = rng_state[12];
+	rng_state[12] = (rng_state[12]^(rng_state[12]>>19))^(t^(t>>8));
+	return rng_state[12];
+}
+
+void InhomogeneousPoissonGroup::update_max_rate()
+{
+	AurynFloat m = 0.0;
+	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) 
+		if ( rates->data[i] > m ) m = rates->data[i];
+	if ( m != max_rate ) {
+		max_rate = m;
+		// the pending gap was drawn for the old maximum 
+		x = skip();
+	}
+	rates_changed = false;
+}
+
+NeuronID InhomogeneousPoissonGroup::skip()
+{
+	const AurynDouble p = max_rate*dt;
+	if ( p <= 0.0 ) return 0;
+	if ( p >= 1.0 ) return 0;
+	const AurynDouble r = log((next_random()+0.5)*(1.0/4294967296.0))/log(1.0-p);
+	if ( r > 1e9 ) return 1000000000;
+	return (NeuronID) r;
+}
+
+void InhomogeneousPoissonGroup::evolve_sparse()
+{
+	// candidates with probability max_rate*dt per neuron and time step by 
+	// geometric jumps across time steps, accepted with probability rate/max_rate
+	const NeuronID n = get_rank_size();
+	const float * r = rates->data;
+	const AurynDouble scale = 1.0/max_rate*4294967296.0;
+	while ( x < n ) {
+		if ( next_random() < r[x]*scale ) 
+			push_spike(x);
+		x += 1+skip();
+	}
+	x -= n;
+}
+
+void InhomogeneousPoissonGroup::evolve()
+{
+	if ( rate_source != NULL ) {
+		for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) 
+			rates->data[i] = source_gain*rate_source->data[i]+source_offset;
+	}
+
+	if ( rates_changed || rates_exposed || rate_source != NULL ) 
+		update_max_rate();
+
+	if ( max_rate <= 0.0 ) return;
+	if ( max_rate*dt < INHOMOGENEOUSPOISSON_DENSE_THRESHOLD ) {
+		evolve_sparse();
+		return;
+	}
+
+	const NeuronID n = get_rank_size();
+	const float * r = rates->data;
+
+	// xorshift128 in four lanes: neuron i uses lane i%4, state words are stored
+	// as x[0..3], y[0..3], z[0..3], w[0..3]
+#ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
+	__m128i x = _mm_loadu_si128((__m128i*)(rng_state+0));
+	__m128i y = _mm_loadu_si128((__m128i*)(rng_state+4));
+	__m128i z = _mm_loadu_si128((__m128i*)(rng_state+8));
+	__m128i w = _mm_loadu_si128((__m128i*)(rng_state+12));
+	const __m128 scale = _mm_set1_ps(dt*16777216.0f);
+	for ( NeuronID i = 0 ; i < n ; i += 4 ) {
+		__m128i t = _mm_xor_si128(x,_mm_slli_epi32(x,11));
+		x = y; y = z; z = w;
+		w = _mm_xor_si128( _mm_xor_si128(w,_mm_srli_epi32(w,19)), _mm_xor_si128(t,_mm_srli_epi32(t,8)) );
+		// 24 bit random integer against rate*dt*2^24, negative rates never spike
+		const __m128 u = _mm_cvtepi32_ps(_mm_srli_epi32(w,8));
+		const int mask = _mm_movemask_ps( _mm_cmplt_ps( u, _mm_mul_ps(_mm_loadu_ps(r+i),scale) ) );
+		for ( int m = mask ; m ; m &= m-1 ) {
+			const NeuronID k = i+__builtin_ctz(m);
+			if ( k < n ) push_spike(k);
+		}
+	}
+	_mm_storeu_si128((__m128i*)(rng_state+0),x);
+	_mm_storeu_si128((__m128i*)(rng_state+4),y);
+	_mm_storeu_si128((__m128i*)(rng_state+8),z);
+	_mm_storeu_si128((__m128i*)(rng_state+12),w);
+#else
+	const float scale = dt*16777216.0f;
+	boost::uint32_t * s = rng_state;
+	for ( NeuronID i = 0 ; i < n ; i += 4 ) {
+		for ( int b = 0 ; b < 4 ; ++b ) {
+			boost::uint32_t t = s[b]^(s[b]<<11);
+			s[b] = s[4+b]; s[4+b] = s[8+b]; s[8+b] = s[12+b];
+			s[12+b] = (s[12+b]^(s[12+b]>>19))^(t^(t>>8));
+			if ( i+b < n && (float)(s[12+b]>>8) < r[i+b]*scale ) push_spike(i+b);
+		}
+	}
+#endif 
+}
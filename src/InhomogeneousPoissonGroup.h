@@ -0,0 +1,118 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INHOMOGENEOUSPOISSONGROUP_H_
+#define INHOMOGENEOUSPOISSONGROUP_H_
+
+#include "auryn_definitions.h"
+#include "System.h"
+#include "SpikingGroup.h"
+
+#include <boost/cstdint.hpp>
+
+#define INHOMOGENEOUSPOISSON_LOAD_MULTIPLIER 0.01
+/*! Spike probability per time step of the fastest neuron below which spikes are generated by thinning */
+#define INHOMOGENEOUSPOISSON_DENSE_THRESHOLD 0.2
+
+using namespace std;
+
+/*! \brief A SpikingGroup of Poisson neurons with individual firing rates which may change in every time step
+ *
+ * Each neuron emits a spike in a time step with probability rate*dt 
+ * (clipped to one) which gives the exact mean rate for any rate below 1/dt. 
+ * When the fastest neuron spikes with a probability above 
+ * INHOMOGENEOUSPOISSON_DENSE_THRESHOLD per step, the group draws one random 
+ * number per neuron and time step. These come from four interleaved 
+ * xorshift128 generators which are evaluated four neurons at a time with SSE
+ * instructions, so that the cost per neuron is a handful of instructions. At 
+ * lower rates candidate spikes are generated at the maximum rate by jumping 
+ * from candidate to candidate like PoissonGroup does and are accepted with 
+ * probability rate/max_rate.
+ *
+ * The rates are stored in the state vector "rate" and can be set 
+ * individually, loaded from a rate map file or written directly to the 
+ * vector returned by get_rates_ptr() in every time step. In the latter case 
+ * the maximum rate is recomputed in every step. Alternatively a rate 
+ * source, for instance the state vector of another group of the same size, 
+ * can be set from which the rates are computed as gain*source+offset in 
+ * every time step.
+ *
+ * The default seed depends on the rank and the unique id of the group, 
+ * such that each rank and each instance draws a different spike train. Use
+ * seed() to change the seed.
+ */
+class InhomogeneousPoissonGroup : public SpikingGroup
+{
+private:
+	/*! Per neuron firing rates in Hz */
+	gsl_vector_float * rates;
+	/*! Optional vector the rates are computed from */
+	gsl_vector_float * rate_source;
+	AurynFloat source_gain;
+	AurynFloat source_offset;
+	/*! State of the four interleaved xorshift128 generators, lane-major */
+	boost::uint32_t rng_state[16];
+	/*! Maximum rate on this rank */
+	AurynFloat max_rate;
+	/*! True if max_rate needs to be recomputed */
+	bool rates_changed;
+	/*! True once get_rates_ptr was called and the rates can change unnoticed */
+	bool rates_exposed;
+	/*! Next candidate neuron in sparse mode */
+	NeuronID x;
+
+	void init(AurynFloat rate);
+	/*! Returns the next 32 bit random number of the first generator */
+	boost::uint32_t next_random();
+	/*! Draws the number of neurons until the next candidate in sparse mode */
+	NeuronID skip();
+	void update_max_rate();
+	/*! Thinning of the spike train at max_rate for low rates */
+	void evolve_sparse();
+
+public:
+	/*! Standard constructor. 
+	 * @param n is the size of the SpikingGroup, i.e. the number of Poisson neurons.
+	 * @param rate is the initial firing rate of all neurons.
+	 */
+	InhomogeneousPoissonGroup(NeuronID n, AurynFloat rate=5. );
+	/*! Default destructor */
+	virtual ~InhomogeneousPoissonGroup();
+	/*! Evolve function for internal use by System */
+	virtual void evolve();
+	/*! Sets the firing rate of all neurons */
+	void set_rate(AurynFloat rate);
+	/*! Sets the firing rate of neuron i given by its global ID */
+	void set_rate(NeuronID i, AurynFloat rate);
+	/*! Returns the firing rate of neuron i given by its global ID */
+	AurynFloat get_rate(NeuronID i);
+	/*! Returns the rate vector of the neurons on this rank which can be modified in every time step */
+	gsl_vector_float * get_rates_ptr();
+	/*! Loads a rate map from a file with lines of the form "neuron_id rate". Neurons not listed keep their rate. */
+	void load_rates(string filename);
+	/*! Computes the rates as gain*source+offset in every time step. The source must have 
+	 * (at least) the vector size of this group on each rank, for instance 
+	 * another group's state vector. Pass NULL to remove the source. */
+	void set_rate_source(gsl_vector_float * source, AurynFloat gain=1.0, AurynFloat offset=0.0);
+	/*! Use this to seed the random number generators. */
+	void seed(int s);
+};
+
+#endif /*INHOMOGENEOUSPOISSONGROUP_H_*/
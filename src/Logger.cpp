@@ -27,8 +27,9 @@ Logger::Logger(string filename, int rank, LogMessageType console, LogMessageType
 	set_rank(rank);
 	fname = filename;
 
-	outfile.open(fname.c_str(),ios::out);
-	if (!outfile) {
+	if ( !fname.empty() ) // an empty file name only logs to the console
+		outfile.open(fname.c_str(),ios::out);
+	if ( !fname.empty() && !outfile ) {
 	  cerr << "Can't open output file " << fname << endl;
 	  throw 1;
 	}
@@ -88,7 +89,7 @@ void Logger::msg( string text, LogMessageType type, bool global, int line, strin
 		} 
 	}
 
-	if ( type >= file_out)
+	if ( type >= file_out && outfile.is_open() )
 		outfile << oss.str() << endl;
 
 	last_message = text;
@@ -22,28 +22,33 @@
 
 void Monitor::init(string filename)
 {
+	active = true;
 	if ( filename.empty() ) return; // stimulators do not necessary need an outputfile
 
 	fname = filename;
-	active = true;
 
-	outfile.open(filename.c_str(),ios::out);
-	if (!outfile) {
+	try {
+		outbuf = new AsyncStreamBuffer(filename);
+	} catch ( AurynOpenFileException & e ) {
 	  stringstream oss;
 	  oss << "Can't open output file " << filename;
 	  logger->msg(oss.str(),ERROR);
 	  exit(1);
 	}
+	outfile.rdbuf(outbuf);
 
 	outfile << setiosflags(ios::fixed) << setprecision(log(dt)/log(10)+1);
 }
 
-Monitor::Monitor()
+Monitor::Monitor() : outfile(NULL)
 {
+	active = true;
+	outbuf = NULL;
 }
 
-Monitor::Monitor(string filename)
+Monitor::Monitor(string filename) : outfile(NULL)
 {
+	outbuf = NULL;
 	init(filename);
 }
 
@@ -54,6 +59,14 @@ Monitor::~Monitor()
 
 void Monitor::free()
 {
-	outfile.close();
+	outfile.rdbuf(NULL);
+	delete outbuf; // closes the file
+	outbuf = NULL;
+}
+
+void Monitor::flush()
+{
+	if ( outbuf != NULL ) 
+		outbuf->flush();
 }
 
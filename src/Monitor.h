@@ -22,6 +22,7 @@
 #define MONITOR_H_
 
 #include "auryn_definitions.h"
+#include "AsyncFileWriter.h"
 #include <fstream>
 #include <string>
 
@@ -32,14 +33,17 @@ class System;
 /*! \brief Abstract base class for all Monitor objects.
  * 
  * This Class constitutes the base class for all Monitors in Auryn. Per default it openes a single text file for writing (outfile) named by the name supplied in the constructor.
+ * The output of all monitors of a rank is aggregated in large blocks and written by the writer thread of the AsyncIOService. The files are complete after flush(), which System calls at the end of each run.
  * Classes inheriting from Monitor have to implement the method propagate. Unlike Checker objects propagate returns void. Use Checker if you need the Monitor to be able to interrupt a run. 
  */
 
 class Monitor
 {
 protected:
-	/*! Output filestream to be used in the derived classes */
-	ofstream outfile;
+	/*! Output stream to be used in the derived classes */
+	ostream outfile;
+	/*! Buffer of outfile which passes the output to the AsyncIOService */
+	AsyncStreamBuffer * outbuf;
 	/*! Stores output filename */
 	string fname;
 	/*! Standard initializer to be called by the constructor */
@@ -58,6 +62,8 @@ public:
 	virtual ~Monitor();
 	/*! Virtual propagate function to be called in central simulation loop in System */
 	virtual void propagate() = 0;
+	/*! Writes buffered output to the file */
+	virtual void flush();
 };
 
 extern System * sys;
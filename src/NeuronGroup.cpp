@@ -38,13 +38,18 @@ void NeuronGroup::init()
 		g_gaba = get_state_vector("g_gaba");
 		g_nmda = get_state_vector("g_nmda");
 
+		rest_tolerance = 0.0;
+		input_tracking = false;
+		untracked_input = false;
+		touched = NULL;
+
 #ifndef CODE_ALIGNED_SSE_INSTRUCTIONS
 		// checking via default if those arrays are aligned
-		if ( auryn_AlignOffset( mem->size, mem->data, sizeof(float), 16) 
-				|| auryn_AlignOffset( thr->size, thr->data, sizeof(float), 16) 
-				|| auryn_AlignOffset( g_ampa->size, g_ampa->data, sizeof(float), 16) 
-				|| auryn_AlignOffset( g_nmda->size, g_nmda->data, sizeof(float), 16) 
-				|| auryn_AlignOffset( g_gaba->size, g_gaba->data, sizeof(float), 16) ) 
+		if ( auryn_AlignOffset( mem->size, mem->data, sizeof(float), SIMD_MEMORY_ALIGNMENT) 
+				|| auryn_AlignOffset( thr->size, thr->data, sizeof(float), SIMD_MEMORY_ALIGNMENT) 
+				|| auryn_AlignOffset( g_ampa->size, g_ampa->data, sizeof(float), SIMD_MEMORY_ALIGNMENT) 
+				|| auryn_AlignOffset( g_nmda->size, g_nmda->data, sizeof(float), SIMD_MEMORY_ALIGNMENT) 
+				|| auryn_AlignOffset( g_gaba->size, g_gaba->data, sizeof(float), SIMD_MEMORY_ALIGNMENT) ) 
 			throw AurynMemoryAlignmentException();
 #endif
 }
@@ -85,12 +90,14 @@ AurynState NeuronGroup::get_mem(NeuronID i)
 
 gsl_vector_float * NeuronGroup::get_mem_ptr()
 {
+	untracked_input = true;
 	return mem;
 }
 
 void NeuronGroup::set_mem(NeuronID i, AurynState val)
 {
 	set_val(mem,i,val);
+	notify_input(i);
 }
 
 
@@ -101,6 +108,7 @@ AurynState NeuronGroup::get_ampa(NeuronID i)
 
 gsl_vector_float * NeuronGroup::get_ampa_ptr()
 {
+	untracked_input = true;
 	return g_ampa;
 }
 
@@ -111,6 +119,7 @@ AurynState NeuronGroup::get_gaba(NeuronID i)
 
 gsl_vector_float * NeuronGroup::get_gaba_ptr()
 {
+	untracked_input = true;
 	return g_gaba;
 }
 
@@ -121,22 +130,69 @@ AurynState NeuronGroup::get_nmda(NeuronID i)
 
 gsl_vector_float * NeuronGroup::get_nmda_ptr()
 {
+	untracked_input = true;
 	return g_nmda;
 }
 
+gsl_vector_float * NeuronGroup::get_input_vector(TransmitterType t)
+{
+	switch ( t ) {
+		case GABA:
+			return g_gaba;
+		case MEM:
+			return mem;
+		case NMDA:
+			return g_nmda;
+		case GLUT:
+		case AMPA:
+		default:
+			return g_ampa;
+	}
+}
+
+bool NeuronGroup::tracks_input()
+{
+	return input_tracking;
+}
+
+void NeuronGroup::enable_input_tracking()
+{
+	if ( input_tracking ) return;
+	touched = state_arena->allocate<unsigned char>();
+	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) 
+		touched[i] = 0;
+	input_tracking = true;
+}
+
+void NeuronGroup::clear_touched_units()
+{
+	for ( vector<NeuronID>::const_iterator iter = touched_units.begin() ; iter != touched_units.end() ; ++iter ) 
+		touched[*iter] = 0;
+	touched_units.clear();
+}
+
 void NeuronGroup::set_ampa(NeuronID i, AurynState val)
 {
 	set_val(g_ampa,i,val);
+	notify_input(i);
 }
 
 void NeuronGroup::set_gaba(NeuronID i, AurynState val)
 {
 	set_val(g_gaba,i,val);
+	notify_input(i);
 }
 
 void NeuronGroup::set_nmda(NeuronID i, AurynState val)
 {
 	set_val(g_nmda,i,val);
+	notify_input(i);
+}
+
+void NeuronGroup::notify_input(NeuronID i)
+{
+	if ( input_tracking ) mark_input(i);
+	wake();
 }
 
 void NeuronGroup::random_mem(AurynState mean, AurynState sigma)
@@ -214,6 +270,20 @@ void NeuronGroup::init_state()
 
 }
 
+void NeuronGroup::set_rest_tolerance(AurynFloat tol)
+{
+	rest_tolerance = tol;
+}
+
+bool NeuronGroup::within_rest_tolerance(gsl_vector_float * vec, AurynState value)
+{
+	const float * v = vec->data;
+	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) 
+		if ( fabs(v[i]-value) > rest_tolerance ) 
+			return false;
+	return true;
+}
+
 
 
 
@@ -249,5 +319,6 @@ void NeuronGroup::tadd(NeuronID id, AurynWeight amount, TransmitterType t)
 	} else {
 		add_val(g_gaba,localid,amount);
 	}
+	notify_input(localid);
 }
 
@@ -52,10 +52,39 @@ protected:
 	gsl_vector_float * g_nmda __attribute__((aligned(16)));
 	/*! Stores  threshold terms for moving thresholds. */
 	gsl_vector_float * thr __attribute__((aligned(16)));
+	/*! Rank local units which crossed threshold in the current time step. */
+	SpikeContainer threshold_crossings;
+	/*! Maximum deviation from rest of the state variables for which the group 
+	 * counts as being at rest. Zero disables the detection. A positive value 
+	 * changes the simulation results (see set_rest_tolerance). */
+	AurynFloat rest_tolerance;
+	/*! Set by groups which only process the units in touched_units (see enable_input_tracking) */
+	bool input_tracking;
+	/*! Set once a raw pointer to an input vector was handed out, after which 
+	 * writes to the input vectors can't be tracked anymore */
+	bool untracked_input;
+	/*! Flags the units in touched_units */
+	unsigned char * touched;
+	/*! Rank local units which received input since the last clear_touched_units() */
+	vector<NeuronID> touched_units;
+
+	/*! Returns true if all elements of vec are within rest_tolerance of value. */
+	bool within_rest_tolerance(gsl_vector_float * vec, AurynState value);
 
 	/*! Init procedure called by default constructor. */
 	void init();
 
+	/*! Makes connections (see Connection::mark_targets) and the input setters 
+	 * record the units which receive input in touched_units. Groups can then process only these
+	 * units instead of scanning the input vectors, unless untracked_input is 
+	 * set. Has to be called before the connections to the group are created. */
+	void enable_input_tracking();
+	/*! Empties touched_units */
+	void clear_touched_units();
+	/*! Records input to unit i from outside the group and wakes the group. 
+	 * Called by the setters of the input vectors and tadd. */
+	void notify_input(NeuronID i);
+
 	/*! Called by default destructor */
 	void free();
 
@@ -70,12 +99,20 @@ public:
 	virtual void clear() = 0;
 
 	AurynState get_val(gsl_vector_float* vec, NeuronID i);
+	/*! Plain element access, e.g. for the group's own state. Unlike set_mem 
+	 * and friends this neither wakes a quiescent group nor records input. */
 	void set_val(gsl_vector_float* vec, NeuronID i, AurynState val);
 	void add_val(gsl_vector_float* vec, NeuronID i, AurynState val);
 	void clip_val(gsl_vector_float* vec, NeuronID i, AurynState max);
 	void print_val(gsl_vector_float* vec, NeuronID i, const char * name);
 	void print_vec(gsl_vector_float* vec, const char * name);
 	AurynState get_mem(NeuronID i);
+	/*! Returns the membrane vector. Writes through this pointer (or the ones 
+	 * returned by get_ampa_ptr, get_gaba_ptr and get_nmda_ptr) can't be 
+	 * tracked, so handing it out permanently switches a group which tracks 
+	 * its input (see enable_input_tracking) back to scanning all units. For 
+	 * read access use get_state_vector, to write input use get_input_vector 
+	 * and mark_input. */
 	gsl_vector_float * get_mem_ptr();
 	void set_mem(NeuronID i, AurynState val);
 	AurynState get_ampa(NeuronID i);
@@ -87,6 +124,14 @@ public:
 	AurynState get_nmda(NeuronID i);
 	void set_nmda(NeuronID i,AurynState val);
 	gsl_vector_float * get_nmda_ptr();
+	/*! Returns the input vector transmitter t acts on. Unlike get_ampa_ptr() 
+	 * and friends this does not disable input tracking, so all writes have to 
+	 * be reported with mark_input if tracks_input() is true. */
+	gsl_vector_float * get_input_vector(TransmitterType t);
+	/*! Returns true if writes to the input vectors have to be reported with mark_input */
+	bool tracks_input();
+	/*! Records that the rank local unit i received input */
+	inline void mark_input(NeuronID i);
 
 	void random_mem(AurynState mean, AurynState sigma);
 	void random_uniform_mem(AurynState lo, AurynState hi);
@@ -95,6 +140,19 @@ public:
 
 	virtual void init_state();
 
+	/*! Lets the group sleep once all its state variables are within tol of their 
+	 * resting values and until it receives spikes. Only supported by groups 
+	 * which implement at_rest(). Default is 0 (disabled).
+	 *
+	 * Unlike the quiescence of input groups this is an approximation which 
+	 * changes the results: the remaining deviations from rest, of up to tol, 
+	 * stop decaying while the group sleeps and are still present when the 
+	 * next input arrives. Exact detection is not possible since the Euler 
+	 * updates of the membrane potential stop short of e_rest in floating 
+	 * point. Only enable it if deviations of the order of tol are negligible 
+	 * for the model. */
+	void set_rest_tolerance(AurynFloat tol);
+
 	void print_mem();
 	void print_ampa();
 	void print_gaba();
@@ -106,6 +164,12 @@ public:
 
 };
 
-
+inline void NeuronGroup::mark_input(NeuronID i)
+{
+	if ( !touched[i] ) {
+		touched[i] = 1;
+		touched_units.push_back(i);
+	}
+}
 
 #endif /*NEURONGROUP_H_*/
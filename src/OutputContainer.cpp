@@ -0,0 +1,432 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OutputContainer.h"
+
+#include <algorithm>
+
+/*! Chunk of an input of OutputContainer::merge */
+struct MergeChunk
+{
+	unsigned int input;
+	unsigned int stream;
+	ContainerChunkEntry entry;
+};
+
+static bool earlier_chunk(const MergeChunk & a, const MergeChunk & b)
+{
+	return a.entry.t_first < b.entry.t_first;
+}
+
+OutputContainer::OutputContainer(string filename, AurynFloat timestep, size_t size, AurynTime span)
+{
+	writer = new AsyncFileWriter(filename);
+	chunk_size = max(size,(size_t)1024);
+	chunk_time = max(span,(AurynTime)1);
+
+	ContainerHeader header;
+	header.magic = OUTPUTCONTAINER_MAGIC;
+	header.version = OUTPUTCONTAINER_VERSION;
+	header.dt = timestep;
+	header.reserved = 0;
+	writer->write(&header,sizeof(header));
+	is_open = true;
+}
+
+OutputContainer::~OutputContainer()
+{
+	close();
+	delete writer;
+}
+
+unsigned int OutputContainer::add_stream(string name, ContainerStreamType type, unsigned int num_values, 
+		const void * data, size_t size)
+{
+	ContainerStreamInfo info;
+	memset(&info,0,sizeof(info));
+	strncpy(info.name,name.c_str(),OUTPUTCONTAINER_NAME_LENGTH-1);
+	info.type = type;
+	info.num_values = num_values;
+	info.metadata_size = size;
+	streams.push_back(info);
+	metadata.push_back(vector<char>((const char*)data,(const char*)data+size));
+
+	ContainerChunkHeader chunk;
+	memset(&chunk,0,sizeof(chunk));
+	chunk.magic = OUTPUTCONTAINER_CHUNK_MAGIC;
+	chunk.stream = streams.size()-1;
+	buffers.push_back(vector<char>());
+	buffers.back().reserve(chunk_size);
+	chunks.push_back(chunk);
+
+	// the stream definition is also written as a chunk to allow recovery without footer
+	ContainerChunkHeader definition = chunk;
+	definition.stream = OUTPUTCONTAINER_STREAM_DEFINITION;
+	definition.num_records = streams.size()-1;
+	definition.payload_size = sizeof(info)+size;
+	writer->write(&definition,sizeof(definition));
+	writer->write(&info,sizeof(info));
+	if ( size > 0 ) 
+		writer->write(data,size);
+
+	stringstream oss;
+	oss << "OutputContainer:: Added stream " << name << " with " << num_values << " values per record";
+	logger->msg(oss.str(),NOTIFICATION);
+
+	return streams.size()-1;
+}
+
+int OutputContainer::find_stream(string name)
+{
+	for ( unsigned int i = 0 ; i < streams.size() ; ++i ) 
+		if ( name == streams[i].name ) return i;
+	return -1;
+}
+
+void OutputContainer::write_chunk(unsigned int stream)
+{
+	vector<char> & buffer = buffers[stream];
+	if ( buffer.empty() ) return;
+	ContainerChunkHeader & chunk = chunks[stream];
+	chunk.payload_size = buffer.size();
+	append_chunk(stream,chunk,&buffer[0]);
+	buffer.clear();
+	chunk.num_records = 0;
+}
+
+void OutputContainer::append_chunk(unsigned int stream, const ContainerChunkHeader & header, const char * payload)
+{
+	if ( !is_open ) return;
+	ContainerChunkEntry entry;
+	entry.stream = stream;
+	entry.num_records = header.num_records;
+	entry.t_first = header.t_first;
+	entry.t_last = header.t_last;
+	entry.offset = writer->tell();
+	index.push_back(entry);
+
+	ContainerChunkHeader chunk = header;
+	chunk.magic = OUTPUTCONTAINER_CHUNK_MAGIC;
+	chunk.stream = stream;
+	writer->write(&chunk,sizeof(chunk));
+	writer->write(payload,chunk.payload_size);
+}
+
+void OutputContainer::flush()
+{
+	if ( !is_open ) return;
+	for ( unsigned int i = 0 ; i < streams.size() ; ++i ) 
+		write_chunk(i);
+	writer->flush();
+}
+
+void OutputContainer::close()
+{
+	if ( !is_open ) return;
+	for ( unsigned int i = 0 ; i < streams.size() ; ++i ) 
+		write_chunk(i);
+
+	ContainerTrailer trailer;
+	trailer.footer_offset = writer->tell();
+	trailer.magic = OUTPUTCONTAINER_MAGIC;
+	trailer.version = OUTPUTCONTAINER_VERSION;
+
+	boost::uint32_t counts [2];
+	counts[0] = streams.size();
+	counts[1] = index.size();
+	writer->write(counts,sizeof(counts));
+	for ( unsigned int i = 0 ; i < streams.size() ; ++i ) {
+		writer->write(&streams[i],sizeof(ContainerStreamInfo));
+		if ( !metadata[i].empty() ) 
+			writer->write(&metadata[i][0],metadata[i].size());
+	}
+	if ( !index.empty() ) 
+		writer->write(&index[0],index.size()*sizeof(ContainerChunkEntry));
+	writer->write(&trailer,sizeof(trailer));
+	writer->close();
+	is_open = false;
+}
+
+boost::uint64_t OutputContainer::merge(string filename, const vector<string> & names)
+{
+	vector<ContainerReader*> inputs;
+	boost::uint64_t records = 0;
+	try {
+		for ( unsigned int k = 0 ; k < names.size() ; ++k ) 
+			inputs.push_back(new ContainerReader(names[k]));
+		if ( inputs.empty() ) return 0;
+
+		OutputContainer output(filename,inputs[0]->get_dt());
+
+		// map the streams of each input to streams of the output
+		vector< vector<unsigned int> > streammap(inputs.size());
+		vector<unsigned int> source_input;
+		vector<unsigned int> source_stream;
+		for ( unsigned int k = 0 ; k < inputs.size() ; ++k ) {
+			if ( inputs[k]->get_dt() != inputs[0]->get_dt() ) {
+				stringstream oss;
+				oss << "OutputContainer:: " << names[k] << " has a different time step";
+				logger->msg(oss.str(),WARNING);
+			}
+			for ( unsigned int s = 0 ; s < inputs[k]->get_num_streams() ; ++s ) {
+				const ContainerStreamInfo & info = inputs[k]->get_stream_info(s);
+				const vector<char> & data = inputs[k]->get_metadata(s);
+				string name = info.name;
+				int match = output.find_stream(name);
+				if ( match >= 0 ) {
+					const ContainerStreamInfo & other = inputs[source_input[match]]->get_stream_info(source_stream[match]);
+					if ( other.type != info.type || other.num_values != info.num_values 
+							|| inputs[source_input[match]]->get_metadata(source_stream[match]) != data ) {
+						stringstream oss;
+						oss << name << "@" << k;
+						name = oss.str();
+						match = output.find_stream(name);
+					}
+				}
+				if ( match < 0 ) {
+					match = output.add_stream(name,(ContainerStreamType)info.type,info.num_values,
+							data.empty()?NULL:&data[0],data.size());
+					source_input.push_back(k);
+					source_stream.push_back(s);
+				}
+				streammap[k].push_back(match);
+			}
+		}
+
+		vector<MergeChunk> chunks;
+		for ( unsigned int k = 0 ; k < inputs.size() ; ++k ) {
+			const vector<ContainerChunkEntry> & index = inputs[k]->get_index();
+			for ( unsigned int c = 0 ; c < index.size() ; ++c ) {
+				if ( index[c].stream >= streammap[k].size() ) continue;
+				MergeChunk chunk;
+				chunk.input = k;
+				chunk.stream = streammap[k][index[c].stream];
+				chunk.entry = index[c];
+				chunks.push_back(chunk);
+			}
+		}
+		stable_sort(chunks.begin(),chunks.end(),earlier_chunk);
+
+		ContainerChunkHeader header;
+		vector<char> payload;
+		for ( unsigned int c = 0 ; c < chunks.size() ; ++c ) {
+			inputs[chunks[c].input]->read_chunk(chunks[c].entry,header,payload);
+			output.append_chunk(chunks[c].stream,header,payload.empty()?NULL:&payload[0]);
+			records += header.num_records;
+		}
+		output.close();
+	} catch ( ... ) {
+		for ( unsigned int k = 0 ; k < inputs.size() ; ++k ) 
+			delete inputs[k];
+		throw;
+	}
+
+	for ( unsigned int k = 0 ; k < inputs.size() ; ++k ) 
+		delete inputs[k];
+	return records;
+}
+
+
+ContainerReader::ContainerReader(string filename)
+{
+	infile.open(filename.c_str(),ios::in|ios::binary);
+	if ( !infile ) {
+		stringstream oss;
+		oss << "ContainerReader:: Can't open " << filename;
+		logger->msg(oss.str(),ERROR);
+		throw AurynOpenFileException();
+	}
+
+	if ( !infile.read((char*)&header,sizeof(header)) 
+			|| header.magic != OUTPUTCONTAINER_MAGIC || header.version != OUTPUTCONTAINER_VERSION ) {
+		stringstream oss;
+		oss << "ContainerReader:: " << filename << " is not a valid container file";
+		logger->msg(oss.str(),ERROR);
+		throw AurynContainerException();
+	}
+
+	if ( !read_footer() ) {
+		stringstream oss;
+		oss << "ContainerReader:: " << filename << " has no footer. Rebuilding index from chunks.";
+		logger->msg(oss.str(),WARNING);
+		scan();
+	}
+}
+
+ContainerReader::~ContainerReader()
+{
+	infile.close();
+}
+
+bool ContainerReader::read_footer()
+{
+	ContainerTrailer trailer;
+	infile.clear();
+	infile.seekg(0,ios::end);
+	const boost::uint64_t size = infile.tellg();
+	if ( size < sizeof(header)+sizeof(trailer) ) return false;
+	infile.seekg(size-sizeof(trailer),ios::beg);
+	if ( !infile.read((char*)&trailer,sizeof(trailer)) 
+			|| trailer.magic != OUTPUTCONTAINER_MAGIC || trailer.footer_offset >= size ) 
+		return false;
+
+	infile.seekg(trailer.footer_offset,ios::beg);
+	boost::uint32_t counts [2];
+	if ( !infile.read((char*)counts,sizeof(counts)) ) return false;
+	streams.resize(counts[0]);
+	metadata.resize(counts[0]);
+	for ( unsigned int i = 0 ; i < counts[0] ; ++i ) {
+		if ( !infile.read((char*)&streams[i],sizeof(ContainerStreamInfo)) ) return false;
+		metadata[i].resize(streams[i].metadata_size);
+		if ( streams[i].metadata_size > 0 && !infile.read(&metadata[i][0],streams[i].metadata_size) ) return false;
+	}
+	index.resize(counts[1]);
+	if ( counts[1] > 0 && !infile.read((char*)&index[0],counts[1]*sizeof(ContainerChunkEntry)) ) return false;
+	return true;
+}
+
+void ContainerReader::scan()
+{
+	streams.clear();
+	metadata.clear();
+	index.clear();
+
+	infile.clear();
+	infile.seekg(0,ios::end);
+	const boost::uint64_t size = infile.tellg();
+	boost::uint64_t offset = sizeof(header);
+	infile.seekg(offset,ios::beg);
+	ContainerChunkHeader chunk;
+	while ( infile.read((char*)&chunk,sizeof(chunk)) && chunk.magic == OUTPUTCONTAINER_CHUNK_MAGIC ) {
+		if ( offset+sizeof(chunk)+chunk.payload_size > size ) break; // truncated chunk
+		if ( chunk.stream == OUTPUTCONTAINER_STREAM_DEFINITION ) {
+			ContainerStreamInfo info;
+			if ( !infile.read((char*)&info,sizeof(info)) ) break;
+			vector<char> data(info.metadata_size);
+			if ( info.metadata_size > 0 && !infile.read(&data[0],info.metadata_size) ) break;
+			streams.push_back(info);
+			metadata.push_back(data);
+		} else {
+			ContainerChunkEntry entry;
+			entry.stream = chunk.stream;
+			entry.num_records = chunk.num_records;
+			entry.t_first = chunk.t_first;
+			entry.t_last = chunk.t_last;
+			entry.offset = offset;
+			infile.seekg(chunk.payload_size,ios::cur);
+			index.push_back(entry);
+		}
+		offset += sizeof(chunk)+chunk.payload_size;
+	}
+	infile.clear();
+}
+
+AurynFloat ContainerReader::get_dt()
+{
+	return header.dt;
+}
+
+unsigned int ContainerReader::get_num_streams()
+{
+	return streams.size();
+}
+
+const ContainerStreamInfo & ContainerReader::get_stream_info(unsigned int stream)
+{
+	return streams[stream];
+}
+
+const vector<char> & ContainerReader::get_metadata(unsigned int stream)
+{
+	return metadata[stream];
+}
+
+int ContainerReader::find_stream(string name)
+{
+	for ( unsigned int i = 0 ; i < streams.size() ; ++i ) 
+		if ( name == streams[i].name ) return i;
+	return -1;
+}
+
+const vector<ContainerChunkEntry> & ContainerReader::get_index()
+{
+	return index;
+}
+
+void ContainerReader::read_chunk(const ContainerChunkEntry & entry, ContainerChunkHeader & chunk, vector<char> & payload)
+{
+	infile.clear();
+	infile.seekg(entry.offset,ios::beg);
+	if ( !infile.read((char*)&chunk,sizeof(chunk)) || chunk.magic != OUTPUTCONTAINER_CHUNK_MAGIC ) 
+		throw AurynContainerException();
+	payload.resize(chunk.payload_size);
+	if ( chunk.payload_size > 0 && !infile.read(&payload[0],chunk.payload_size) ) 
+		throw AurynContainerException();
+}
+
+static bool earlier_record(const pair<AurynTime,boost::uint64_t> & a, const pair<AurynTime,boost::uint64_t> & b)
+{
+	return a.first < b.first;
+}
+
+boost::uint64_t ContainerReader::read(unsigned int stream, AurynTime from, AurynTime to, 
+		vector<AurynTime> & times, vector<boost::uint32_t> & values)
+{
+	times.clear();
+	values.clear();
+	if ( stream >= streams.size() ) return 0;
+	const unsigned int num_values = streams[stream].num_values;
+	const size_t record_size = sizeof(AurynTime)+4*num_values;
+
+	ContainerChunkHeader chunk;
+	vector<char> payload;
+	bool sorted = true;
+	for ( unsigned int c = 0 ; c < index.size() ; ++c ) {
+		const ContainerChunkEntry & entry = index[c];
+		if ( entry.stream != stream || entry.t_last < from || entry.t_first > to ) continue;
+		read_chunk(entry,chunk,payload);
+		for ( size_t pos = 0 ; pos+record_size <= payload.size() ; pos += record_size ) {
+			AurynTime t;
+			memcpy(&t,&payload[pos],sizeof(AurynTime));
+			if ( t < from || t > to ) continue;
+			if ( !times.empty() && t < times.back() ) sorted = false;
+			times.push_back(t);
+			if ( num_values == 0 ) continue;
+			const size_t k = values.size();
+			values.resize(k+num_values);
+			memcpy(&values[k],&payload[pos+sizeof(AurynTime)],4*num_values);
+		}
+	}
+
+	if ( !sorted ) { // chunks of merged containers overlap in time
+		vector< pair<AurynTime,boost::uint64_t> > order;
+		for ( boost::uint64_t k = 0 ; k < times.size() ; ++k ) 
+			order.push_back(make_pair(times[k],k));
+		stable_sort(order.begin(),order.end(),earlier_record);
+		vector<boost::uint32_t> sorted_values(values.size());
+		for ( boost::uint64_t k = 0 ; k < order.size() ; ++k ) {
+			times[k] = order[k].first;
+			if ( num_values > 0 ) 
+				memcpy(&sorted_values[k*num_values],&values[order[k].second*num_values],4*num_values);
+		}
+		values.swap(sorted_values);
+	}
+	return times.size();
+}
@@ -0,0 +1,221 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OUTPUTCONTAINER_H_
+#define OUTPUTCONTAINER_H_
+
+#include "auryn_definitions.h"
+#include "AsyncFileWriter.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#define OUTPUTCONTAINER_MAGIC 0x46435541 //!< "AUCF" in little endian
+#define OUTPUTCONTAINER_VERSION 1
+#define OUTPUTCONTAINER_CHUNK_MAGIC 0x4b4e4843 //!< "CHNK" in little endian
+/*! Stream number of chunks which define a stream */
+#define OUTPUTCONTAINER_STREAM_DEFINITION 0xffffffff
+#define OUTPUTCONTAINER_NAME_LENGTH 64
+#define OUTPUTCONTAINER_CHUNK_SIZE 262144 //!< Default maximum payload of a chunk in bytes
+#define OUTPUTCONTAINER_CHUNK_TIME 100000 //!< Default maximum time span of a chunk in time steps
+
+using namespace std;
+
+/*! \brief Kind of data in a stream of an OutputContainer */
+enum ContainerStreamType { CONTAINER_SPIKES, CONTAINER_STATES, CONTAINER_RATES, CONTAINER_WEIGHTS, CONTAINER_OTHER };
+
+/*! \brief Header at the beginning of a container file */
+struct ContainerHeader
+{
+	boost::uint32_t magic;
+	boost::uint32_t version;
+	/*! Length of a time step in seconds */
+	AurynFloat dt;
+	boost::uint32_t reserved;
+};
+
+/*! \brief Header in front of every chunk */
+struct ContainerChunkHeader
+{
+	boost::uint32_t magic;
+	/*! Stream number or OUTPUTCONTAINER_STREAM_DEFINITION */
+	boost::uint32_t stream;
+	/*! Number of records or the number of the defined stream */
+	boost::uint32_t num_records;
+	/*! Size of the payload following the header in bytes */
+	boost::uint32_t payload_size;
+	AurynTime t_first;
+	AurynTime t_last;
+};
+
+/*! \brief Description of a stream, followed by metadata_size bytes of metadata */
+struct ContainerStreamInfo
+{
+	char name [OUTPUTCONTAINER_NAME_LENGTH];
+	boost::uint32_t type;
+	/*! Number of 32 bit values per record */
+	boost::uint32_t num_values;
+	boost::uint32_t metadata_size;
+	boost::uint32_t reserved;
+};
+
+/*! \brief Entry of the chunk index in the footer */
+struct ContainerChunkEntry
+{
+	boost::uint32_t stream;
+	boost::uint32_t num_records;
+	AurynTime t_first;
+	AurynTime t_last;
+	/*! Byte offset of the chunk header */
+	boost::uint64_t offset;
+};
+
+/*! \brief Last bytes of a container file which point to the footer */
+struct ContainerTrailer
+{
+	boost::uint64_t footer_offset;
+	boost::uint32_t magic;
+	boost::uint32_t version;
+};
+
+/*! \brief Chunked, time-indexed binary file for simulation output
+ *
+ * A container holds named streams, e.g. the spikes of a group, the states 
+ * of a set of neurons, a population rate or weight statistics. Each record 
+ * of a stream is a time step (AurynTime) followed by num_values 32 bit 
+ * values (NeuronID or AurynState). Records are collected per stream in 
+ * chunks of at most chunk_size bytes and chunk_time time steps, which are 
+ * written with a ContainerChunkHeader holding the time range of the chunk.
+ *
+ * File layout: a ContainerHeader, then chunks in the order they were 
+ * completed. A stream is defined by a chunk with stream number 
+ * OUTPUTCONTAINER_STREAM_DEFINITION whose payload is the ContainerStreamInfo
+ * and its metadata. On close a footer is appended with the number of streams
+ * and chunks (two 32 bit values), all stream definitions and the 
+ * ContainerChunkEntry index of all data chunks, followed by a 
+ * ContainerTrailer. ContainerReader uses the index to read only the chunks 
+ * of a time window; if the footer is missing because the simulation did not
+ * finish, it rebuilds the index from the chunk headers.
+ *
+ * Each rank writes its own container; the aucmerge tool combines them. 
+ * BinarySpikeMonitor, StateRecorder, PopulationRateMonitor and 
+ * WeightSumMonitor can write to a container. The container has to be 
+ * deleted after the monitors, e.g. after System.
+ */
+class OutputContainer
+{
+private:
+	AsyncFileWriter * writer;
+	AurynTime chunk_time;
+	size_t chunk_size;
+	vector<ContainerStreamInfo> streams;
+	vector< vector<char> > metadata;
+	/*! Records of the current chunk of each stream */
+	vector< vector<char> > buffers;
+	/*! Header of the current chunk of each stream */
+	vector<ContainerChunkHeader> chunks;
+	vector<ContainerChunkEntry> index;
+	bool is_open;
+
+	void write_chunk(unsigned int stream);
+
+public:
+	/*! Creates the container filename. Throws AurynOpenFileException. */
+	OutputContainer(string filename, AurynFloat timestep=dt, 
+			size_t chunk_size=OUTPUTCONTAINER_CHUNK_SIZE, AurynTime chunk_time=OUTPUTCONTAINER_CHUNK_TIME);
+	/*! Closes the container */
+	virtual ~OutputContainer();
+
+	/*! Defines a stream and returns its number */
+	unsigned int add_stream(string name, ContainerStreamType type, unsigned int num_values, 
+			const void * metadata=NULL, size_t metadata_size=0);
+	/*! Returns the number of the stream name or -1 */
+	int find_stream(string name);
+	/*! Appends a record of num_values 32 bit values to a stream. Times have to be non-decreasing within a stream. */
+	void append(unsigned int stream, AurynTime time, const void * values) {
+		vector<char> & buffer = buffers[stream];
+		const size_t size = sizeof(AurynTime)+4*streams[stream].num_values;
+		if ( !buffer.empty() && ( buffer.size()+size > chunk_size || time-chunks[stream].t_first >= chunk_time ) ) 
+			write_chunk(stream);
+		if ( buffer.empty() ) chunks[stream].t_first = time;
+		chunks[stream].t_last = time;
+		chunks[stream].num_records++;
+		const size_t pos = buffer.size();
+		buffer.resize(pos+size);
+		memcpy(&buffer[pos],&time,sizeof(AurynTime));
+		memcpy(&buffer[pos+sizeof(AurynTime)],values,size-sizeof(AurynTime));
+	}
+	/*! Copies a complete chunk, e.g. from another container */
+	void append_chunk(unsigned int stream, const ContainerChunkHeader & header, const char * payload);
+	/*! Writes the current chunks of all streams and waits until they are on disk */
+	void flush();
+	/*! Writes the footer and closes the file */
+	void close();
+
+	/*! Merges the containers inputs into the new container filename. 
+	 * Streams with the same name, type, size and metadata are combined, 
+	 * other streams which share a name are renamed to name@k, where k is 
+	 * the number of the input. Chunks are copied unchanged in the order of 
+	 * their first time step. Returns the number of records. Throws 
+	 * AurynOpenFileException or AurynContainerException. */
+	static boost::uint64_t merge(string filename, const vector<string> & inputs);
+};
+
+/*! \brief Reads streams of an OutputContainer file */
+class ContainerReader
+{
+private:
+	ifstream infile;
+	ContainerHeader header;
+	vector<ContainerStreamInfo> streams;
+	vector< vector<char> > metadata;
+	vector<ContainerChunkEntry> index;
+
+	bool read_footer();
+	void scan();
+
+public:
+	/*! Opens filename. Throws AurynOpenFileException or AurynContainerException. */
+	ContainerReader(string filename);
+	virtual ~ContainerReader();
+
+	/*! Returns the time step of the container in seconds */
+	AurynFloat get_dt();
+	unsigned int get_num_streams();
+	const ContainerStreamInfo & get_stream_info(unsigned int stream);
+	const vector<char> & get_metadata(unsigned int stream);
+	/*! Returns the number of the stream name or -1 */
+	int find_stream(string name);
+	/*! Returns the index of all data chunks */
+	const vector<ContainerChunkEntry> & get_index();
+	/*! Reads header and payload of a chunk */
+	void read_chunk(const ContainerChunkEntry & entry, ContainerChunkHeader & header, vector<char> & payload);
+	/*! Reads the records of stream with from <= time <= to, sorted by time. 
+	 * The values of record k are values[k*num_values] to values[(k+1)*num_values-1]. 
+	 * Only chunks overlapping the time window are read. Returns the number of records. */
+	boost::uint64_t read(unsigned int stream, AurynTime from, AurynTime to, 
+			vector<AurynTime> & times, vector<boost::uint32_t> & values);
+};
+
+extern Logger * logger;
+
+#endif /*OUTPUTCONTAINER_H_*/
@@ -0,0 +1,189 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ParameterSweep.h"
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <cstdio>
+
+static double sweep_wall_clock()
+{
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return tv.tv_sec+1e-6*tv.tv_usec;
+}
+
+ParameterSweep::ParameterSweep( SweepSetupFunction setup_function, void * data )
+{
+	setup = setup_function;
+	setup_data = data;
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	max_children = cpus > 0 ? cpus : 1;
+}
+
+ParameterSweep::~ParameterSweep()
+{
+}
+
+void ParameterSweep::add_point( string prefix, AurynFloat simtime )
+{
+	prefixes.push_back(prefix);
+	run_times.push_back(simtime);
+}
+
+unsigned int ParameterSweep::get_num_points()
+{
+	return prefixes.size();
+}
+
+void ParameterSweep::set_max_children( unsigned int n )
+{
+	max_children = max(n,1u);
+}
+
+void ParameterSweep::run_child( unsigned int i )
+{
+	// anything still buffered would be written by the parent and every child
+	sys->flush_monitors();
+	cout.flush();
+	cerr.flush();
+	fflush(NULL);
+
+	pid_t pid = fork();
+	if ( pid < 0 ) {
+		stringstream oss;
+		oss << "ParameterSweep:: Fork failed for point " << i;
+		logger->msg(oss.str(),ERROR);
+		results[i].status = -1;
+		return;
+	}
+
+	if ( pid > 0 ) { // parent 
+		results[i].pid = pid;
+		return;
+	}
+
+	// child 
+	int status = 0;
+	try {
+		logger = new Logger(prefixes[i]+".log",0,WARNING,NOTIFICATION);
+		stringstream oss;
+		oss << "ParameterSweep:: Running point " << i << " for " << run_times[i] << "s";
+		logger->msg(oss.str(),NOTIFICATION);
+
+		sys->set_quiet(true);
+		if ( setup != NULL ) 
+			setup(i,prefixes[i],setup_data);
+		if ( !sys->run(run_times[i]) ) 
+			status = 1;
+		sys->flush_monitors();
+		delete logger;
+	} catch ( exception& e ) {
+		cerr << "ParameterSweep:: Point " << i << " failed: " << e.what() << endl;
+		status = 2;
+	} catch ( ... ) {
+		status = 2;
+	}
+	cout.flush();
+	cerr.flush();
+	// skip destructors and MPI finalization which belong to the parent
+	_exit(status);
+}
+
+bool ParameterSweep::run()
+{
+	if ( sys->get_com()->size() > 1 ) {
+		logger->msg("ParameterSweep:: Forking is only supported on a single rank.",ERROR);
+		return false;
+	}
+
+	results.clear();
+	results.resize(prefixes.size());
+	vector<double> start_times(prefixes.size(),0.0);
+
+	stringstream oss;
+	oss << "ParameterSweep:: Running " << prefixes.size() << " points in up to " 
+		<< max_children << " child processes";
+	logger->msg(oss.str(),NOTIFICATION);
+
+	unsigned int next = 0;
+	unsigned int running = 0;
+	while ( next < prefixes.size() || running > 0 ) {
+		while ( next < prefixes.size() && running < max_children ) {
+			results[next].prefix = prefixes[next];
+			results[next].pid = 0;
+			results[next].status = -1;
+			results[next].wall_time = 0.0;
+			start_times[next] = sweep_wall_clock();
+			run_child(next);
+			if ( results[next].pid > 0 ) running++;
+			next++;
+		}
+		if ( running == 0 ) break;
+
+		int wstatus;
+		pid_t pid = waitpid(-1,&wstatus,0);
+		if ( pid < 0 ) break;
+		for ( unsigned int i = 0 ; i < next ; ++i ) {
+			if ( results[i].pid != pid ) continue;
+			results[i].wall_time = sweep_wall_clock()-start_times[i];
+			if ( WIFEXITED(wstatus) ) 
+				results[i].status = WEXITSTATUS(wstatus);
+			else 
+				results[i].status = -1;
+
+			oss.str("");
+			oss << "ParameterSweep:: Point " << i << " (" << results[i].prefix 
+				<< ") finished with status " << results[i].status 
+				<< " after " << results[i].wall_time << "s";
+			logger->msg(oss.str(),results[i].status==0?NOTIFICATION:WARNING);
+			running--;
+			break;
+		}
+	}
+
+	bool success = true;
+	for ( unsigned int i = 0 ; i < results.size() ; ++i ) 
+		success = success && results[i].status == 0;
+	return success;
+}
+
+vector<SweepResult> ParameterSweep::get_results()
+{
+	return results;
+}
+
+void ParameterSweep::write_results( string filename )
+{
+	ofstream outfile(filename.c_str(),ios::out);
+	if (!outfile) {
+		stringstream oss;
+		oss << "ParameterSweep:: Can't open output file " << filename;
+		logger->msg(oss.str(),ERROR);
+		throw AurynOpenFileException();
+	}
+	outfile << "# point status wall_time prefix" << endl;
+	for ( unsigned int i = 0 ; i < results.size() ; ++i ) 
+		outfile << i << " " << results[i].status << " " 
+			<< results[i].wall_time << " " << results[i].prefix << endl;
+	outfile.close();
+}
@@ -0,0 +1,111 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PARAMETERSWEEP_H_
+#define PARAMETERSWEEP_H_
+
+#include "auryn_definitions.h"
+#include "System.h"
+
+#include <vector>
+#include <string>
+#include <sys/types.h>
+
+using namespace std;
+
+/*! Function which applies the parameters of a sweep point in a child process.
+ * Receives the index of the point, its output prefix and the user data 
+ * pointer given to ParameterSweep. */
+typedef void (*SweepSetupFunction)( unsigned int point, string prefix, void * data );
+
+/*! \brief Result of a single sweep point as seen from the parent process */
+struct SweepResult
+{
+	/*! Output prefix of the point */
+	string prefix;
+	/*! Process ID of the child */
+	pid_t pid;
+	/*! Exit status of the child. 0 if the run completed, 1 if a checker broke
+	 * the run, 2 if an exception was thrown and -1 if it was killed by a signal */
+	int status;
+	/*! Wall clock time from fork to exit in seconds */
+	double wall_time;
+};
+
+/*! \brief Runs several variants of a network in child processes which share the constructed network copy-on-write
+ *
+ * Build the network once, optionally warm it up with System::run, add the sweep 
+ * points and call run(). For each point a child process is forked which shares all
+ * memory of the parent copy-on-write, i.e. weight matrices which are not plastic 
+ * are never copied. In the child the setup function applies the parameter 
+ * overrides of the point and creates the monitors writing to the output prefix. 
+ * The child then simulates for the run time of the point, flushes its monitors and 
+ * exits. Children log to prefix.log. The parent waits for all children and 
+ * collects their exit status and timing.
+ *
+ * Monitors created before the sweep keep running in all children and write to the
+ * same files. Set their active flag to false in the setup function if this is not
+ * wanted.
+ *
+ * Input groups which prefetch their spikes in a producer thread (see 
+ * SpikePrefetcher) continue in each child from the state at the fork, so all
+ * points see the same input.
+ *
+ * Forking requires a simulation on a single rank.
+ */
+class ParameterSweep
+{
+private:
+	SweepSetupFunction setup;
+	void * setup_data;
+	vector<string> prefixes;
+	vector<AurynFloat> run_times;
+	vector<SweepResult> results;
+	/*! Maximum number of children which run at the same time */
+	unsigned int max_children;
+
+	/*! Sets up and runs point i. Only returns in the parent process. */
+	void run_child( unsigned int i );
+
+public:
+	/*! Creates a sweep which calls setup with data in each child */
+	ParameterSweep( SweepSetupFunction setup, void * data = NULL );
+	virtual ~ParameterSweep();
+
+	/*! Adds a sweep point which runs for simtime seconds and writes output files starting with prefix */
+	void add_point( string prefix, AurynFloat simtime );
+
+	/*! Returns the number of sweep points */
+	unsigned int get_num_points();
+
+	/*! Sets the maximum number of children running concurrently (default is the number of online CPUs) */
+	void set_max_children( unsigned int n );
+
+	/*! Forks the children, waits for all of them and returns true if all of them completed their run */
+	bool run();
+
+	/*! Returns the results of the last run() */
+	vector<SweepResult> get_results();
+
+	/*! Writes prefix, status and wall time of each point to a text file */
+	void write_results( string filename );
+};
+
+#endif /*PARAMETERSWEEP_H_*/
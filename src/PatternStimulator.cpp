@@ -52,7 +52,7 @@ void PatternStimulator::init(NeuronGroup * target, string filename, AurynFloat s
 
 	patterns = new vector<type_pattern>;
 
-	mem = dst->get_mem_ptr();
+	mem = dst->get_input_vector(MEM);
 
 	filetime = 0;
 	timeseriesfile.open(filename.c_str(),ios::in);
@@ -89,14 +89,27 @@ void PatternStimulator::propagate()
 			}
 		}
 
+		bool active = false;
 		AurynState * cur_iter = currents;
 		for ( vector<type_pattern>::const_iterator pattern = patterns->begin() ; 
 				pattern != patterns->end() ; ++pattern ) { 
+			if ( *cur_iter != 0 ) active = true;
 			for ( type_pattern::const_iterator piter = pattern->begin() ; piter != pattern->end() ; ++piter ) {
 				mem->data[piter->i] += *cur_iter * piter->gamma * scl * dt;
 			}
 			++cur_iter;
 		}
+		// mem is written directly, a sleeping group would not integrate it
+		if ( active ) dst->wake();
+		if ( active && dst->tracks_input() ) {
+			cur_iter = currents;
+			for ( vector<type_pattern>::const_iterator pattern = patterns->begin() ; 
+					pattern != patterns->end() ; ++pattern ) { 
+				if ( *cur_iter++ == 0 ) continue;
+				for ( type_pattern::const_iterator piter = pattern->begin() ; piter != pattern->end() ; ++piter ) 
+					dst->mark_input(piter->i);
+			}
+		}
 	}
 }
 
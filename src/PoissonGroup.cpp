@@ -20,23 +20,27 @@
 
 #include "PoissonGroup.h"
 
-boost::mt19937 PoissonGroup::gen = boost::mt19937(); 
+unsigned int PoissonGroup::num_instances = 0;
 
 void PoissonGroup::init(AurynDouble  rate)
 {
+	prefetching = false;
 	sys->register_spiking_group(this);
 	if ( evolve_locally() ) {
 		lambda = rate;
 
 		dist = new boost::uniform_01<> ();
 		die  = new boost::variate_generator<boost::mt19937&, boost::uniform_01<> > ( gen, *dist );
-		seed(communicator->rank()); // seeding problem
+		// independent streams such that later instances don't restart earlier ones
+		const int s = communicator->rank()+1000003*num_instances;
+		seed(s);
 		x = 0;
 
 		stringstream oss;
-		oss << "PoissonGroup:: Seeding with " << communicator->rank();
+		oss << "PoissonGroup:: Seeding with " << s;
 		logger->msg(oss.str(),NOTIFICATION);
 	}
+	++num_instances;
 }
 
 PoissonGroup::PoissonGroup(NeuronID n, AurynDouble  rate ) : SpikingGroup( n , POISSON_LOAD_MULTIPLIER*rate ) 
@@ -52,15 +56,25 @@ PoissonGroup::~PoissonGroup()
 	}
 }
 
-void PoissonGroup::set_rate(AurynDouble  rate)
+void PoissonGroup::change_rate(AurynDouble  rate)
 {
 	lambda = rate;
-    if (evolve_locally() ) {
+    if (evolve_locally() && lambda > 0 ) {
       AurynDouble r = -log((*die)()+1e-20)/lambda;
       x = (NeuronID)(r/dt); 
     }
 }
 
+void PoissonGroup::set_rate(AurynDouble  rate)
+{
+	if ( prefetching ) { // the producer thread owns lambda and x
+		logger->msg("PoissonGroup:: Can't change the rate while prefetching.",ERROR);
+		throw AurynPrefetcherException();
+	}
+	change_rate(rate);
+	wake();
+}
+
 AurynDouble  PoissonGroup::get_rate()
 {
 	return lambda;
@@ -68,9 +82,28 @@ AurynDouble  PoissonGroup::get_rate()
 
 
 void PoissonGroup::evolve()
+{
+	const bool plain = can_skip_steps();
+
+	if ( lambda <= 0 ) {
+		if ( plain ) sleep();
+		return;
+	}
+
+	draw_spikes(spikes);
+
+	// skip the time steps without spikes 
+	const NeuronID silent_steps = x/get_rank_size();
+	if ( plain && silent_steps > 0 ) {
+		x -= silent_steps*get_rank_size();
+		sleep_until( sys->get_clock()+1+silent_steps );
+	}
+}
+
+void PoissonGroup::draw_spikes(SpikeContainer * out)
 {
 	while ( x < get_rank_size() ) {
-		push_spike ( x );
+		out->push_back( rank2global(x) );
 		AurynDouble r = -log((*die)()+1e-20)/lambda;
 		x += 1+(NeuronID)(r/dt); 
 		// beware one induces systematic error that becomes substantial at high rates, but keeps neuron from spiking twice per time-step
@@ -78,8 +111,17 @@ void PoissonGroup::evolve()
 	x -= get_rank_size();
 }
 
+bool PoissonGroup::can_skip_steps()
+{
+	return true;
+}
+
 void PoissonGroup::seed(int s)
 {
-		gen.seed(s); 
+	if ( prefetching ) { // the producer thread draws from gen
+		logger->msg("PoissonGroup:: Can't seed while prefetching.",ERROR);
+		throw AurynPrefetcherException();
+	}
+	gen.seed(s); 
 }
 
@@ -30,6 +30,7 @@
 #include <boost/random/variate_generator.hpp>
 #include <boost/random/exponential_distribution.hpp>
 
+
 #define POISSON_LOAD_MULTIPLIER 0.01
 
 using namespace std;
@@ -40,17 +41,17 @@ using namespace std;
  * group of given size of Poisson neurons all firing at the same rate. 
  * The implementation is very efficient if the rate is constant throughout.
  *
- * The random number generator will be seeded identically every time. Use 
- * the seed function to seed it randomly if needed. Note that all PoissonGroups
- * in a simulation share the same random number generator. Therefore it 
- * sufficed to seed one of them.
+ * Each PoissonGroup has its own random number generator, which is seeded 
+ * identically every time from the rank and the number of PoissonGroups 
+ * created before. Use the seed function to seed it randomly if needed. 
  */
 class PoissonGroup : public SpikingGroup
 {
 private:
 	AurynTime * clk;
 	AurynDouble lambda;
-	static boost::mt19937 gen; 
+	/*! Random number generator of this instance */
+	boost::mt19937 gen; 
 	boost::uniform_01<> * dist;
 	boost::variate_generator<boost::mt19937&, boost::uniform_01<> > * die;
 
@@ -58,6 +59,24 @@ private:
 
 protected:
 	NeuronID x;
+
+	/*! Number of PoissonGroups created so far, used to give each instance its own seed */
+	static unsigned int num_instances;
+	/*! Set while a subclass generates the spikes in a producer thread. The
+	 * rate and the generator must not be changed from outside then. */
+	bool prefetching;
+
+	/*! Sets the rate without waking the group, which is also safe on a producer thread */
+	void change_rate(AurynDouble rate);
+	/*! Appends the spikes of the current time step to out and leaves the 
+	 * position of the next spike in x */
+	void draw_spikes(SpikeContainer * out);
+
+	/*! Returns true if the rate only changes through set_rate such that 
+	 * evolve() can let the group sleep through time steps without spikes. 
+	 * Subclasses which change the rate or add spikes in their evolve() 
+	 * have to return false. */
+	virtual bool can_skip_steps();
 	
 public:
 	/*! Standard constructor. 
@@ -73,11 +92,13 @@ public:
 	 * the firing rate during the simulation. Note that changes might have a short
 	 * latency due to the internal workings of the simulator. Try avoid setting 
 	 * the firing rate in every other timestep because it will reduce performance.
+	 * Throws AurynPrefetcherException while the spikes are prefetched.
 	 */
 	void set_rate(AurynDouble rate);
 	/*! Standard getter for the firing rate variable. */
 	AurynDouble get_rate();
-	/*! Use this to seed the random number generator. */
+	/*! Use this to seed the random number generator of this group. Throws 
+	 * AurynPrefetcherException while the spikes are prefetched. */
 	void seed(int s);
 };
 
@@ -0,0 +1,237 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PoissonStimulator.h"
+
+unsigned int PoissonStimulator::num_instances = 0;
+
+PoissonStimulator::PoissonStimulator(NeuronGroup * target, NeuronID n_inputs, AurynFloat rate, AurynWeight weight, TransmitterType transmitter, StimulatorMode mode) : Monitor( )
+{
+	init(target,n_inputs,rate,weight,transmitter,mode);
+}
+
+PoissonStimulator::~PoissonStimulator()
+{
+	free();
+}
+
+void PoissonStimulator::init(NeuronGroup * target_group, NeuronID n_inputs, AurynFloat r, AurynWeight w, TransmitterType transmitter, StimulatorMode m)
+{
+	sys->register_monitor(this);
+
+	dst = target_group;
+	inputs = n_inputs;
+	rate = r;
+	weight = w;
+	mode = m;
+
+	target = dst->get_input_vector(transmitter);
+	nonnegative = ( transmitter != MEM );
+
+	compute_normal_table();
+	// independent streams such that later instances don't restart earlier ones
+	seed(61093+communicator->rank()+1000003*num_instances);
+	++num_instances;
+
+	noise = NULL;
+	if ( dst->evolve_locally() ) {
+		// same size as the target for the SIMD kernels, the padding of noise 
+		// stays zero such that the padding of the target is left unchanged
+		noise = auryn_vector_float_alloc(target->size);
+		gsl_vector_float_set_zero(noise);
+	}
+
+	compute_distribution();
+
+	stringstream oss;
+	oss << "PoissonStimulator:: Stimulating " << dst->get_rank_size() << " neurons with " 
+		<< inputs << " inputs at " << rate << "Hz (w=" << weight << ")";
+	logger->msg(oss.str(),NOTIFICATION);
+}
+
+void PoissonStimulator::free()
+{
+	if ( noise != NULL ) 
+		gsl_vector_float_free(noise);
+}
+
+void PoissonStimulator::compute_distribution()
+{
+	cdf.clear();
+	guide.clear();
+	log_p0 = 0.0;
+	x = 0;
+	AurynDouble p = rate*dt;
+	if ( inputs == 0 || p <= 0.0 ) {
+		cdf.push_back(1.0);
+		return;
+	}
+	if ( p >= 1.0 ) {
+		logger->msg("PoissonStimulator:: Rate exceeds one spike per time step.",WARNING);
+		p = 0.999;
+	}
+
+	// binomial pmf by recursion, truncated where the remaining mass is negligible
+	AurynDouble pmf = pow(1.0-p,(AurynDouble)inputs);
+	AurynDouble sum = pmf;
+	cdf.push_back(sum);
+	for ( NeuronID k = 0 ; k < inputs && 1.0-sum > 1e-12 ; ++k ) {
+		pmf *= (AurynDouble)(inputs-k)/(k+1)*p/(1.0-p);
+		sum += pmf;
+		cdf.push_back(sum);
+	}
+	cdf.back() = 1.0;
+
+	// guide table to start the inversion close to the sampled count
+	const NeuronID size = 4*cdf.size();
+	NeuronID k = 0;
+	for ( NeuronID j = 0 ; j < size ; ++j ) {
+		while ( cdf[k] <= (AurynDouble)j/size ) ++k;
+		guide.push_back(k);
+	}
+
+	log_p0 = log(cdf[0]);
+	x = skip();
+}
+
+void PoissonStimulator::compute_normal_table()
+{
+	// quantiles of the standard normal distribution at the bin centers found 
+	// by bisection on erfc and rescaled to unit variance
+	const NeuronID size = 1<<POISSONSTIMULATOR_NORMAL_TABLE_BITS;
+	normal_table.resize(size);
+	AurynDouble var = 0.0;
+	for ( NeuronID j = 0 ; j < size ; ++j ) {
+		const AurynDouble q = (j+0.5)/size;
+		AurynDouble lo = -10.0;
+		AurynDouble hi = 10.0;
+		for ( int it = 0 ; it < 60 ; ++it ) {
+			const AurynDouble mid = 0.5*(lo+hi);
+			if ( 0.5*erfc(-mid/sqrt(2.0)) < q ) lo = mid;
+			else hi = mid;
+		}
+		normal_table[j] = 0.5*(lo+hi);
+		var += normal_table[j]*normal_table[j];
+	}
+	const AurynDouble scale = 1.0/sqrt(var/size);
+	for ( NeuronID j = 0 ; j < size ; ++j ) 
+		normal_table[j] *= scale;
+}
+
+AurynDouble PoissonStimulator::uniform()
+{
+	return gen()*(1.0/4294967296.0);
+}
+
+NeuronID PoissonStimulator::sample(AurynDouble u)
+{
+	NeuronID k = guide[(NeuronID)(u*guide.size())];
+	while ( u >= cdf[k] ) ++k;
+	return k;
+}
+
+NeuronID PoissonStimulator::skip()
+{
+	if ( log_p0 == 0.0 ) return 0;
+	const AurynDouble r = log(uniform()+1e-20)/log_p0;
+	if ( r > 1e9 ) return 1000000000;
+	return (NeuronID) r;
+}
+
+void PoissonStimulator::propagate()
+{
+	if ( !dst->evolve_locally() ) return;
+	if ( cdf.size() < 2 ) return; // no input
+	
+	const NeuronID n = dst->get_rank_size();
+	const bool track = dst->tracks_input();
+	if ( mode == STIMULATOR_DIFFUSION ) {
+		const AurynFloat mean = inputs*rate*dt;
+		const AurynFloat sigma = sqrt(mean);
+		// two table lookups per 32 bit random number
+		for ( NeuronID i = 0 ; i < n ; i += 2 ) {
+			const boost::uint32_t r = gen();
+			noise->data[i] = mean + sigma*normal_table[r>>(32-POISSONSTIMULATOR_NORMAL_TABLE_BITS)];
+			if ( i+1 < n ) 
+				noise->data[i+1] = mean + sigma*normal_table[r&((1<<POISSONSTIMULATOR_NORMAL_TABLE_BITS)-1)];
+		}
+		auryn_vector_float_saxpy(weight,noise,target);
+		// the Gaussian counts can be negative
+		if ( nonnegative ) {
+			float * t = target->data;
+			for ( NeuronID i = 0 ; i < n ; ++i ) 
+				if ( t[i] < 0 ) t[i] = 0;
+		}
+		if ( track ) mark_all_targets();
+	} else if ( cdf[0] > 0.5 ) { 
+		// most neurons receive no input in a given step: jump from one neuron 
+		// receiving input to the next one with geometrically distributed gaps 
+		// spanning time steps and sample the count given that it is at least one
+		const AurynDouble p0 = cdf[0];
+		while ( x < n ) {
+			target->data[x] += sample(p0+(1.0-p0)*uniform())*weight;
+			if ( track ) dst->mark_input(x);
+			x += 1+skip();
+		}
+		x -= n;
+	} else {
+		for ( NeuronID i = 0 ; i < n ; ++i ) 
+			target->data[i] += sample(uniform())*weight;
+		if ( track ) mark_all_targets();
+	}
+	dst->wake();
+}
+
+void PoissonStimulator::mark_all_targets()
+{
+	for ( NeuronID i = 0 ; i < dst->get_rank_size() ; ++i ) 
+		dst->mark_input(i);
+}
+
+void PoissonStimulator::set_rate(AurynFloat r)
+{
+	rate = r;
+	compute_distribution();
+}
+
+AurynFloat PoissonStimulator::get_rate()
+{
+	return rate;
+}
+
+void PoissonStimulator::set_weight(AurynWeight w)
+{
+	weight = w;
+}
+
+AurynWeight PoissonStimulator::get_weight()
+{
+	return weight;
+}
+
+void PoissonStimulator::set_mode(StimulatorMode m)
+{
+	mode = m;
+}
+
+void PoissonStimulator::seed(int s)
+{
+	gen.seed(s);
+}
@@ -0,0 +1,157 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POISSONSTIMULATOR_H_
+#define POISSONSTIMULATOR_H_
+
+#include "auryn_definitions.h"
+#include "System.h"
+#include "Monitor.h"
+#include "NeuronGroup.h"
+
+#include <boost/random/mersenne_twister.hpp>
+
+#define POISSONSTIMULATOR_NORMAL_TABLE_BITS 12
+
+using namespace std;
+
+/*! Determines how PoissonStimulator samples the input per time step */
+enum StimulatorMode { 
+	/*! Exact binomial spike counts as produced by a PoissonGroup */
+	STIMULATOR_POISSON, 
+	/*! Gaussian approximation of the counts which turns the conductance into an Ornstein-Uhlenbeck process */
+	STIMULATOR_DIFFUSION 
+};
+
+/*! \brief Stimulator class to inject background Poisson input directly into the conductances of a NeuronGroup
+ *
+ * Replaces the common combination of a large PoissonGroup and a 
+ * SparseConnection which only delivers external background input. Each 
+ * target neuron receives input from n_inputs independent presynaptic Poisson 
+ * neurons firing at a given rate with a fixed weight. Instead of simulating 
+ * the input neurons the stimulator samples the number of input spikes per 
+ * target and time step directly from the binomial distribution 
+ * Binom(n_inputs, rate*dt) and adds count*weight to the target variable. 
+ * At low input rates neurons which receive no input are skipped with 
+ * geometrically distributed jumps such that random numbers are only drawn for
+ * neurons receiving input. The sampling costs a few random numbers per target
+ * neuron and time step. When the expected number of input spikes per neuron 
+ * and time step is well below one, the explicit PoissonGroup can remain 
+ * faster because each of its spikes is shared by many targets, but the 
+ * stimulator still saves the memory of the matrix and the spike exchange.
+ * This saves the random numbers, spike buffers, sync traffic and matrix of 
+ * the explicit inputs. For a random connection with sparseness epsilon from N
+ * Poisson neurons set n_inputs to epsilon*N.
+ *
+ * In STIMULATOR_DIFFUSION mode the counts are replaced by their Gaussian 
+ * approximation with mean and variance n_inputs*rate*dt which is added in 
+ * a single vectorized pass. Conductances pushed below zero by the 
+ * approximation are clamped at zero. The normal random numbers are read from a table of
+ * 2^POISSONSTIMULATOR_NORMAL_TABLE_BITS quantiles which truncates the tails 
+ * beyond about 3.5 standard deviations. Its cost does not depend on the input rate which
+ * makes it the faster choice when most neurons receive input in every step.
+ *
+ * Like PatternStimulator this class is registered as a Monitor and therefore 
+ * acts after the propagation of the connections in each time step.
+ */
+class PoissonStimulator : protected Monitor
+{
+private:
+	/*! Spike count distribution: cdf[k] is the probability of at most k input spikes per time step */
+	vector<AurynDouble> cdf;
+	/*! Guide table which maps uniform random numbers to a start index into cdf */
+	vector<NeuronID> guide;
+	/*! Logarithm of the probability of no input spike per neuron and time step */
+	AurynDouble log_p0;
+	/*! Index of the next neuron receiving input */
+	NeuronID x;
+	/*! Vector of Gaussian random numbers used in diffusion mode */
+	gsl_vector_float * noise;
+	/*! Target vector */
+	gsl_vector_float * target;
+	/*! Set if the target is a conductance, which is clamped at zero in diffusion mode */
+	bool nonnegative;
+
+	NeuronID inputs;
+	AurynFloat rate;
+	AurynWeight weight;
+	StimulatorMode mode;
+
+	/*! Number of PoissonStimulators created so far, used to give each instance its own seed */
+	static unsigned int num_instances;
+	/*! Random number generator of this instance */
+	boost::mt19937 gen; 
+	/*! Inverse cumulative distribution of the standard normal distribution used in diffusion mode */
+	vector<AurynFloat> normal_table;
+
+	/*! Recomputes the spike count distribution after parameter changes */
+	void compute_distribution();
+	/*! Fills normal_table */
+	void compute_normal_table();
+	/*! Returns a uniform random number in [0,1) */
+	AurynDouble uniform();
+	/*! Returns the spike count for the uniform random number u by inversion of cdf */
+	NeuronID sample(AurynDouble u);
+	/*! Draws the number of neurons without input until the next one with input */
+	NeuronID skip();
+	/*! Reports input to all units of dst (see NeuronGroup::mark_input) */
+	void mark_all_targets();
+
+protected:
+	/*! The target NeuronGroup */
+	NeuronGroup * dst;
+	/*! Default init method */
+	void init(NeuronGroup * target, NeuronID n_inputs, AurynFloat rate, AurynWeight weight, TransmitterType transmitter, StimulatorMode mode);
+	/*! Default free method */
+	void free();
+
+public:
+	/*! Default constructor
+	 * @param target The target group.
+	 * @param n_inputs The number of Poisson inputs each target neuron receives.
+	 * @param rate The firing rate of each input in Hz.
+	 * @param weight The weight of each input.
+	 * @param transmitter The target variable (GLUT, GABA, NMDA or MEM).
+	 * @param mode Exact binomial counts or their diffusion approximation. */
+	PoissonStimulator(NeuronGroup * target, 
+			NeuronID n_inputs, 
+			AurynFloat rate, 
+			AurynWeight weight, 
+			TransmitterType transmitter=GLUT, 
+			StimulatorMode mode=STIMULATOR_POISSON);
+	/*! Default destructor */
+	virtual ~PoissonStimulator();
+	/*! Implementation of necessary propagate() function. */
+	void propagate();
+	/*! Sets the firing rate of the inputs in Hz */
+	void set_rate(AurynFloat rate);
+	/*! Returns the firing rate of the inputs in Hz */
+	AurynFloat get_rate();
+	/*! Sets the weight of the inputs */
+	void set_weight(AurynWeight weight);
+	/*! Returns the weight of the inputs */
+	AurynWeight get_weight();
+	/*! Sets the sampling mode */
+	void set_mode(StimulatorMode mode);
+	/*! Seeds the random number generator of this PoissonStimulator */
+	void seed(int s);
+};
+
+#endif /*POISSONSTIMULATOR_H_*/
@@ -25,6 +25,13 @@ PopulationRateMonitor::PopulationRateMonitor(SpikingGroup * source, string filen
 	init(source,filename,binsize);
 }
 
+PopulationRateMonitor::PopulationRateMonitor(SpikingGroup * source, OutputContainer * out, string streamname, AurynFloat binsize) : Monitor()
+{
+	init(source,streamname,binsize);
+	container = out;
+	stream = container->add_stream(streamname,CONTAINER_RATES,1);
+}
+
 PopulationRateMonitor::~PopulationRateMonitor()
 {
 }
@@ -37,6 +44,8 @@ void PopulationRateMonitor::init(SpikingGroup * source, string filename, AurynFl
 	bsize = binsize;
 	ssize = bsize/dt;
 	counter = 0;
+	container = NULL;
+	stream = 0;
 
 	stringstream oss;
 	oss << "PopulationRateMonitor:: Setting binsize " << bsize << "s";
@@ -52,7 +61,17 @@ void PopulationRateMonitor::propagate()
 		if (sys->get_clock()%ssize==0) {
 			double rate = 1.*counter/bsize/src->get_rank_size();
 			counter = 0;
-			outfile << dt*(sys->get_clock()) << " " << rate << "\n";
+			if ( container != NULL ) {
+				const AurynFloat value = rate;
+				container->append(stream,sys->get_clock(),&value);
+			} else
+				outfile << dt*(sys->get_clock()) << " " << rate << "\n";
 		}
 	}
 }
+
+void PopulationRateMonitor::flush()
+{
+	Monitor::flush();
+	if ( container != NULL ) container->flush();
+}
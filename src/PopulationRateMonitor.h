@@ -25,6 +25,7 @@
 #include "Monitor.h"
 #include "System.h"
 #include "SpikingGroup.h"
+#include "OutputContainer.h"
 #include <fstream>
 #include <iomanip>
 
@@ -35,6 +36,9 @@ using namespace std;
  * Instances of this class record the population firing rate of the src SpikingGroup assigned.
  * Binning is done discretely in bins of size bsize that is directly transformed in discrete 
  * AurynTime steps. The default 
+ *
+ * Instead of a text file the rates can be written as a stream of an 
+ * OutputContainer with one AurynFloat value per bin.
  */
 
 class PopulationRateMonitor : protected Monitor
@@ -46,6 +50,9 @@ private:
 	AurynTime ssize;
 	/*! Binsize used in seconds */
 	AurynDouble bsize;
+	/*! Container to write to or NULL */
+	OutputContainer * container;
+	unsigned int stream;
 
 protected:
 	/*! The source SpikingGroup */
@@ -59,10 +66,14 @@ public:
 	 @param[filename] The filename to write to (should be different for each rank.)
 	 @param[binsize] The binsize used for counting in seconds.*/
 	PopulationRateMonitor(SpikingGroup * source, string filename, AurynFloat binsize=1e-3);
+	/*! Writes the rates to the stream streamname of container */
+	PopulationRateMonitor(SpikingGroup * source, OutputContainer * container, string streamname, AurynFloat binsize=1e-3);
 	/*! Default Destructor */
 	virtual ~PopulationRateMonitor();
 	/*! Implementation of necessary propagate() function. */
 	void propagate();
+	/*! Writes buffered output to the file or container */
+	void flush();
 };
 
 #endif /*POPULATIONRATEMONITOR_H_*/
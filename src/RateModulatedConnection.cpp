@@ -57,6 +57,12 @@ void RateModulatedConnection::init_shortcuts()
 	bkw_data = bkw->get_data_begin();
 }
 
+void RateModulatedConnection::finalize() 
+{
+	DuplexConnection::finalize();
+	init_shortcuts(); // bkw might have been reallocated
+}
+
 RateModulatedConnection::RateModulatedConnection(const char * filename) 
 : DuplexConnection(filename)
 {
@@ -153,6 +159,10 @@ void RateModulatedConnection::propagate()
 	// if ( sys->get_clock()%100000== 0 )
 	// 	cout << rate_modulation_mul << endl;
 	
+	if ( consolidated ) {
+		SparseConnection::propagate();
+		return;
+	}
 
 	propagate_forward();
 	propagate_backward();
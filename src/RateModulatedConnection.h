@@ -102,6 +102,8 @@ public:
 	virtual ~RateModulatedConnection();
 
 	void init_shortcuts();
+	/*! Rebuilds the backward matrix and updates the shortcuts into it */
+	virtual void finalize();
 	void propagate_forward();
 	void propagate_backward();
 	void propagate();
@@ -0,0 +1,197 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ReplayGroup.h"
+
+ReplayGroup::ReplayGroup(NeuronID n, string filename) 
+: SpikingGroup(n, REPLAYGROUP_LOAD_MULTIPLIER)
+{
+	vector<string> filenames;
+	filenames.push_back(filename);
+	init(filenames);
+}
+
+ReplayGroup::ReplayGroup(NeuronID n, vector<string> filenames) 
+: SpikingGroup(n, REPLAYGROUP_LOAD_MULTIPLIER)
+{
+	init(filenames);
+}
+
+void ReplayGroup::init(vector<string> names)
+{
+	sys->register_spiking_group(this);
+
+	filenames = names;
+	time_scale = 1.0;
+	time_offset = 0;
+
+	if ( !evolve_locally() ) return;
+
+	map_files();
+
+	stringstream oss;
+	oss << "ReplayGroup:: Replaying " << files.size() << " files";
+	logger->msg(oss.str(),NOTIFICATION);
+}
+
+void ReplayGroup::map_files()
+{
+	free();
+	// a neuron map can send any recorded neuron to this rank
+	const NeuronID stride = neuron_map.empty() ? get_locked_range() : 1;
+	const NeuronID residue = neuron_map.empty() ? communicator->rank()-get_locked_rank() : 0;
+	for ( unsigned int i = 0 ; i < filenames.size() ; ++i ) {
+		BinarySpikeFile * file = new BinarySpikeFile(filenames[i],stride,residue);
+		if ( !files.empty() && file->get_dt() != files[0]->get_dt() ) {
+			stringstream oss;
+			oss << "ReplayGroup:: " << filenames[i] 
+				<< " has a different time step than " << filenames[0];
+			logger->msg(oss.str(),ERROR);
+			delete file;
+			free();
+			throw AurynSpikeFileException();
+		}
+		files.push_back(file);
+		positions.push_back(vector<boost::uint64_t>(file->get_num_segments(),0));
+	}
+	if ( !files.empty() ) 
+		time_scale = files[0]->get_dt()/dt;
+	rewind(sys->get_clock());
+}
+
+void ReplayGroup::free()
+{
+	for ( unsigned int i = 0 ; i < files.size() ; ++i ) 
+		delete files[i];
+	files.clear();
+	positions.clear();
+}
+
+ReplayGroup::~ReplayGroup()
+{
+	free();
+}
+
+boost::int64_t ReplayGroup::file2sim(AurynTime t)
+{
+	if ( time_scale == 1.0 ) return t+time_offset;
+	return (boost::int64_t)(t*time_scale+0.5)+time_offset;
+}
+
+void ReplayGroup::rewind(AurynTime t)
+{
+	// first spike which is played at or after t
+	boost::int64_t ft = (boost::int64_t)t-time_offset;
+	if ( time_scale != 1.0 ) ft = (boost::int64_t)(ft/time_scale);
+	for ( unsigned int i = 0 ; i < files.size() ; ++i ) {
+		for ( unsigned int s = 0 ; s < positions[i].size() ; ++s ) {
+			boost::uint64_t & pos = positions[i][s];
+			pos = files[i]->find(max(ft,(boost::int64_t)0),s);
+			const BinarySpikeEvent * events = files[i]->get_events(s);
+			while ( pos < files[i]->get_segment_size(s) && file2sim(events[pos].time) < t ) 
+				++pos;
+			files[i]->prefetch(pos,REPLAYGROUP_PREFETCH,s);
+		}
+	}
+}
+
+void ReplayGroup::evolve()
+{
+	const boost::int64_t now = sys->get_clock();
+	boost::int64_t next = -1;
+
+	for ( unsigned int f = 0 ; f < files.size() ; ++f ) {
+		for ( unsigned int s = 0 ; s < positions[f].size() ; ++s ) {
+			const BinarySpikeEvent * events = files[f]->get_events(s);
+			const boost::uint64_t num = files[f]->get_segment_size(s);
+			boost::uint64_t pos = positions[f][s];
+
+			while ( pos < num ) {
+				const boost::int64_t t = file2sim(events[pos].time);
+				if ( t > now ) {
+					if ( next < 0 || t < next ) next = t;
+					break;
+				}
+				if ( t == now ) {
+					NeuronID i = events[pos].neuron;
+					if ( !neuron_map.empty() ) 
+						i = i < neuron_map.size() ? neuron_map[i] : get_size();
+					if ( i < get_size() && localrank(i) ) 
+						spikes->push_back(i);
+				}
+				++pos;
+				if ( pos%REPLAYGROUP_PREFETCH == 0 ) 
+					files[f]->prefetch(pos+REPLAYGROUP_PREFETCH,REPLAYGROUP_PREFETCH,s);
+			}
+			positions[f][s] = pos;
+		}
+	}
+
+	if ( next < 0 ) 
+		sleep(); // all files played
+	else
+		sleep_until( (AurynTime)next ); // nothing to do before the next spike
+}
+
+void ReplayGroup::set_time_offset(AurynDouble offset)
+{
+	if ( !evolve_locally() ) return;
+	time_offset = (boost::int64_t)(offset/dt+(offset<0?-0.5:0.5));
+	rewind(sys->get_clock());
+	wake();
+}
+
+void ReplayGroup::set_neuron_map(vector<NeuronID> map)
+{
+	const bool remap = neuron_map.empty() != map.empty();
+	neuron_map = map;
+	if ( remap && evolve_locally() ) 
+		map_files();
+	wake();
+}
+
+void ReplayGroup::load_neuron_map(string filename)
+{
+	ifstream infile(filename.c_str());
+	if ( !infile ) {
+		stringstream oss;
+		oss << "ReplayGroup:: Can't open neuron map " << filename;
+		logger->msg(oss.str(),ERROR);
+		throw AurynOpenFileException();
+	}
+
+	// unmapped IDs point beyond the group and are dropped
+	vector<NeuronID> map;
+	char buffer[256];
+	while ( infile.getline(buffer,255) ) {
+		if ( buffer[0] == '#' ) continue;
+		NeuronID from, to;
+		if ( sscanf(buffer,"%u %u",&from,&to) != 2 ) continue;
+		if ( from >= map.size() ) 
+			map.resize(from+1,get_size());
+		map[from] = to;
+	}
+	infile.close();
+	set_neuron_map(map);
+
+	stringstream oss;
+	oss << "ReplayGroup:: Loaded neuron map " << filename;
+	logger->msg(oss.str(),NOTIFICATION);
+}
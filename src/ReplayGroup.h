@@ -0,0 +1,96 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPLAYGROUP_H_
+#define REPLAYGROUP_H_
+
+#include "auryn_definitions.h"
+#include "System.h"
+#include "SpikingGroup.h"
+#include "BinarySpikeFile.h"
+
+#include <vector>
+#include <string>
+
+#define REPLAYGROUP_LOAD_MULTIPLIER 1.0
+/*! Number of spikes per file the kernel is asked to read ahead */
+#define REPLAYGROUP_PREFETCH 65536
+
+using namespace std;
+
+/*! \brief Plays back the spikes recorded by BinarySpikeMonitor
+ *
+ * The group streams one or several binary spike files (see BinarySpikeFile),
+ * for instance the per-rank files a BinarySpikeMonitor wrote in a previous 
+ * simulation, and emits their spikes at the recorded time steps. Several 
+ * files are merged on the fly. The group is distributed across ranks; every 
+ * rank maps the files and emits the spikes of its own neurons. Files which 
+ * are partitioned into a multiple of the number of ranks of the group (see 
+ * BinarySpikeWriter) are split between the ranks, each rank only reads the
+ * partitions of its own neurons. Otherwise, and whenever a neuron map is 
+ * set, each rank walks over all records and drops those of other ranks. 
+ *
+ * With set_time_offset() the recording can be shifted in time. A negative 
+ * offset skips the beginning of the recording. With set_neuron_map() the 
+ * recorded neuron IDs can be mapped to different neurons of the group; 
+ * spikes of neurons which are not mapped to a neuron of the group are 
+ * dropped.
+ */
+class ReplayGroup : public SpikingGroup
+{
+private:
+	vector<string> filenames;
+	vector<BinarySpikeFile*> files;
+	/*! Next spike to play for each segment of each file */
+	vector< vector<boost::uint64_t> > positions;
+	/*! Time step of the files in units of dt */
+	AurynDouble time_scale;
+	/*! Offset of the recording in time steps */
+	boost::int64_t time_offset;
+	/*! Maps recorded neuron IDs to group neuron IDs if not empty */
+	vector<NeuronID> neuron_map;
+
+	void init(vector<string> filenames);
+	/*! Maps the files, only the partitions of the local neurons if there is no neuron map */
+	void map_files();
+	void free();
+	/*! Converts a time in the files to simulation time including the offset */
+	boost::int64_t file2sim(AurynTime t);
+	/*! Moves all files to the first spike at or after time step t */
+	void rewind(AurynTime t);
+	
+public:
+	/*! Replays a single binary spike file */
+	ReplayGroup(NeuronID n, string filename);
+	/*! Replays the merged spikes of several binary spike files */
+	ReplayGroup(NeuronID n, vector<string> filenames);
+	virtual ~ReplayGroup();
+	virtual void evolve();
+	/*! Plays the spike recorded at time t in the files at time t+offset (in s) */
+	void set_time_offset(AurynDouble offset);
+	/*! Emits spikes of recorded neuron i on neuron map[i]. IDs outside of map 
+	 * and map entries >= the group size are dropped. An empty map disables 
+	 * the mapping. */
+	void set_neuron_map(vector<NeuronID> map);
+	/*! Loads a neuron map from a text file with lines of recorded ID and target ID */
+	void load_neuron_map(string filename);
+};
+
+#endif /*REPLAYGROUP_H_*/
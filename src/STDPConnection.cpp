@@ -195,6 +195,10 @@ void STDPConnection::set_max_weight(AurynWeight wmax)
 
 void STDPConnection::propagate()
 {
+	if ( consolidated ) {
+		SparseConnection::propagate();
+		return;
+	}
 	propagate_forward();
 	propagate_backward();
 }
@@ -22,42 +22,67 @@
 
 void STPConnection::init() 
 {
-	if ( src->get_rank_size() > 0 ) {
-		// init of STP stuff
-		tau_d = 0.2;
-		tau_f = 1.0;
-		Urest = 0.3;
-		Ujump = 0.01;
-		state_x = gsl_vector_float_alloc( src->get_rank_size() );
-		state_u = gsl_vector_float_alloc( src->get_rank_size() );
-		state_temp = gsl_vector_float_alloc( src->get_rank_size() );
-		for (NeuronID i = 0; i < src->get_rank_size() ; i++)
-		{
-			   gsl_vector_float_set (state_x, i, 1 ); // TODO
-			   gsl_vector_float_set (state_u, i, Ujump );
-		}
+	// init of STP stuff
+	tau_d = 0.2;
+	tau_f = 1.0;
+	Urest = 0.3;
+	Ujump = 0.01;
 
-	}
+	receiver_side = false;
+	state_size = 0;
+	if ( src->get_rank_size() > 0 ) 
+		init_state( src->get_rank_size() );
 
 	// registering the right amount of spike attributes
 	// this line is very important finding bugs due to 
 	// this being wrong or missing is hard 
+	// The count has to be the same on all ranks, also on 
+	// those without postsynaptic neurons.
 	src->set_num_spike_attributes(1);
 
+	// ranks without postsynaptic neurons still have to push the 
+	// attributes of their presynaptic neurons
+	if ( !dst->evolve_locally() && src->evolve_locally() ) 
+		sys->register_connection(this);
+
+}
+
+void STPConnection::init_state(NeuronID n)
+{
+	state_size = n;
+	state_x = gsl_vector_float_alloc( state_size );
+	state_u = gsl_vector_float_alloc( state_size );
+	last_update = new AurynTime [state_size];
+	for (NeuronID i = 0; i < state_size ; i++)
+	{
+		   gsl_vector_float_set (state_x, i, 1 ); // TODO
+		   gsl_vector_float_set (state_u, i, Ujump );
+		   last_update[i] = sys->get_clock();
+	}
+}
+
+void STPConnection::free_state()
+{
+	if ( state_size > 0 ) {
+		gsl_vector_float_free (state_x);
+		gsl_vector_float_free (state_u);
+		delete [] last_update;
+	}
+	state_size = 0;
 }
 
 
 STPConnection::STPConnection(const char * filename) 
 : SparseConnection(filename)
 {
-	if ( dst->get_post_size() > 0 ) 
-		init();
+	init();
 }
 
 STPConnection::STPConnection(SpikingGroup * source, NeuronGroup * destination, 
 		TransmitterType transmitter) 
 : SparseConnection(source, destination, transmitter)
 {
+	init();
 }
 
 STPConnection::STPConnection(SpikingGroup * source, NeuronGroup * destination, 
@@ -65,8 +90,7 @@ STPConnection::STPConnection(SpikingGroup * source, NeuronGroup * destination,
 		TransmitterType transmitter) 
 : SparseConnection(source, destination, filename, transmitter)
 {
-	if ( dst->get_post_size() > 0 ) 
-		init();
+	init();
 }
 
 
@@ -81,25 +105,58 @@ STPConnection::STPConnection( SpikingGroup * source, NeuronGroup * destination,
 		TransmitterType transmitter, string name) 
 : SparseConnection(source,destination,weight,sparseness,transmitter, name)
 {
-	if ( dst->get_post_size() > 0 ) 
-		init();
+	init();
 }
 
 void STPConnection::free()
 {
-	if ( src->get_rank_size() > 0 ) {
-		gsl_vector_float_free (state_x);
-		gsl_vector_float_free (state_u);
-		gsl_vector_float_free (state_temp);
+	free_state();
+}
+
+void STPConnection::set_receiver_side(bool enable)
+{
+	if ( enable == receiver_side ) return;
+
+	// the attribute count has to change on all ranks 
+	receiver_side = enable;
+	free_state();
+	if ( receiver_side ) {
+		// the replica holds the state of all presynaptic neurons
+		src->set_num_spike_attributes(-1);
+		if ( dst->get_post_size() > 0 ) 
+			init_state( src->get_size() );
+	} else {
+		src->set_num_spike_attributes(1);
+		if ( src->get_rank_size() > 0 ) 
+			init_state( src->get_rank_size() );
 	}
+
+	stringstream oss;
+	oss << "STPConnection: ("<< get_name() << "): receiver_side= " << receiver_side;
+	logger->msg(oss.str(),DEBUG);
+}
+
+AurynFloat STPConnection::spike_efficacy(NeuronID i)
+{
+	// exact relaxation since the last spike
+	AurynTime now = sys->get_clock();
+	AurynDouble elapsed = dt*(now-last_update[i]);
+	last_update[i] = now;
+	double x = 1.0 - (1.0-gsl_vector_float_get( state_x, i ))*exp(-elapsed/tau_d);
+	double u = Ujump + (gsl_vector_float_get( state_u, i )-Ujump)*exp(-elapsed/tau_f);
+
+	// dynamics 
+	gsl_vector_float_set( state_x, i, x-u*x );
+	gsl_vector_float_set( state_u, i, u+Ujump*(1-u) );
+
+	return x*u;
 }
 
 
 
 STPConnection::~STPConnection()
 {
-	if ( dst->get_post_size() > 0 ) 
-		free();
+	free();
 }
 
 void STPConnection::push_attributes()
@@ -107,38 +164,20 @@ void STPConnection::push_attributes()
 	SpikeContainer * spikes = src->get_spikes_immediate();
 	for (SpikeContainer::const_iterator spike = spikes->begin() ;
 			spike != spikes->end() ; ++spike ) {
-		// dynamics 
 		NeuronID spk = src->global2rank(*spike);
-		double x = gsl_vector_float_get( state_x, spk );
-		double u = gsl_vector_float_get( state_u, spk );
-		gsl_vector_float_set( state_x, spk, x-u*x );
-		gsl_vector_float_set( state_u, spk, u+Ujump*(1-u) );
-
 		// TODO spike translation or introduce local_spikes function in SpikingGroup and implement this there ... (better option)
-		src->push_attribute( x*u ); 
+		src->push_attribute( spike_efficacy(spk) ); 
 	}
 }
 
-void STPConnection::evolve()
+bool STPConnection::is_quiescent()
 {
-	// dynamics of x
-	gsl_vector_float_set_all( state_temp, 1);
-	gsl_blas_saxpy(-1,state_x,state_temp);
-	gsl_blas_saxpy(dt/tau_d,state_temp,state_x);
-
-	// dynamics of u
-	gsl_vector_float_set_all( state_temp, Ujump);
-	gsl_blas_saxpy(-1,state_u,state_temp);
-	gsl_blas_saxpy(dt/tau_f,state_temp,state_u);
-
-	// double x = gsl_vector_float_get( state_x, 0 );
-	// double u = gsl_vector_float_get( state_u, 0 );
-	// cout << setprecision(5) << x << " " << u << " " << x*u << endl;
+	return false;
 }
 
 void STPConnection::propagate()
 {
-	if ( src->evolve_locally()) {
+	if ( src->evolve_locally() && !receiver_side ) {
 		push_attributes(); // stuffs all attributes into the SpikeDelays for sync
 	}
 
@@ -151,13 +190,16 @@ void STPConnection::propagate()
 			SpikeContainer::const_iterator spikes_end = src->get_spikes()->end();
 			for (SpikeContainer::const_iterator spike = src->get_spikes()->begin() ;
 					spike != spikes_end ; ++spike ) {
+				AurynFloat efficacy;
+				if ( receiver_side ) 
+					efficacy = spike_efficacy(*spike);
+				else 
+					efficacy = *attr++;
 				for (NeuronID * c = w->get_row_begin(*spike) ; c != w->get_row_end(*spike) ; ++c ) {
-					AurynWeight value = data[c-ind] * *attr; 
+					AurynWeight value = data[c-ind] * efficacy; 
 					transmit( *c , value );
 				}
-				++attr;
 			}
 		}
 	}
 }
-
@@ -32,9 +32,21 @@ class STPConnection : public SparseConnection
 {
 	private:
 		// STP parameters (maybe this should all move to a container)
+		/*! Resources x of each presynaptic neuron right after its last spike */
 		gsl_vector_float * state_x;
+		/*! Utilization u of each presynaptic neuron right after its last spike */
 		gsl_vector_float * state_u;
-		gsl_vector_float * state_temp;
+		/*! Clock of the last update of state_x and state_u per presynaptic neuron */
+		AurynTime * last_update;
+		/*! Number of presynaptic neurons for which state is kept */
+		NeuronID state_size;
+		/*! Is true if the STP state is computed on the receiving rank */
+		bool receiver_side;
+
+		void init_state(NeuronID n);
+		void free_state();
+		/*! Updates the state of neuron i upon a spike and returns the efficacy x*u */
+		AurynFloat spike_efficacy(NeuronID i);
 
 
 
@@ -51,8 +63,20 @@ public:
 	STPConnection(SpikingGroup * source, NeuronGroup * destination, AurynWeight weight, AurynFloat sparseness=0.05, TransmitterType transmitter=GLUT, string name="STPConnection");
 	virtual ~STPConnection();
 	virtual void propagate();
+	/*! Always returns false since the synaptic state is updated in propagate() */
+	virtual bool is_quiescent();
+	/*! Brings the STP state of the neurons that spike up to date and
+	 * pushes the resulting efficacy x*u as spike attribute. Between spikes
+	 * x and u relax exponentially to 1 and Ujump respectively, which is
+	 * solved exactly at the time of a spike. There is no per time step cost. */
 	void push_attributes();
-	void evolve();
+	/*! Computes the STP state on the receiving ranks instead of the sending ones.
+	 * Since the state only depends on presynaptic spike times, each rank with 
+	 * postsynaptic neurons keeps a replica of the state of all presynaptic 
+	 * neurons and updates it with the delayed spikes it receives. The efficacy is
+	 * then no longer sent as spike attribute, which shrinks the sync payload.
+	 * Should be called before running the simulation since it resets the state. */
+	void set_receiver_side(bool enable=true);
 	void init();
 	void free();
 
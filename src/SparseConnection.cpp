@@ -136,6 +136,8 @@ void SparseConnection::init()
 
 	patterns_every_pre = 1;
 	patterns_every_post = 1;
+
+	dist_optimized = true;
 }
 
 void SparseConnection::seed(NeuronID randomseed) 
@@ -202,6 +204,7 @@ AurynWeight SparseConnection::get_max_weight()
 
 void SparseConnection::random_data(AurynWeight mean, AurynWeight sigma) 
 {
+	flush_weights();
 	stringstream oss;
 	oss << "SparseConnection: (" << get_name() << "): randomizing non-zero connections (gaussian) with mean=" << mean << " sigma=" << sigma ;
 	logger->msg(oss.str(),NOTIFICATION);
@@ -237,6 +240,7 @@ void SparseConnection::sparse_set_data(AurynDouble sparseness, AurynWeight value
 
 void SparseConnection::random_col_data(AurynWeight mean, AurynWeight sigma) 
 {
+	flush_weights();
 	stringstream oss;
 	oss << "SparseConnection: (" << get_name() << "): Randomly scaling cols (gaussian) with mean=" << mean << " sigma=" << sigma ;
 	logger->msg(oss.str(),DEBUG);
@@ -255,6 +259,7 @@ void SparseConnection::random_col_data(AurynWeight mean, AurynWeight sigma)
 
 void SparseConnection::set_block(NeuronID lo_row, NeuronID hi_row, NeuronID lo_col, NeuronID hi_col, AurynWeight weight)
 {
+	flush_weights();
 	AurynWeight temp = max(weight,get_min_weight());
 	for ( NeuronID i = 0 ; i < get_m_rows() ; ++i ) 
 	{
@@ -268,11 +273,13 @@ void SparseConnection::set_block(NeuronID lo_row, NeuronID hi_row, NeuronID lo_c
 
 void SparseConnection::set_all(AurynWeight weight)
 {
+	flush_weights();
 	w->set_all( weight );
 }
 
 void SparseConnection::set_upper_triangular(AurynWeight weight)
 {
+	flush_weights();
 	w->set_all( 0.0 );
 	AurynWeight temp = max(weight,get_min_weight());
 	for ( NeuronID i = 0 ; i < get_m_rows() ; ++i ) 
@@ -296,8 +303,10 @@ void SparseConnection::connect_block_random(AurynWeight weight, float sparseness
 	int r = 0; // these variables are used to speed up building the matrix if the destination is distributed
 	int s = 1;
 
-	r = communicator->rank()-dst->get_locked_rank(); 
-	s = dst->get_locked_range();
+	if ( dist_optimized ) {
+		r = communicator->rank()-dst->get_locked_rank(); 
+		s = dst->get_locked_range();
+	}
 
 	boost::exponential_distribution<> dist(sparseness);
 	boost::variate_generator<boost::mt19937&, boost::exponential_distribution<> > die(SparseConnection::sparse_connection_gen, dist);
@@ -400,6 +409,11 @@ bool SparseConnection::push_back(NeuronID i, NeuronID j, AurynWeight weight)
 	return false;
 }
 
+bool SparseConnection::is_quiescent()
+{
+	return src->get_spikes()->empty();
+}
+
 void SparseConnection::propagate()
 {
 	for (SpikeContainer::const_iterator spike = src->get_spikes()->begin() ;
@@ -416,6 +430,18 @@ void SparseConnection::propagate()
 	}
 }
 
+void SparseConnection::mark_targets()
+{
+	for (SpikeContainer::const_iterator spike = src->get_spikes()->begin() ;
+			spike != src->get_spikes()->end() ; 
+			++spike ) {
+		for (NeuronID * c = w->get_row_begin(*spike) ; 
+				c != w->get_row_end(*spike) ; 
+				++c ) 
+			dst->mark_input(dst->global2rank(*c));
+	}
+}
+
 void SparseConnection::sanity_check()
 {
 	if ( dst->evolve_locally() == false ) return;
@@ -461,6 +487,7 @@ void SparseConnection::sanity_check()
 
 void SparseConnection::stats(AurynFloat &mean, AurynFloat &std)
 {
+	flush_weights();
 	NeuronID count = 0;
 	AurynFloat t = 0;
 	AurynFloat sum = 0;
@@ -491,9 +518,14 @@ void SparseConnection::stats(AurynFloat &mean, AurynFloat &std)
 
 void SparseConnection::prune()
 {   
+	flush_weights();
 	w->prune();
 }
 
+void SparseConnection::flush_weights()
+{
+}
+
 AurynWeight SparseConnection::get_data(NeuronID i)
 {
 	return w->get_data(i);
@@ -516,6 +548,7 @@ AurynWeight * SparseConnection::get_ptr(NeuronID i, NeuronID j)
 
 void SparseConnection::set(vector<neuron_pair> element_list, AurynWeight value)
 {
+	flush_weights();
 	for (vector<neuron_pair>::iterator iter = element_list.begin() ; iter != element_list.end() ; ++iter)
 	{
 		w->set((*iter).i, (*iter).j,value);
@@ -562,6 +595,7 @@ bool SparseConnection::write_to_file(ForwardMatrix * m, const char * filename )
 
 bool SparseConnection::write_to_file(const char * filename)
 {
+	flush_weights();
 	return write_to_file(w,filename);
 }
 
@@ -863,6 +897,7 @@ vector<neuron_pair> SparseConnection::get_pre_partners(NeuronID j)
 
 void SparseConnection::clip(AurynWeight lo, AurynWeight hi)
 {
+	flush_weights();
 	for ( AurynWeight * ptr = w->get_data_begin() ; ptr != w->get_data_end()  ; ++ptr ) {
 		if ( *ptr < lo )
 			*ptr = lo;
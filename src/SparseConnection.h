@@ -60,13 +60,13 @@ class SparseConnection : public Connection
 {
 private:
 	SpikeContainer * spikes;
-	static boost::mt19937 sparse_connection_gen;
 	static bool has_been_seeded;
 	bool has_been_allocated;
 	void init();
 	bool init_from_file(const char * filename);
 
 protected:
+	static boost::mt19937 sparse_connection_gen;
 	AurynWeight wmin;
 	AurynWeight wmax;
 	bool skip_diagonal;
@@ -93,6 +93,9 @@ public:
 	 * wrap neuron IDs back onto existing cells via the modulo 
 	 * function. */
 	bool wrap_patterns;
+	/*! Switch that toggles whether the random fill methods only draw the 
+	 * columns which exist on the local rank. Default is true. */
+	bool dist_optimized;
 
 	/*! A pointer that points per defalt to the SimpleMatrix
 	 * that stores the connectinos. */
@@ -118,6 +121,11 @@ public:
 	/*! This function seeds the generator for all random fill operatios */
 	void seed(NeuronID randomseed);
 
+	/*! Completes weight changes which a subclass defers (e.g. lazy decay)
+	 * so that the whole matrix can be read or written directly. Is called 
+	 * by the whole-matrix operations below and by the weight monitors. */
+	virtual void flush_weights();
+
 	virtual AurynWeight get(NeuronID i, NeuronID j);
 	virtual AurynWeight * get_ptr(NeuronID i, NeuronID j);
 	virtual AurynWeight get_data(NeuronID i);
@@ -147,7 +155,7 @@ public:
 
 	virtual void sparse_set_data(AurynDouble sparseness, AurynWeight value);
 
-	void connect_random(AurynWeight weight=1.0, float sparseness=0.05, bool skip_diag=false);
+	virtual void connect_random(AurynWeight weight=1.0, float sparseness=0.05, bool skip_diag=false);
 
 	/*! Underlying sparse fill method. Set dist_optimized to false and seed
 	 * all ranks the same to get the same matrix independent of the number
@@ -161,7 +169,7 @@ public:
 			NeuronID hi_col, 
 			bool skip_diag=false );
 	virtual void finalize();
-	bool push_back(NeuronID i, NeuronID j, AurynWeight weight);
+	virtual bool push_back(NeuronID i, NeuronID j, AurynWeight weight);
 	AurynLong get_nonzero();
 	void put_pattern(type_pattern * pattern, AurynWeight strength, bool overwrite );
 	void put_pattern(type_pattern * pattern1, type_pattern * pattern2, AurynWeight strength, bool overwrite );
@@ -169,6 +177,10 @@ public:
 	void load_patterns( string filename, AurynWeight strength, bool overwrite = false, bool chainmode = false);
 	void load_patterns( string filename, AurynWeight strength, int n, bool overwrite = false, bool chainmode = false);
 	virtual void propagate();
+	/*! Marks the rows of the presynaptic spikes, which all subclasses propagate along */
+	virtual void mark_targets();
+	/*! Returns true if there are no presynaptic spikes to propagate */
+	virtual bool is_quiescent();
 
 	/*! Quick an dirty function that checks if all units on the local rank are connected */
 	void sanity_check();
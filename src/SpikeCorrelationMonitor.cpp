@@ -0,0 +1,160 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SpikeCorrelationMonitor.h"
+
+SpikeCorrelationMonitor::SpikeCorrelationMonitor(SpikingGroup * source, string filename, AurynDouble interval, AurynDouble binsize) : Monitor(filename)
+{
+	init(source,filename,interval,binsize);
+}
+
+SpikeCorrelationMonitor::~SpikeCorrelationMonitor()
+{
+}
+
+void SpikeCorrelationMonitor::init(SpikingGroup * source, string filename, AurynDouble interval, AurynDouble binsize)
+{
+	src = source;
+	per_pair = false;
+	nbins = 0;
+	if ( !src->evolve_locally() ) return;
+
+	sys->register_monitor(this);
+
+	bsize = max((AurynTime)(binsize/dt+0.5),(AurynTime)1);
+	// intervals consist of whole bins
+	isize = max((AurynTime)(interval/dt+0.5)/bsize,(AurynTime)1)*bsize;
+	counts.resize(src->get_rank_size(),0);
+
+	stringstream oss;
+	oss << "SpikeCorrelationMonitor:: Setting interval " << isize*dt << "s and binsize " << bsize*dt << "s";
+	logger->msg(oss.str(),NOTIFICATION);
+
+	outfile << setiosflags(ios::fixed) << setprecision(6);
+}
+
+void SpikeCorrelationMonitor::add_pair(NeuronID i, NeuronID j)
+{
+	if ( i >= src->get_size() || j >= src->get_size() || !src->localrank(i) || !src->localrank(j) ) {
+		stringstream oss;
+		oss << "SpikeCorrelationMonitor:: Pair (" << i << "," << j << ") is not simulated on this rank";
+		logger->msg(oss.str(),WARNING);
+		return;
+	}
+	SpikePairStats pair;
+	memset(&pair,0,sizeof(pair));
+	pair.a = src->global2rank(i);
+	pair.b = src->global2rank(j);
+	pairs.push_back(pair);
+}
+
+void SpikeCorrelationMonitor::add_random_pairs(unsigned int n, unsigned int seed)
+{
+	const NeuronID size = src->get_rank_size();
+	if ( size < 2 ) return;
+	boost::mt19937 gen(seed+communicator->rank());
+	boost::uniform_int<NeuronID> dist(0,size-1);
+	boost::variate_generator<boost::mt19937&, boost::uniform_int<NeuronID> > die(gen,dist);
+	for ( unsigned int k = 0 ; k < n ; ++k ) {
+		const NeuronID a = die();
+		NeuronID b = die();
+		while ( b == a ) b = die();
+		add_pair(src->rank2global(a),src->rank2global(b));
+	}
+}
+
+void SpikeCorrelationMonitor::set_per_pair(bool enable)
+{
+	per_pair = enable;
+}
+
+void SpikeCorrelationMonitor::close_bin()
+{
+	for ( vector<SpikePairStats>::iterator p = pairs.begin() ; p != pairs.end() ; ++p ) {
+		const AurynDouble ca = counts[p->a];
+		const AurynDouble cb = counts[p->b];
+		p->sum_a += ca;
+		p->sum_a2 += ca*ca;
+		p->sum_b += cb;
+		p->sum_b2 += cb*cb;
+		p->sum_ab += ca*cb;
+	}
+	for ( vector<NeuronID>::const_iterator i = spiked_neurons.begin() ; i != spiked_neurons.end() ; ++i ) 
+		counts[*i] = 0;
+	spiked_neurons.clear();
+	nbins++;
+}
+
+void SpikeCorrelationMonitor::propagate()
+{
+	if ( pairs.empty() ) return;
+	const AurynTime now = sys->get_clock();
+
+	SpikeContainer * spikes = src->get_spikes_immediate();
+	for ( SpikeContainer::const_iterator spike = spikes->begin() ; spike != spikes->end() ; ++spike ) {
+		const NeuronID i = src->global2rank(*spike);
+		if ( counts[i]++ == 0 ) spiked_neurons.push_back(i);
+	}
+
+	if ( (now+1)%bsize == 0 ) close_bin();
+	if ( (now+1)%isize == 0 ) write_stats();
+}
+
+void SpikeCorrelationMonitor::write_stats()
+{
+	if ( nbins == 0 ) return;
+	const AurynTime t_end = sys->get_clock()+1;
+
+	AurynDouble cov_sum = 0.0;
+	AurynDouble corr_sum = 0.0;
+	AurynDouble corr_sum2 = 0.0;
+	unsigned int n = 0;
+	for ( vector<SpikePairStats>::iterator p = pairs.begin() ; p != pairs.end() ; ++p ) {
+		const AurynDouble mean_a = p->sum_a/nbins;
+		const AurynDouble mean_b = p->sum_b/nbins;
+		const AurynDouble var_a = p->sum_a2/nbins-mean_a*mean_a;
+		const AurynDouble var_b = p->sum_b2/nbins-mean_b*mean_b;
+		const AurynDouble cov = p->sum_ab/nbins-mean_a*mean_b;
+		AurynDouble corr = 0.0;
+		if ( var_a > 0.0 && var_b > 0.0 ) {
+			corr = cov/sqrt(var_a*var_b);
+			cov_sum += cov;
+			corr_sum += corr;
+			corr_sum2 += corr*corr;
+			n++;
+		}
+		if ( per_pair ) 
+			outfile << dt*t_end << " " << src->rank2global(p->a) << " " << src->rank2global(p->b) << " " 
+				<< cov << " " << corr << "\n";
+
+		p->sum_a = 0.0;
+		p->sum_a2 = 0.0;
+		p->sum_b = 0.0;
+		p->sum_b2 = 0.0;
+		p->sum_ab = 0.0;
+	}
+	nbins = 0;
+	if ( per_pair ) return;
+
+	const AurynDouble corr_mean = n?corr_sum/n:0.0;
+	const AurynDouble corr_std = n?sqrt(max(corr_sum2/n-corr_mean*corr_mean,0.0)):0.0;
+	outfile << dt*t_end << " " << (n?cov_sum/n:0.0) << " " << corr_mean << " " 
+		<< corr_std << " " << n << "\n";
+}
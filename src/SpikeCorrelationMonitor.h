@@ -0,0 +1,113 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPIKECORRELATIONMONITOR_H_
+#define SPIKECORRELATIONMONITOR_H_
+
+#include "auryn_definitions.h"
+#include "Monitor.h"
+#include "System.h"
+#include "SpikingGroup.h"
+#include <fstream>
+#include <iomanip>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+
+using namespace std;
+
+/*! \brief Sums of the binned spike counts of a neuron pair */
+struct SpikePairStats
+{
+	/*! Rank indices of the two neurons */
+	NeuronID a;
+	NeuronID b;
+	AurynDouble sum_a;
+	AurynDouble sum_a2;
+	AurynDouble sum_b;
+	AurynDouble sum_b2;
+	AurynDouble sum_ab;
+};
+
+/*! \brief Monitor computing spike count covariances of sampled neuron pairs 
+ * online
+ *
+ * Spikes are counted in bins of binsize. At the end of each bin the sums of 
+ * the counts, their squares and their products are accumulated for each 
+ * pair, which takes constant memory per pair. Every interval seconds the 
+ * monitor writes a line 
+ *
+ *   time  mean covariance  mean correlation coefficient  std of coefficients  n
+ *
+ * where n is the number of pairs for which both neurons spiked, or with 
+ * set_per_pair(true) one line per pair
+ *
+ *   time  i  j  covariance  correlation coefficient
+ *
+ * Covariances are in spikes^2 per bin. Both neurons of a pair have to be 
+ * simulated on the same rank; add_random_pairs samples among the neurons of 
+ * this rank.
+ */
+class SpikeCorrelationMonitor : protected Monitor
+{
+private:
+	vector<SpikePairStats> pairs;
+	/*! Spike counts in the current bin */
+	vector<unsigned int> counts;
+	/*! Rank indices of the neurons which spiked in the current bin */
+	vector<NeuronID> spiked_neurons;
+	/*! Interval in units of AurynTime */
+	AurynTime isize;
+	/*! Binsize in units of AurynTime */
+	AurynTime bsize;
+	/*! Number of completed bins in the current interval */
+	unsigned int nbins;
+	bool per_pair;
+
+	void close_bin();
+	void write_stats();
+
+protected:
+	/*! The source SpikingGroup */
+	SpikingGroup * src;
+	/*! Default init method */
+	void init(SpikingGroup * source, string filename, AurynDouble interval, AurynDouble binsize);
+	
+public:
+	/*! Default Constructor 
+	 @param[source] The source spiking group.
+	 @param[filename] The filename to write to (should be different for each rank.)
+	 @param[interval] The interval between two summaries in seconds.
+	 @param[binsize] The binsize for counting spikes in seconds.*/
+	SpikeCorrelationMonitor(SpikingGroup * source, string filename, AurynDouble interval=10., AurynDouble binsize=5e-3);
+	/*! Default Destructor */
+	virtual ~SpikeCorrelationMonitor();
+	/*! Adds the pair of neurons i and j if both are simulated on this rank */
+	void add_pair(NeuronID i, NeuronID j);
+	/*! Adds n random pairs of different neurons of this rank */
+	void add_random_pairs(unsigned int n, unsigned int seed=42);
+	/*! Toggles between summaries and per pair statistics */
+	void set_per_pair(bool enable);
+	/*! Implementation of necessary propagate() function. */
+	void propagate();
+};
+
+#endif /*SPIKECORRELATIONMONITOR_H_*/
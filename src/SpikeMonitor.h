@@ -34,7 +34,10 @@ using namespace std;
  *
  * SpikeMonitor is specified with a source group of type SpikingGroup
  * and writes all or a specified range of the neurons spikes to a
- * file that has to be given at construction time.
+ * file that has to be given at construction time. To record large 
+ * populations use BinarySpikeMonitor which avoids the text formatting.
+ * If only rates, ISI statistics or correlations are needed, SpikeStatsMonitor
+ * and SpikeCorrelationMonitor compute them during the simulation.
  */
 class SpikeMonitor : Monitor
 {
@@ -0,0 +1,171 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SpikePrefetcher.h"
+
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+
+vector<SpikePrefetcher *> SpikePrefetcher::instances;
+pthread_mutex_t SpikePrefetcher::instances_mutex = PTHREAD_MUTEX_INITIALIZER;
+bool SpikePrefetcher::fork_handlers_installed = false;
+
+SpikePrefetcher::SpikePrefetcher(SpikeProducer * p, AurynTime start, AurynTime steps, unsigned int batches)
+{
+	producer = p;
+	batch_steps = max(steps,(AurynTime)1);
+	num_batches = max(batches,2u);
+	ring = new SpikeBatch [num_batches];
+	for ( unsigned int i = 0 ; i < num_batches ; ++i ) 
+		ring[i].offsets.resize(batch_steps+1);
+	head = 0;
+	tail = 0;
+	next_start = start;
+	stop = false;
+	pause = false;
+	paused = false;
+	restart = false;
+
+	if ( !start_producer() ) {
+		delete [] ring;
+		throw AurynPrefetcherException();
+	}
+
+	pthread_mutex_lock(&instances_mutex);
+	if ( !fork_handlers_installed ) {
+		pthread_atfork(prepare_fork,resume_after_fork,restart_after_fork);
+		fork_handlers_installed = true;
+	}
+	instances.push_back(this);
+	pthread_mutex_unlock(&instances_mutex);
+}
+
+SpikePrefetcher::~SpikePrefetcher()
+{
+	pthread_mutex_lock(&instances_mutex);
+	instances.erase(find(instances.begin(),instances.end(),this));
+	pthread_mutex_unlock(&instances_mutex);
+
+	__atomic_store_n(&stop,true,__ATOMIC_RELEASE);
+	if ( !restart ) 
+		pthread_join(thread,NULL);
+	delete [] ring;
+}
+
+bool SpikePrefetcher::start_producer()
+{
+	return pthread_create(&thread,NULL,run_producer,this) == 0;
+}
+
+void SpikePrefetcher::prepare_fork()
+{
+	// the producers must not be in the middle of a batch when the process is copied
+	pthread_mutex_lock(&instances_mutex);
+	for ( unsigned int i = 0 ; i < instances.size() ; ++i ) 
+		__atomic_store_n(&instances[i]->pause,true,__ATOMIC_RELEASE);
+	for ( unsigned int i = 0 ; i < instances.size() ; ++i ) {
+		// a forked child which forks again before its first pop() has no 
+		// producer thread to wait for, its state already is at a batch boundary
+		if ( instances[i]->restart ) continue;
+		while ( !__atomic_load_n(&instances[i]->paused,__ATOMIC_ACQUIRE) ) 
+			usleep(100);
+	}
+}
+
+void SpikePrefetcher::resume_after_fork()
+{
+	for ( unsigned int i = 0 ; i < instances.size() ; ++i ) 
+		__atomic_store_n(&instances[i]->pause,false,__ATOMIC_RELEASE);
+	pthread_mutex_unlock(&instances_mutex);
+}
+
+void SpikePrefetcher::restart_after_fork()
+{
+	// only the forking thread exists in the child, pop() starts a new producer
+	for ( unsigned int i = 0 ; i < instances.size() ; ++i ) {
+		instances[i]->pause = false;
+		instances[i]->paused = false;
+		instances[i]->restart = true;
+	}
+	pthread_mutex_unlock(&instances_mutex);
+}
+
+void * SpikePrefetcher::run_producer(void * prefetcher)
+{
+	((SpikePrefetcher *)prefetcher)->produce();
+	return NULL;
+}
+
+void SpikePrefetcher::produce()
+{
+	while ( !__atomic_load_n(&stop,__ATOMIC_ACQUIRE) ) {
+		if ( __atomic_load_n(&pause,__ATOMIC_ACQUIRE) ) {
+			__atomic_store_n(&paused,true,__ATOMIC_RELEASE);
+			while ( __atomic_load_n(&pause,__ATOMIC_ACQUIRE) ) 
+				usleep(100);
+			__atomic_store_n(&paused,false,__ATOMIC_RELEASE);
+			continue;
+		}
+		if ( head-__atomic_load_n(&tail,__ATOMIC_ACQUIRE) >= num_batches ) {
+			usleep(100); // ring is full
+			continue;
+		}
+
+		SpikeBatch & batch = ring[head%num_batches];
+		batch.start = next_start;
+		batch.spikes.clear();
+		for ( AurynTime k = 0 ; k < batch_steps ; ++k ) {
+			batch.offsets[k] = batch.spikes.size();
+			producer->produce_spikes(next_start+k,&batch.spikes);
+		}
+		batch.offsets[batch_steps] = batch.spikes.size();
+		next_start += batch_steps;
+
+		__atomic_store_n(&head,head+1,__ATOMIC_RELEASE);
+	}
+}
+
+void SpikePrefetcher::pop(AurynTime t, SpikeContainer * spikes)
+{
+	if ( restart ) { // first call in a forked child
+		restart = false;
+		if ( !start_producer() ) throw AurynPrefetcherException();
+	}
+	while ( true ) {
+		while ( __atomic_load_n(&head,__ATOMIC_ACQUIRE) == tail ) 
+			sched_yield(); // producer is behind 
+
+		const SpikeBatch & batch = ring[tail%num_batches];
+		if ( t < batch.start ) return; // already consumed
+		if ( t-batch.start >= batch_steps ) { 
+			__atomic_store_n(&tail,tail+1,__ATOMIC_RELEASE);
+			continue;
+		}
+
+		const AurynTime k = t-batch.start;
+		spikes->insert(spikes->end(),
+				batch.spikes.begin()+batch.offsets[k],
+				batch.spikes.begin()+batch.offsets[k+1]);
+		if ( k+1 == batch_steps ) // done with this batch
+			__atomic_store_n(&tail,tail+1,__ATOMIC_RELEASE);
+		return;
+	}
+}
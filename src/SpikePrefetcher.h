@@ -0,0 +1,122 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPIKEPREFETCHER_H_
+#define SPIKEPREFETCHER_H_
+
+#include "auryn_definitions.h"
+
+#include <vector>
+#include <pthread.h>
+
+#define SPIKEPREFETCHER_BATCH_STEPS 100 //!< Default number of time steps per batch
+#define SPIKEPREFETCHER_NUM_BATCHES 16 //!< Default number of batches in the ring buffer
+
+using namespace std;
+
+/*! \brief Interface of input groups which can generate their spikes ahead of time 
+ *
+ * produce_spikes is called from the producer thread of a SpikePrefetcher 
+ * for consecutive time steps. It must only touch state which is owned by the
+ * producer and must neither log nor communicate via MPI.
+ */
+class SpikeProducer
+{
+public:
+	virtual ~SpikeProducer() {}
+	/*! Appends the global IDs of the spikes emitted on this rank in time step t */
+	virtual void produce_spikes(AurynTime t, SpikeContainer * spikes) = 0;
+};
+
+/*! \brief Spikes of a block of consecutive time steps */
+struct SpikeBatch
+{
+	/*! First time step of the batch */
+	AurynTime start;
+	/*! spikes[offsets[k]] to spikes[offsets[k+1]] are the spikes of time step start+k */
+	vector<NeuronID> offsets;
+	SpikeContainer spikes;
+};
+
+/*! \brief Generates the spikes of an input group in a background thread
+ *
+ * A producer thread calls SpikeProducer::produce_spikes for the upcoming 
+ * time steps and stores the results in batches of batch_steps time steps in
+ * a single-producer single-consumer ring buffer. In evolve the group then 
+ * only copies the spikes of the current step out of the ring. Batches are 
+ * handed over with atomic acquire/release counters and no locks. Because the 
+ * producer generates the steps in order from its own state the spikes are the
+ * same as without prefetching. The consumer waits if the producer falls 
+ * behind.
+ *
+ * Prefetchers survive fork (e.g. by ParameterSweep): before the fork all 
+ * producers are paused at a batch boundary, and the child restarts its 
+ * producer thread on the next pop() from the same state, so the parent and
+ * the child see the same spikes. This also holds if the child forks again 
+ * before its producer thread was restarted.
+ */
+class SpikePrefetcher
+{
+private:
+	SpikeProducer * producer;
+	AurynTime batch_steps;
+	unsigned int num_batches;
+	SpikeBatch * ring;
+	/*! Number of batches written by the producer */
+	unsigned long head;
+	/*! Number of batches released by the consumer */
+	unsigned long tail;
+	/*! First time step of the next batch to produce */
+	AurynTime next_start;
+	bool stop;
+	/*! Set to pause the producer at the next batch boundary */
+	bool pause;
+	/*! Set by the producer while it is paused */
+	bool paused;
+	/*! Set in a forked child whose producer thread does not exist */
+	bool restart;
+	pthread_t thread;
+
+	/*! Prefetchers of this process for the fork handlers */
+	static vector<SpikePrefetcher *> instances;
+	static pthread_mutex_t instances_mutex;
+	static bool fork_handlers_installed;
+
+	static void * run_producer(void * prefetcher);
+	static void prepare_fork();
+	static void resume_after_fork();
+	static void restart_after_fork();
+	/*! Starts the producer thread, returns false on failure */
+	bool start_producer();
+	void produce();
+
+public:
+	/*! Starts the producer thread at time step start */
+	SpikePrefetcher(SpikeProducer * producer, AurynTime start, 
+			AurynTime batch_steps=SPIKEPREFETCHER_BATCH_STEPS, 
+			unsigned int num_batches=SPIKEPREFETCHER_NUM_BATCHES);
+	/*! Stops and joins the producer thread */
+	virtual ~SpikePrefetcher();
+	/*! Appends the spikes of time step t to spikes. Steps have to be requested 
+	 * in increasing order; the spikes of skipped steps are discarded. */
+	void pop(AurynTime t, SpikeContainer * spikes);
+};
+
+#endif /*SPIKEPREFETCHER_H_*/
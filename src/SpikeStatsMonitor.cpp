@@ -0,0 +1,182 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SpikeStatsMonitor.h"
+
+SpikeStatsMonitor::SpikeStatsMonitor(SpikingGroup * source, string filename, AurynDouble interval, AurynDouble binsize) : Monitor(filename)
+{
+	init(source,filename,interval,binsize);
+}
+
+SpikeStatsMonitor::~SpikeStatsMonitor()
+{
+}
+
+void SpikeStatsMonitor::init(SpikingGroup * source, string filename, AurynDouble interval, AurynDouble binsize)
+{
+	src = source;
+	per_neuron = false;
+	if ( !src->evolve_locally() ) return;
+
+	sys->register_monitor(this);
+
+	bsize = max((AurynTime)(binsize/dt+0.5),(AurynTime)1);
+	// intervals consist of whole bins
+	isize = max((AurynTime)(interval/dt+0.5)/bsize,(AurynTime)1)*bsize;
+
+	SpikeStats empty;
+	memset(&empty,0,sizeof(empty));
+	stats.resize(src->get_rank_size(),empty);
+	t_start = sys->get_clock();
+	pop_bin = 0;
+	reset();
+
+	stringstream oss;
+	oss << "SpikeStatsMonitor:: Setting interval " << isize*dt << "s and binsize " << bsize*dt << "s";
+	logger->msg(oss.str(),NOTIFICATION);
+
+	outfile << setiosflags(ios::fixed) << setprecision(6);
+}
+
+void SpikeStatsMonitor::set_per_neuron(bool enable)
+{
+	per_neuron = enable;
+}
+
+void SpikeStatsMonitor::reset()
+{
+	for ( NeuronID i = 0 ; i < stats.size() ; ++i ) {
+		SpikeStats & s = stats[i];
+		s.count = 0;
+		s.isi_count = 0;
+		s.isi_sum = 0.0;
+		s.isi_sum2 = 0.0;
+		s.bin_sum2 = 0.0;
+		s.bin_count = 0;
+	}
+	nbins = 0;
+	pop_count = 0;
+	pop_sum = 0.0;
+	pop_sum2 = 0.0;
+}
+
+void SpikeStatsMonitor::propagate()
+{
+	const AurynTime now = sys->get_clock();
+	const AurynTime bin = now/bsize;
+
+	SpikeContainer * spikes = src->get_spikes_immediate();
+	if ( !spikes->empty() && pop_bin != bin ) {
+		pop_bin = bin;
+		pop_count = 0;
+	}
+	for ( SpikeContainer::const_iterator spike = spikes->begin() ; spike != spikes->end() ; ++spike ) {
+		SpikeStats & s = stats[src->global2rank(*spike)];
+		s.count++;
+		if ( s.has_spiked ) {
+			const AurynDouble isi = now-s.last_spike;
+			s.isi_count++;
+			s.isi_sum += isi;
+			s.isi_sum2 += isi*isi;
+		}
+		s.last_spike = now;
+		s.has_spiked = true;
+
+		// (c+1)^2 = c^2 + 2c + 1 updates the square sum of the bin counts per spike
+		if ( s.bin != bin ) {
+			s.bin = bin;
+			s.bin_count = 0;
+		}
+		s.bin_sum2 += 2*s.bin_count+1;
+		s.bin_count++;
+
+		pop_sum2 += 2*pop_count+1;
+		pop_count++;
+	}
+	pop_sum += spikes->size();
+
+	if ( (now+1)%bsize == 0 ) nbins++;
+	if ( (now+1)%isize == 0 ) {
+		write_stats();
+		t_start = now+1;
+		reset();
+	}
+}
+
+void SpikeStatsMonitor::write_stats()
+{
+	const AurynTime t_end = sys->get_clock()+1;
+	if ( nbins == 0 || t_end == t_start ) return;
+	const AurynDouble duration = dt*(t_end-t_start);
+
+	AurynDouble rate_sum = 0.0;
+	AurynDouble rate_sum2 = 0.0;
+	AurynDouble cv_sum = 0.0;
+	unsigned int cv_count = 0;
+	AurynDouble fano_sum = 0.0;
+	unsigned int fano_count = 0;
+	AurynDouble var_sum = 0.0;
+	for ( NeuronID i = 0 ; i < stats.size() ; ++i ) {
+		const SpikeStats & s = stats[i];
+		const AurynDouble rate = s.count/duration;
+		rate_sum += rate;
+		rate_sum2 += rate*rate;
+
+		AurynDouble cv = 0.0;
+		if ( s.isi_count > 1 ) {
+			const AurynDouble mean = s.isi_sum/s.isi_count;
+			const AurynDouble var = max(s.isi_sum2/s.isi_count-mean*mean,0.0);
+			cv = sqrt(var)/mean;
+			cv_sum += cv;
+			cv_count++;
+		}
+
+		const AurynDouble mean = 1.0*s.count/nbins;
+		const AurynDouble var = max(s.bin_sum2/nbins-mean*mean,0.0);
+		var_sum += var;
+		AurynDouble fano = 0.0;
+		if ( s.count > 0 ) {
+			fano = var/mean;
+			fano_sum += fano;
+			fano_count++;
+		}
+
+		if ( per_neuron ) 
+			outfile << dt*t_end << " " << src->rank2global(i) << " " 
+				<< rate << " " << cv << " " << fano << "\n";
+	}
+	if ( per_neuron || stats.empty() ) return;
+
+	const NeuronID n = stats.size();
+	const AurynDouble rate_mean = rate_sum/n;
+	const AurynDouble rate_std = sqrt(max(rate_sum2/n-rate_mean*rate_mean,0.0));
+
+	// Golomb's chi with the population activity averaged over neurons
+	const AurynDouble pop_mean = pop_sum/nbins;
+	const AurynDouble pop_var = max(pop_sum2/nbins-pop_mean*pop_mean,0.0)/n/n;
+	AurynDouble synchrony = 0.0;
+	if ( var_sum > 0.0 ) 
+		synchrony = sqrt(pop_var/(var_sum/n));
+
+	outfile << dt*t_end << " " << rate_mean << " " << rate_std << " " 
+		<< (cv_count?cv_sum/cv_count:0.0) << " " 
+		<< (fano_count?fano_sum/fano_count:0.0) << " " 
+		<< synchrony << " " << cv_count << "\n";
+}
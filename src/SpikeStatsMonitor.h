@@ -0,0 +1,121 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPIKESTATSMONITOR_H_
+#define SPIKESTATSMONITOR_H_
+
+#include "auryn_definitions.h"
+#include "Monitor.h"
+#include "System.h"
+#include "SpikingGroup.h"
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+/*! \brief Running spike statistics of a single neuron */
+struct SpikeStats
+{
+	/*! Spikes in the current interval */
+	unsigned int count;
+	/*! Number of ISIs in the current interval */
+	unsigned int isi_count;
+	AurynDouble isi_sum;
+	AurynDouble isi_sum2;
+	/*! Sum of squared spike counts of the bins in the current interval */
+	AurynDouble bin_sum2;
+	/*! Spike count in the bin of the last spike */
+	unsigned int bin_count;
+	/*! Bin of the last spike */
+	AurynTime bin;
+	AurynTime last_spike;
+	bool has_spiked;
+};
+
+/*! \brief Monitor computing firing rates, ISI CV, Fano factors and population 
+ * synchrony online
+ *
+ * Instead of recording a raster, SpikeStatsMonitor accumulates per neuron 
+ * the spike count, the sum and square sum of the interspike intervals and 
+ * the square sum of the spike counts in bins of binsize. This takes constant 
+ * memory and work per spike. Every interval seconds it writes a line
+ *
+ *   time  mean rate  std of rates  mean CV  mean Fano factor  synchrony  n_cv
+ *
+ * where the CV is averaged over the n_cv neurons with at least two ISIs and 
+ * the Fano factor over the neurons which spiked in the interval. Synchrony 
+ * is the index chi of Golomb (2007): the standard deviation of the binned 
+ * population activity normalized by the root mean variance of the binned 
+ * activity of single neurons. It is close to 1/sqrt(N) for independent 
+ * neurons and 1 for full synchrony. ISIs which span two intervals count 
+ * in the later one.
+ *
+ * With set_per_neuron(true) the monitor writes one line 
+ *
+ *   time  neuron  rate  CV  Fano factor 
+ *
+ * per neuron instead. As PopulationRateMonitor each rank computes the 
+ * statistics of its own neurons and writes them to its own file. 
+ * A partial interval at the end of a run is not written.
+ */
+class SpikeStatsMonitor : protected Monitor
+{
+private:
+	vector<SpikeStats> stats;
+	/*! Interval in units of AurynTime */
+	AurynTime isize;
+	/*! Binsize in units of AurynTime */
+	AurynTime bsize;
+	/*! Start of the current interval */
+	AurynTime t_start;
+	/*! Number of completed bins in the current interval */
+	unsigned int nbins;
+	/*! Population statistics of the binned activity */
+	unsigned int pop_count;
+	AurynTime pop_bin;
+	AurynDouble pop_sum;
+	AurynDouble pop_sum2;
+	bool per_neuron;
+
+	void reset();
+	void write_stats();
+
+protected:
+	/*! The source SpikingGroup */
+	SpikingGroup * src;
+	/*! Default init method */
+	void init(SpikingGroup * source, string filename, AurynDouble interval, AurynDouble binsize);
+	
+public:
+	/*! Default Constructor 
+	 @param[source] The source spiking group.
+	 @param[filename] The filename to write to (should be different for each rank.)
+	 @param[interval] The interval between two summaries in seconds.
+	 @param[binsize] The binsize for the Fano factors and the synchrony index in seconds.*/
+	SpikeStatsMonitor(SpikingGroup * source, string filename, AurynDouble interval=10., AurynDouble binsize=50e-3);
+	/*! Default Destructor */
+	virtual ~SpikeStatsMonitor();
+	/*! Toggles between population summaries and per neuron statistics */
+	void set_per_neuron(bool enable);
+	/*! Implementation of necessary propagate() function. */
+	void propagate();
+};
+
+#endif /*SPIKESTATSMONITOR_H_*/
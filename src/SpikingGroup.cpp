@@ -31,6 +31,8 @@ vector<mpi::request> SpikingGroup::reqs;
 
 NeuronID SpikingGroup::anticipated_total = 0;
 
+unsigned int SpikingGroup::subsampling_phase_count = 0;
+
 
 
 SpikingGroup::SpikingGroup(NeuronID n, double loadmultiplier, NeuronID total ) 
@@ -47,6 +49,7 @@ void SpikingGroup::init(NeuronID n, double loadmultiplier, NeuronID total )
 {
 	group_name = "SpikingGroup";
 	unique_id  = unique_id_count++;
+	comm_rank = communicator->rank();
 	size = n;
 	effective_load_multiplier = loadmultiplier;
 
@@ -86,6 +89,18 @@ void SpikingGroup::init(NeuronID n, double loadmultiplier, NeuronID total )
 	delay = new SpikeDelay( );
 	set_delay(MINDELAY+1); 
 
+	post_trace_bank = NULL;
+	slow_post_trace_bank = NULL;
+#ifndef PRE_TRACE_MODEL_LINTRACE
+	pre_trace_bank = NULL;
+	slow_pre_trace_bank = NULL;
+#endif
+	trace_subsampling = 1;
+	trace_subsampling_tau = 1.0;
+
+	state_arena = NULL;
+	quiescent_until = 0;
+
 	evolve_locally_bool = evolve_locally_bool && ( get_rank_size() > 0 );
 }
 
@@ -148,13 +163,16 @@ void SpikingGroup::free()
 		delete pretraces[i];
 	for ( NeuronID i = 0 ; i < posttraces.size() ; ++i )
 		delete posttraces[i];
+	delete post_trace_bank;
+	delete slow_post_trace_bank;
+#ifndef PRE_TRACE_MODEL_LINTRACE
+	delete pre_trace_bank;
+	delete slow_pre_trace_bank;
+#endif
 
-	for ( map<string,gsl_vector_float *>::const_iterator iter = state_vector.begin() ; 
-			iter != state_vector.end() ;
-			++iter ) {
-		gsl_vector_float_free ( iter->second );
-	}
+	// the state vectors are views into the arena which frees them
 	state_vector.clear();
+	delete state_arena;
 
 }
 
@@ -176,11 +194,38 @@ void SpikingGroup::conditional_evolve()
 	spikes->clear();
 	attribs = get_attributes_immediate(); 
 	attribs->clear();
-	if ( evolve_locally() ) {
+	if ( evolve_locally() && !is_quiescent() ) {
 		evolve();
+		if ( *clock_ptr%MINDELAY == 0 && at_rest() ) 
+			sleep();
 	}
 }
 
+bool SpikingGroup::is_quiescent()
+{
+	return *clock_ptr < quiescent_until;
+}
+
+void SpikingGroup::sleep_until( AurynTime t )
+{
+	quiescent_until = t;
+}
+
+void SpikingGroup::sleep()
+{
+	quiescent_until = std::numeric_limits<AurynTime>::max();
+}
+
+void SpikingGroup::wake()
+{
+	quiescent_until = 0;
+}
+
+bool SpikingGroup::at_rest()
+{
+	return false;
+}
+
 SpikeContainer * SpikingGroup::get_spikes()
 {
 	return delay->get_spikes();
@@ -211,6 +256,12 @@ void SpikingGroup::push_spike(NeuronID spike)
 	spikes->push_back(rank2global(spike));
 }
 
+void SpikingGroup::push_spikes(SpikeContainer * units) 
+{
+	for ( SpikeContainer::const_iterator i = units->begin() ; i != units->end() ; ++i ) 
+		spikes->push_back(rank2global(*i));
+}
+
 void SpikingGroup::push_attribute(AurynFloat attrib) 
 {
 	attribs->push_back(attrib);
@@ -262,7 +313,7 @@ AurynDouble SpikingGroup::get_effective_load()
 
 
 NeuronID SpikingGroup::rank2global(NeuronID i) {
-	return i*locked_range+(communicator->rank()-locked_rank);
+	return i*locked_range+(comm_rank-locked_rank);
 }
 
 bool SpikingGroup::evolve_locally()
@@ -314,6 +365,7 @@ PRE_TRACE_MODEL * SpikingGroup::get_pre_trace( AurynFloat x )
 
 #ifndef PRE_TRACE_MODEL_LINTRACE
 	DEFAULT_TRACE_MODEL * tmp = new DEFAULT_TRACE_MODEL(get_pre_size(),x);
+	select_trace_bank( &pre_trace_bank, &slow_pre_trace_bank, get_pre_size(), x )->add(tmp);
 #else
 	PRE_TRACE_MODEL * tmp = new PRE_TRACE_MODEL(get_pre_size(),x,clock_ptr);
 #endif
@@ -334,32 +386,88 @@ DEFAULT_TRACE_MODEL * SpikingGroup::get_post_trace( AurynFloat x )
 
 
 	DEFAULT_TRACE_MODEL * tmp = new DEFAULT_TRACE_MODEL(get_post_size(),x);
+	select_trace_bank( &post_trace_bank, &slow_post_trace_bank, get_post_size(), x )->add(tmp);
 	posttraces.push_back(tmp);
 	return tmp;
 }
 
-void SpikingGroup::evolve_traces()
+EulerTraceBank * SpikingGroup::select_trace_bank( EulerTraceBank ** bank, EulerTraceBank ** slow_bank, NeuronID n, AurynFloat tau )
+{
+	if ( trace_subsampling > 1 && tau >= trace_subsampling_tau ) {
+		if ( *slow_bank == NULL ) {
+			*slow_bank = new EulerTraceBank(n, trace_subsampling, next_subsampling_phase(trace_subsampling));
+			stringstream oss;
+			oss << get_name() << ":: Integrating traces with tau >= " << trace_subsampling_tau 
+				<< "s every " << trace_subsampling << " time steps";
+			logger->msg(oss.str(),NOTIFICATION);
+		}
+		return *slow_bank;
+	}
+	if ( *bank == NULL ) 
+		*bank = new EulerTraceBank(n);
+	return *bank;
+}
+
+unsigned int SpikingGroup::next_subsampling_phase( unsigned int k )
+{
+	if ( k <= 1 ) return 0;
+	return (subsampling_phase_count++)%k;
+}
+
+void SpikingGroup::set_trace_subsampling( unsigned int k, AurynFloat tau_min )
 {
+	trace_subsampling = max(k,1u);
+	trace_subsampling_tau = tau_min;
+}
 
+void SpikingGroup::evolve_traces()
+{
+#ifndef PRE_TRACE_MODEL_LINTRACE
+	if ( pre_trace_bank != NULL ) {
+		for (SpikeContainer::const_iterator spike = get_spikes()->begin() ; // spike = pre_spike
+				spike != get_spikes()->end() ; 
+				++spike ) {
+			pre_trace_bank->inc(*spike);
+		}
+		pre_trace_bank->evolve();
+	}
+	if ( slow_pre_trace_bank != NULL ) {
+		for (SpikeContainer::const_iterator spike = get_spikes()->begin() ; 
+				spike != get_spikes()->end() ; 
+				++spike ) {
+			slow_pre_trace_bank->inc(*spike);
+		}
+		slow_pre_trace_bank->evolve();
+	}
+#else
 	for ( NeuronID i = 0 ; i < pretraces.size() ; i++ ) { // loop over all traces 
 		for (SpikeContainer::const_iterator spike = get_spikes()->begin() ; // spike = pre_spike
 				spike != get_spikes()->end() ; 
 				++spike ) {
-			// cout << " bar " << *spike << endl;
 			pretraces[i]->inc(*spike);
 		}
 		pretraces[i]->evolve();
 	}
+#endif
 
-	for ( NeuronID i = 0 ; i < posttraces.size() ; i++ ) {
+	// all posttraces are incremented and decayed together in the bank
+	if ( post_trace_bank != NULL ) {
 		for (SpikeContainer::const_iterator spike = get_spikes_immediate()->begin() ; 
 				spike != get_spikes_immediate()->end() ; 
 				++spike ) {
 			NeuronID translated_spike = global2rank(*spike); // only to be used for post traces
-			// cout << " foo " << translated_spike << endl;
-			posttraces[i]->inc(translated_spike);
+			post_trace_bank->inc(translated_spike);
+		}
+		post_trace_bank->evolve();
+	}
+
+	if ( slow_post_trace_bank != NULL ) {
+		for (SpikeContainer::const_iterator spike = get_spikes_immediate()->begin() ; 
+				spike != get_spikes_immediate()->end() ; 
+				++spike ) {
+			slow_post_trace_bank->inc(global2rank(*spike));
 		}
-		posttraces[i]->evolve();
+		slow_post_trace_bank->evolve();
 	}
 }
 
@@ -374,9 +482,10 @@ string SpikingGroup::get_name()
 }
 
 bool SpikingGroup::localrank(NeuronID i) {
-	bool t = ( (i-communicator->rank()+locked_rank)%locked_range==0 )
-		 && (int) communicator->rank() >= locked_rank
-		 && (int) communicator->rank() < (locked_rank+locked_range)
+	// compare residues since i-comm_rank wraps around for unsigned i
+	bool t = comm_rank >= locked_rank
+		 && comm_rank < (locked_rank+locked_range)
+		 && i%locked_range == (NeuronID)(comm_rank-locked_rank)
 		 && i < get_size(); // TODO what if I remove the last condition ?
 	return t; 
 }
@@ -467,7 +576,9 @@ bool SpikingGroup::load_from_file(const char * filename)
 gsl_vector_float * SpikingGroup::get_state_vector(string key)
 {
 	if ( state_vector.find(key) == state_vector.end() ) {
-		gsl_vector_float * vec = gsl_vector_float_alloc (get_vector_size()); 
+		if ( state_arena == NULL ) 
+			state_arena = new StateArena(get_vector_size());
+		gsl_vector_float * vec = state_arena->allocate_vector(); 
 		state_vector[key] = vec;
 		return vec;
 	} else {
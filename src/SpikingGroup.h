@@ -26,6 +26,8 @@
 #include "SpikeDelay.h"
 #include "EulerTrace.h"
 #include "LinearTrace.h"
+#include "EulerTraceBank.h"
+#include "StateArena.h"
 
 #include <boost/archive/text_oarchive.hpp> 
 #include <boost/archive/text_iarchive.hpp> 
@@ -69,6 +71,9 @@ private:
 	unsigned int locked_range;
 	/*! Keeps track on where rank-locking is */
 	static int last_locked_rank;
+	/*! MPI rank of this process, cached such that localrank and rank2global
+	 * do not call MPI and can be used from producer threads */
+	int comm_rank;
 
 	bool evolve_locally_bool;
 	inline int msgtag(int x, int y);
@@ -79,6 +84,16 @@ private:
 	/*! Stores axonal delay value - by default MINDELAY */
 	int axonaldelay;
 
+	/*! Counts sub-sampled components of all groups to stagger their updates */
+	static unsigned int subsampling_phase_count;
+	/*! Sub-sampling factor for slow traces */
+	unsigned int trace_subsampling;
+	/*! Traces with time constants of at least this value are sub-sampled */
+	AurynFloat trace_subsampling_tau;
+	/*! Returns the bank a new trace with time constant tau is stored in. 
+	 * Creates the bank if it does not exist yet. */
+	EulerTraceBank * select_trace_bank( EulerTraceBank ** bank, EulerTraceBank ** slow_bank, NeuronID n, AurynFloat tau );
+
 protected:
 	/*! Pretraces */
 	vector<PRE_TRACE_MODEL *> pretraces;
@@ -86,6 +101,41 @@ protected:
 	/*! Posttraces */
 	vector<DEFAULT_TRACE_MODEL *> posttraces;
 
+	/*! Holds the states of all posttraces in a single block to evolve them in one pass */
+	EulerTraceBank * post_trace_bank;
+
+	/*! Holds the states of slow posttraces which are only updated every few time steps */
+	EulerTraceBank * slow_post_trace_bank;
+
+#ifndef PRE_TRACE_MODEL_LINTRACE
+	/*! Holds the states of all pretraces in a single block to evolve them in one pass */
+	EulerTraceBank * pre_trace_bank;
+	/*! Holds the states of slow pretraces which are only updated every few time steps */
+	EulerTraceBank * slow_pre_trace_bank;
+#endif
+
+	/*! Returns the time step offset at which a component sub-sampled by 
+	 * factor k should be updated such that updates are spread evenly */
+	static unsigned int next_subsampling_phase( unsigned int k );
+
+	/*! Time step before which evolve() is not called unless the group is woken */
+	AurynTime quiescent_until;
+
+	/*! Tells System that the group has nothing to do before time step t. 
+	 * System skips evolve() until then unless the group receives spikes 
+	 * or is woken up otherwise. Skipped steps must not change the state
+	 * of the group, e.g. no spikes are due and no state variable decays. */
+	void sleep_until( AurynTime t );
+
+	/*! Tells System that the group has nothing to do until it receives spikes
+	 * or is woken up otherwise. */
+	void sleep();
+
+	/*! Returns true if the group can sleep until it receives input. Polled 
+	 * every MINDELAY steps after evolve(). The default implementation 
+	 * returns false. */
+	virtual bool at_rest();
+
 	/*! Identifying name for object */
 	string group_name;
 
@@ -107,6 +157,9 @@ protected:
 public:
 	SpikeDelay * delay;
 
+	/*! Aligned memory from which all state vectors of this group are allocated */
+	StateArena * state_arena;
+
 	/*! Can hold single neuron vectors such as target rates or STP states etc  */
 	map<string,gsl_vector_float *> state_vector;
 
@@ -130,7 +183,14 @@ public:
 	/*! Frees potentially allocated memory */
 	void free();
 	virtual void evolve() = 0;
+	/*! Calls evolve() if the group exists on this rank and is not quiescent. */
 	void conditional_evolve();
+	/*! Returns true if evolve() is currently skipped */
+	bool is_quiescent();
+	/*! Makes the group evolve again from the current time step on. Connections
+	 * wake their target when they transmit spikes. Call this after changing
+	 * the state of a quiescent group from outside. */
+	void wake();
 	unsigned int get_locked_rank();
 	unsigned int get_locked_range();
 	SpikeContainer * get_spikes();
@@ -173,6 +233,9 @@ public:
 
 	void push_spike(NeuronID spike);
 
+	/*! Pushes the rank local units in container as spikes in one go */
+	void push_spikes(SpikeContainer * units);
+
 	void push_attribute(AurynFloat attrib);
 
 	/*! Clear all spikes stored in the delays which is useful to reset a network during runtime */
@@ -181,6 +244,11 @@ public:
 	/*! Sets axonal delay for this SpikingGroup */
 	void set_delay( int d );
 
+	/*! Integrates traces with time constants of at least tau_min only every k 
+	 * time steps with the exact decay over k*dt. Only affects traces which are 
+	 * created after the call, i.e. call before setting up connections. */
+	void set_trace_subsampling( unsigned int k, AurynFloat tau_min = 1.0 );
+
 	virtual bool write_to_file(const char * filename);
 	virtual bool load_from_file(const char * filename);
 
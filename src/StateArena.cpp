@@ -0,0 +1,119 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StateArena.h"
+#include <cstring>
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE 2097152 //!< Size of a transparent huge page on x86-64
+
+void StateArena::init(NeuronID n, NeuronID vectors_per_block)
+{
+	vector_size = n;
+	// array sizes are rounded up to keep every array aligned
+	const size_t stride = SIMD_MEMORY_ALIGNMENT*((vector_size*sizeof(float)+SIMD_MEMORY_ALIGNMENT-1)/SIMD_MEMORY_ALIGNMENT);
+	block_size = vectors_per_block*stride;
+	if ( block_size == 0 ) 
+		block_size = SIMD_MEMORY_ALIGNMENT;
+	block_capacity = 0;
+	block_used = 0;
+	reserved_bytes = 0;
+}
+
+void StateArena::free()
+{
+	for ( NeuronID i = 0 ; i < views.size() ; ++i ) 
+		::free( views[i] );
+	views.clear();
+	for ( NeuronID i = 0 ; i < blocks.size() ; ++i ) 
+		::free( blocks[i] );
+	blocks.clear();
+}
+
+StateArena::StateArena(NeuronID n, NeuronID vectors_per_block)
+{
+	init(n, vectors_per_block);
+}
+
+StateArena::~StateArena()
+{
+	free();
+}
+
+void StateArena::add_block(size_t n)
+{
+	size_t bytes = max(n,block_size);
+	size_t alignment = SIMD_MEMORY_ALIGNMENT;
+#if defined(CODE_USE_HUGE_PAGES_FOR_STATE) && defined(MADV_HUGEPAGE)
+	if ( bytes >= HUGE_PAGE_SIZE ) {
+		alignment = HUGE_PAGE_SIZE;
+		bytes = HUGE_PAGE_SIZE*((bytes+HUGE_PAGE_SIZE-1)/HUGE_PAGE_SIZE);
+	}
+#endif
+
+	void * block = NULL;
+	if ( posix_memalign( &block, alignment, bytes ) ) 
+		throw AurynMemoryAlignmentException();
+
+#if defined(CODE_USE_HUGE_PAGES_FOR_STATE) && defined(MADV_HUGEPAGE)
+	if ( alignment == HUGE_PAGE_SIZE ) 
+		madvise( block, bytes, MADV_HUGEPAGE ); // only a hint, failure is harmless
+#endif
+
+	blocks.push_back( (char *) block );
+	block_capacity = bytes; // block_size stays for the following blocks
+	block_used = 0;
+	reserved_bytes += bytes;
+}
+
+void * StateArena::allocate_bytes(size_t n)
+{
+	const size_t bytes = SIMD_MEMORY_ALIGNMENT*((n+SIMD_MEMORY_ALIGNMENT-1)/SIMD_MEMORY_ALIGNMENT);
+	if ( blocks.empty() || block_used+bytes > block_capacity ) 
+		add_block(bytes);
+	char * ptr = blocks.back()+block_used;
+	block_used += bytes;
+	memset( ptr, 0, bytes ); // first touch by the owning rank
+	return ptr;
+}
+
+gsl_vector_float * StateArena::allocate_vector()
+{
+	gsl_vector_float * view = (gsl_vector_float *) malloc( sizeof(gsl_vector_float) );
+	if ( view == NULL ) 
+		throw AurynMemoryAlignmentException();
+	view->size = vector_size;
+	view->stride = 1;
+	view->data = allocate<float>();
+	view->block = NULL;
+	view->owner = 0;
+	views.push_back(view);
+	return view;
+}
+
+NeuronID StateArena::get_vector_size()
+{
+	return vector_size;
+}
+
+size_t StateArena::get_reserved_bytes()
+{
+	return reserved_bytes;
+}
@@ -0,0 +1,92 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STATEARENA_H_
+#define STATEARENA_H_
+
+#include "auryn_definitions.h"
+#include <vector>
+#include <gsl/gsl_vector_float.h>
+
+using namespace std;
+
+/*! \brief Allocates the per-neuron state arrays of a group from a few large aligned memory blocks.
+ *
+ * Instead of allocating each state vector on its own, a group draws all of them from its arena. 
+ * Each array starts on a SIMD_MEMORY_ALIGNMENT byte boundary and occupies get_vector_size() elements,
+ * so the arrays of one group are laid out back to back in memory. Blocks hold a given number of
+ * vectors and further blocks are added on demand, such that pointers handed out remain valid.
+ * Arrays are zeroed upon allocation. Since each rank integrates its groups in a single thread this 
+ * first touch places the pages on the NUMA node of the owning rank. Large blocks are aligned to 
+ * huge pages and marked for transparent huge page backing if CODE_USE_HUGE_PAGES_FOR_STATE is set.
+ * allocate() returns typed arrays. allocate_vector() wraps a float array in a gsl_vector_float view 
+ * for the existing vector code. All memory, including the views, is owned and freed by the arena.
+ */
+class StateArena
+{
+private:
+	/*! The number of elements of each array. */
+	NeuronID vector_size;
+	/*! The size of a regular block in bytes. */
+	size_t block_size;
+	/*! The size of the current block in bytes, which exceeds block_size for oversized requests. */
+	size_t block_capacity;
+	/*! The bytes used in the current block. */
+	size_t block_used;
+	/*! The bytes reserved in all blocks. */
+	size_t reserved_bytes;
+	/*! The memory blocks. */
+	vector<char *> blocks;
+	/*! The GSL views handed out by allocate_vector(). */
+	vector<gsl_vector_float *> views;
+
+	void init(NeuronID n, NeuronID vectors_per_block);
+	void free();
+	/*! Returns n zeroed and aligned bytes from the current block and adds a new block if needed. */
+	void * allocate_bytes(size_t n);
+	/*! Allocates a new memory block of at least n bytes. */
+	void add_block(size_t n);
+
+public:
+	/*! Default constructor 
+	 * \param n number of elements of each state array (usually the SIMD padded rank size) 
+	 * \param vectors_per_block number of float arrays that fit into one memory block */
+	StateArena(NeuronID n, NeuronID vectors_per_block = 16);
+	/*! Default destructor */
+	virtual ~StateArena();
+
+	/*! Returns a zeroed and aligned array of get_vector_size() elements of type T. */
+	template <typename T> T * allocate() 
+	{
+		return (T *) allocate_bytes( vector_size*sizeof(T) );
+	}
+
+	/*! Returns a zeroed and aligned float array wrapped in a gsl_vector_float view. 
+	 * The view must not be freed with gsl_vector_float_free. */
+	gsl_vector_float * allocate_vector();
+
+	/*! Returns the number of elements of each state array */
+	NeuronID get_vector_size();
+
+	/*! Returns the number of bytes reserved by the arena */
+	size_t get_reserved_bytes();
+};
+
+#endif /*STATEARENA_H_*/
@@ -0,0 +1,182 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StateRecorder.h"
+
+StateRecorder::StateRecorder(SpikingGroup * source, string filename, AurynTime stepsize) 
+	: Monitor()
+{
+	init(source,stepsize);
+	if ( !src->evolve_locally() ) return; // nothing to record on this rank
+	fname = filename;
+	writer = new AsyncFileWriter(filename);
+	sys->register_monitor(this);
+}
+
+StateRecorder::StateRecorder(SpikingGroup * source, OutputContainer * out, string streamname, AurynTime stepsize) 
+	: Monitor()
+{
+	init(source,stepsize);
+	if ( !src->evolve_locally() ) return; 
+	fname = streamname;
+	container = out;
+	stream_name = streamname;
+	sys->register_monitor(this);
+}
+
+StateRecorder::~StateRecorder()
+{
+	free();
+}
+
+void StateRecorder::init(SpikingGroup * source, AurynTime step)
+{
+	src = source;
+	writer = NULL;
+	container = NULL;
+	stream = 0;
+	stepsize = max(step,(AurynTime)1);
+	header_written = false;
+}
+
+void StateRecorder::free()
+{
+	if ( writer == NULL ) return; // the container is closed by its owner
+	if ( !header_written ) write_header(); // leave a valid file without samples
+	writer->close();
+	delete writer;
+}
+
+bool StateRecorder::check_open()
+{
+	if ( header_written ) {
+		logger->msg("StateRecorder:: States and neurons can't be added after recording started.",WARNING);
+		return false;
+	}
+	return writer != NULL || container != NULL;
+}
+
+void StateRecorder::add_state(string statename)
+{
+	if ( !check_open() ) return;
+	state_names.push_back(statename);
+	states.push_back(src->get_state_vector(statename));
+}
+
+void StateRecorder::add_neuron(NeuronID id)
+{
+	if ( !check_open() || id >= src->get_size() || !src->localrank(id) ) return;
+	neurons.push_back(id);
+}
+
+void StateRecorder::add_neurons(NeuronID from, NeuronID to)
+{
+	for ( NeuronID i = from ; i < to ; ++i ) 
+		add_neuron(i);
+}
+
+void StateRecorder::add_neurons(vector<NeuronID> ids)
+{
+	for ( unsigned int k = 0 ; k < ids.size() ; ++k ) 
+		add_neuron(ids[k]);
+}
+
+void StateRecorder::write_header()
+{
+	if ( neurons.empty() ) 
+		add_neurons(0,src->get_size());
+	header_written = true;
+
+	// group consecutive rank indices to copy them as blocks
+	runs.clear();
+	for ( unsigned int k = 0 ; k < neurons.size() ; ++k ) {
+		const NeuronID i = src->global2rank(neurons[k]);
+		if ( !runs.empty() && runs.back().first+runs.back().second == i ) 
+			runs.back().second++;
+		else
+			runs.push_back(make_pair(i,(NeuronID)1));
+	}
+
+	// names and neuron IDs are the file header or the stream metadata
+	vector<char> names(state_names.size()*STATERECORDER_NAME_LENGTH,0);
+	for ( unsigned int s = 0 ; s < state_names.size() ; ++s ) 
+		strncpy(&names[s*STATERECORDER_NAME_LENGTH],state_names[s].c_str(),STATERECORDER_NAME_LENGTH-1);
+
+	if ( container != NULL ) {
+		vector<char> meta(names);
+		if ( !neurons.empty() ) 
+			meta.insert(meta.end(),(const char*)&neurons[0],(const char*)&neurons[0]+neurons.size()*sizeof(NeuronID));
+		stream = container->add_stream(stream_name,CONTAINER_STATES,states.size()*neurons.size(),
+				meta.empty()?NULL:&meta[0],meta.size());
+		sample.resize(states.size()*neurons.size());
+	} else {
+		StateRecorderHeader header;
+		header.magic = STATERECORDER_MAGIC;
+		header.version = STATERECORDER_VERSION;
+		header.dt = dt;
+		header.stepsize = stepsize;
+		header.num_states = states.size();
+		header.num_neurons = neurons.size();
+		writer->write(&header,sizeof(header));
+		if ( !names.empty() ) 
+			writer->write(&names[0],names.size());
+		if ( !neurons.empty() ) 
+			writer->write(&neurons[0],neurons.size()*sizeof(NeuronID));
+	}
+
+	stringstream oss;
+	oss << "StateRecorder:: Recording " << states.size() << " states of " 
+		<< neurons.size() << " neurons in " << runs.size() << " blocks to " << fname;
+	logger->msg(oss.str(),NOTIFICATION);
+}
+
+void StateRecorder::propagate()
+{
+	const AurynTime now = sys->get_clock();
+	if ( now%stepsize != 0 ) return;
+	if ( !header_written ) write_header();
+
+	if ( container != NULL ) {
+		if ( sample.empty() ) return;
+		AurynState * values = &sample[0];
+		for ( unsigned int s = 0 ; s < states.size() ; ++s ) {
+			const AurynState * data = states[s]->data;
+			for ( unsigned int r = 0 ; r < runs.size() ; ++r ) {
+				memcpy(values,data+runs[r].first,runs[r].second*sizeof(AurynState));
+				values += runs[r].second;
+			}
+		}
+		container->append(stream,now,&sample[0]);
+		return;
+	}
+
+	writer->write(&now,sizeof(now));
+	for ( unsigned int s = 0 ; s < states.size() ; ++s ) {
+		const AurynState * data = states[s]->data;
+		for ( unsigned int r = 0 ; r < runs.size() ; ++r ) 
+			writer->write(data+runs[r].first,runs[r].second*sizeof(AurynState));
+	}
+}
+
+void StateRecorder::flush()
+{
+	if ( writer != NULL ) writer->flush();
+	if ( container != NULL ) container->flush();
+}
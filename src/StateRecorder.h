@@ -0,0 +1,118 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STATERECORDER_H_
+#define STATERECORDER_H_
+
+#include "auryn_definitions.h"
+#include "Monitor.h"
+#include "System.h"
+#include "SpikingGroup.h"
+#include "AsyncFileWriter.h"
+#include "OutputContainer.h"
+
+#include <vector>
+#include <string>
+#include <boost/cstdint.hpp>
+
+#define STATERECORDER_MAGIC 0x43455253 //!< "SREC" in little endian
+#define STATERECORDER_VERSION 1
+#define STATERECORDER_NAME_LENGTH 32 //!< Bytes per state name in the file header
+
+using namespace std;
+
+/*! \brief Header at the beginning of a StateRecorder file */
+struct StateRecorderHeader
+{
+	boost::uint32_t magic;
+	boost::uint32_t version;
+	/*! Length of a time step in seconds */
+	AurynFloat dt;
+	/*! Sampling interval in time steps */
+	AurynTime stepsize;
+	boost::uint32_t num_states;
+	boost::uint32_t num_neurons;
+};
+
+/*! \brief Records a set of state variables of many neurons into one binary file
+ *
+ * Replaces large numbers of StateMonitor or VoltageMonitor instances. The 
+ * recorder samples the state vectors added with add_state() for the neurons
+ * added with add_neuron() or add_neurons() every stepsize time steps. If no 
+ * neurons are added all neurons are recorded. Contiguous runs of neurons are
+ * copied as blocks and the data is written by a background thread (see 
+ * AsyncFileWriter).
+ *
+ * Each rank records the neurons it simulates, so filename should differ 
+ * between ranks. The file starts with a StateRecorderHeader, followed by 
+ * num_states names of STATERECORDER_NAME_LENGTH bytes and the num_neurons 
+ * global neuron IDs. Then one record per sample follows: the time step 
+ * (AurynTime) and num_states*num_neurons AurynState values, ordered by state
+ * and within each state by neuron as listed in the header. Every column is 
+ * thus at a fixed offset in each record. States and neurons have to be added
+ * before the first sample is written.
+ *
+ * Alternatively the samples can be written as a stream of an 
+ * OutputContainer. Its records hold the same values and its metadata the 
+ * state names and neuron IDs as they follow the header in the file.
+ */
+class StateRecorder : protected Monitor
+{
+private:
+	SpikingGroup * src;
+	AsyncFileWriter * writer;
+	OutputContainer * container;
+	string stream_name;
+	unsigned int stream;
+	/*! Values of one sample for the container */
+	vector<AurynState> sample;
+	AurynTime stepsize;
+	vector<string> state_names;
+	vector<gsl_vector_float *> states;
+	/*! Global IDs of the recorded neurons on this rank */
+	vector<NeuronID> neurons;
+	/*! Contiguous runs of recorded neurons as pairs of rank index and length */
+	vector< pair<NeuronID,NeuronID> > runs;
+	bool header_written;
+
+	void init(SpikingGroup * source, AurynTime stepsize);
+	void free();
+	bool check_open();
+	void write_header();
+	
+public:
+	/*! Records from source into filename every stepsize time steps */
+	StateRecorder(SpikingGroup * source, string filename, AurynTime stepsize=1);
+	/*! Records from source into the stream streamname of container every stepsize time steps */
+	StateRecorder(SpikingGroup * source, OutputContainer * container, string streamname, AurynTime stepsize=1);
+	virtual ~StateRecorder();
+	/*! Adds a state vector of the source group, e.g. "mem" */
+	void add_state(string statename);
+	/*! Adds neuron id (global ID) if it is simulated on this rank */
+	void add_neuron(NeuronID id);
+	/*! Adds the neurons from to to-1 */
+	void add_neurons(NeuronID from, NeuronID to);
+	/*! Adds a list of neurons */
+	void add_neurons(vector<NeuronID> ids);
+	void propagate();
+	virtual void flush();
+};
+
+#endif /*STATERECORDER_H_*/
@@ -20,17 +20,37 @@
 
 #include "StimulusGroup.h"
 
-boost::mt19937 StimulusGroup::poisson_gen = boost::mt19937(); 
-boost::mt19937 StimulusGroup::order_gen = boost::mt19937(2351301); 
-boost::uniform_01<boost::mt19937> StimulusGroup::order_die = boost::uniform_01<boost::mt19937> (order_gen);
+unsigned int StimulusGroup::num_instances = 0;
 
 void StimulusGroup::init(string filename, StimulusGroupModeType stimulusmode, string outputfile, AurynFloat baserate)
 {
+	prefetcher = NULL;
+	prefetching = false;
 	sys->register_spiking_group(this);
+	pthread_mutex_init(&tiser_mutex,NULL);
+	producer_time = 0;
 	ttl = new AurynTime [get_rank_size()];
+	schedule_count = new unsigned int [get_rank_size()];
+	active_index = new int [get_rank_size()];
 	activity = new AurynFloat [get_rank_size()];
+	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) {
+		ttl[i] = 0;
+		schedule_count[i] = 0;
+		active_index[i] = -1;
+		activity[i] = 0.0;
+	}
+	wheel.resize(STIMULUSGROUP_WHEEL_SIZE);
+	wheel_time = sys->get_clock();
+
+	// independent streams such that later instances don't restart earlier 
+	// ones, the stimulus order stays the same on all ranks
+	poisson_gen.seed(162346*communicator->rank()+1000003*num_instances);
+	order_gen.seed(2351301+1000003*num_instances);
+	order_die.base().seed(2351301+1000003*num_instances);
+	++num_instances;
+	poisson_die = new boost::variate_generator<boost::mt19937&, boost::exponential_distribution<> > 
+		( poisson_gen, boost::exponential_distribution<>(BASERATE) );
 	set_baserate(baserate);
-	poisson_gen.seed(162346*communicator->rank());
 	
 
 	mean_off_period = 1.0 ;
@@ -38,7 +58,7 @@ void StimulusGroup::init(string filename, StimulusGroupModeType stimulusmode, st
 	stimulus_order = stimulusmode ;
 
 	stimulus_active = false ;
-	set_all( 0.0 ); 
+	activate_all( 0.0 ); 
 
 	scale = 2.0;
 	randomintervals = true;
@@ -70,43 +90,87 @@ void StimulusGroup::init(string filename, StimulusGroupModeType stimulusmode, st
 	load_patterns(filename);
 }
 
-StimulusGroup::StimulusGroup(NeuronID n, string filename, string outputfile, StimulusGroupModeType stimulusmode, AurynFloat baserate) : SpikingGroup( n, STIMULUSGROUP_LOAD_MULTIPLIER ) // Load multiplier is an empircal value
+StimulusGroup::StimulusGroup(NeuronID n, string filename, string outputfile, StimulusGroupModeType stimulusmode, AurynFloat baserate) : SpikingGroup( n, STIMULUSGROUP_LOAD_MULTIPLIER ), order_die(order_gen) // Load multiplier is an empircal value
 {
 	init(filename, stimulusmode, outputfile, baserate);
 }
 
 StimulusGroup::~StimulusGroup()
 {
+	if ( prefetcher != NULL ) 
+		delete prefetcher;
+	pthread_mutex_destroy(&tiser_mutex);
 	delete [] ttl;
+	delete [] schedule_count;
+	delete [] active_index;
+	delete [] activity;
+	delete poisson_die;
 	tiserfile.close();
 }
 
-void StimulusGroup::redraw()
+void StimulusGroup::schedule(NeuronID i, AurynDouble offset)
 {
-	boost::exponential_distribution<> dist(BASERATE);
-	boost::variate_generator<boost::mt19937&, boost::exponential_distribution<> > die(poisson_gen, dist);
-	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i )
-	{
-		ttl[i] = sys->get_clock() + (AurynTime)((AurynFloat)die()/((activity[i]+1e-9)*dt));
+	++schedule_count[i]; // invalidates the previous entry
+	const AurynDouble steps = (*poisson_die)()/((activity[i]+base_rate)*dt)+offset;
+	if ( !(steps < 1e9) ) return; // practically never 
+	ttl[i] = current_time() + 1 + (AurynTime)steps;
+	WheelEntry entry;
+	entry.unit = i;
+	entry.count = schedule_count[i];
+	wheel[ttl[i]&(STIMULUSGROUP_WHEEL_SIZE-1)].push_back(entry);
+}
+
+AurynTime StimulusGroup::current_time()
+{
+	if ( prefetching ) return producer_time;
+	return sys->get_clock();
+}
+
+void StimulusGroup::process_bucket(AurynTime t, AurynTime now, SpikeContainer * out)
+{
+	vector<WheelEntry> & bucket = wheel[t&(STIMULUSGROUP_WHEEL_SIZE-1)];
+	if ( bucket.empty() ) return;
+	due.swap(bucket);
+	for ( vector<WheelEntry>::const_iterator iter = due.begin() ; iter != due.end() ; ++iter ) {
+		const NeuronID i = iter->unit;
+		if ( iter->count != schedule_count[i] ) continue; // rescheduled in the meantime
+		if ( ttl[i] > now ) { // due in a later revolution
+			bucket.push_back(*iter);
+			continue;
+		}
+		out->push_back( rank2global(i) );
+		schedule( i );
 	}
+	due.clear();
 }
 
-void StimulusGroup::redraw_softstart()
+void StimulusGroup::redraw()
 {
-	boost::exponential_distribution<> dist(BASERATE);
-	boost::variate_generator<boost::mt19937&, boost::exponential_distribution<> > die(poisson_gen, dist);
+	for ( vector<NeuronID>::const_iterator iter = active_units.begin() ; iter != active_units.end() ; ++iter ) 
+		schedule(*iter);
+}
 
+void StimulusGroup::redraw_softstart()
+{
 	boost::uniform_real<> uniformdist(0, SOFTSTARTTIME );
 	boost::variate_generator<boost::mt19937&, boost::uniform_real<> > random(poisson_gen, uniformdist);
 
-	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i )
-	{
-		ttl[i] = sys->get_clock() + (AurynTime)((AurynFloat)die()/((activity[i]+base_rate)*dt)+random()/dt);
-	}
+	for ( vector<NeuronID>::const_iterator iter = active_units.begin() ; iter != active_units.end() ; ++iter ) 
+		schedule(*iter,random()/dt);
+}
+
+void StimulusGroup::check_not_prefetching(string what)
+{
+	if ( !prefetching ) return;
+	stringstream oss;
+	oss << "StimulusGroup:: Can't change the " << what << " while prefetching.";
+	logger->msg(oss.str(),ERROR);
+	throw AurynPrefetcherException();
 }
 
 void StimulusGroup::set_baserate(AurynFloat baserate)
 {
+	check_not_prefetching("baserate");
 	base_rate = baserate;
 	redraw();
 	logger->parameter("StimulusGroup:: baserate",baserate);
@@ -119,61 +183,105 @@ void StimulusGroup::set_maxrate(AurynFloat baserate)
 
 void StimulusGroup::set_mean_off_period(AurynFloat period)
 {
+	check_not_prefetching("mean off period");
 	mean_off_period = period;
 	logger->parameter("StimulusGroup:: mean_off_period",mean_off_period);
 }
 
 void StimulusGroup::set_mean_on_period(AurynFloat period)
 {
+	check_not_prefetching("mean on period");
 	mean_on_period = period;
 	logger->parameter("StimulusGroup:: mean_on_period",mean_on_period);
 }
 
+string StimulusGroup::sequence_line(AurynDouble time)
+{
+	stringstream oss;
+	oss.setf(ios::fixed);
+	oss << time; 
+	for ( unsigned int i = 0 ; i < stimuli.size() ; ++i ) {
+		oss << "  ";
+		if ( ( stimulus_active  && i == cur_stim_index ) || ( !stimulus_active && (int)i == off_pattern ) ) oss << 1; else oss << 0;
+	}
+	return oss.str();
+}
+
 void StimulusGroup::write_sequence_file(AurynDouble time) {
-	if ( tiserfile ) {
-		tiserfile << time; 
-		for ( unsigned int i = 0 ; i < stimuli.size() ; ++i ) {
-			tiserfile << "  ";
-			if ( ( stimulus_active  && i == cur_stim_index ) || ( !stimulus_active && i == off_pattern ) ) tiserfile << 1; else tiserfile << 0;
-		}
-		tiserfile  << endl;
+	if ( prefetching ) {
+		// the producer runs ahead, so the line is written when the simulation gets there
+		if ( !tiserfile.is_open() ) return;
+		const string line = sequence_line(time);
+		pthread_mutex_lock(&tiser_mutex);
+		tiser_lines.push_back(make_pair(producer_time,line));
+		pthread_mutex_unlock(&tiser_mutex);
+		return;
 	}
+	if ( tiserfile ) 
+		tiserfile << sequence_line(time) << endl;
+}
+
+void StimulusGroup::write_pending_sequence(AurynTime now)
+{
+	pthread_mutex_lock(&tiser_mutex);
+	while ( !tiser_lines.empty() && tiser_lines.front().first <= now ) {
+		tiserfile << tiser_lines.front().second << endl;
+		tiser_lines.pop_front();
+	}
+	pthread_mutex_unlock(&tiser_mutex);
 }
 
 void StimulusGroup::evolve()
 {
-	if ( !active ) return;
+	if ( prefetcher != NULL ) {
+		prefetcher->pop(sys->get_clock(),spikes);
+		if ( tiserfile.is_open() ) write_pending_sequence(sys->get_clock());
+		return;
+	}
 
-	// detect and push spikes
-	boost::exponential_distribution<> dist(BASERATE);
-	boost::variate_generator<boost::mt19937&, boost::exponential_distribution<> > die(poisson_gen, dist);
-	for ( NeuronID i = 0 ; i < get_rank_size() ; ++i )
-	{
-		if ( ttl[i] < sys->get_clock() && activity[i]>0.0 )
-		{
-			push_spike ( i );
-			ttl[i] = sys->get_clock() + (AurynTime)((AurynFloat)die()/((activity[i]+base_rate)*dt));
-		}
+	if ( generate(sys->get_clock(),spikes) ) {
+		// nothing happens until the next stimulus is switched on
+		sleep_until( next_action_time );
 	}
+}
+
+void StimulusGroup::produce_spikes(AurynTime t, SpikeContainer * out)
+{
+	generate(t,out);
+}
+
+bool StimulusGroup::generate(AurynTime now, SpikeContainer * out)
+{
+	if ( !active ) return false;
+	producer_time = now;
+
+	// push the spikes of the units due since the last call
+	AurynTime t = wheel_time+1;
+	if ( now-wheel_time > STIMULUSGROUP_WHEEL_SIZE ) 
+		t = now-STIMULUSGROUP_WHEEL_SIZE+1;
+	for ( ; t <= now ; ++t ) 
+		process_bucket(t,now,out);
+	wheel_time = now;
+	const bool silent = active_units.empty();
 
 	// update stimulus properties
-	if ( sys->get_clock() >= next_action_time ) {
-		write_sequence_file(dt*(sys->get_clock()));
+	if ( now >= next_action_time ) {
+		write_sequence_file(dt*(now));
 
 		if ( stimulus_active ) {
 			if ( off_pattern >= 0 ) {
-				set_active_pattern( off_pattern ); // turn on "off-stimulus"
+				switch_to_pattern( off_pattern ); // turn on "off-stimulus"
 				cur_stim_index = off_pattern;
 			} else
-				set_all( 0.0 ); // turn off currently active stimulus 
+				activate_all( 0.0 ); // turn off currently active stimulus 
 			stimulus_active = false ;
 
 			if ( randomintervals ) {
 				boost::exponential_distribution<> dist(1./mean_off_period);
 				boost::variate_generator<boost::mt19937&, boost::exponential_distribution<> > die(order_gen, dist);
-				next_action_time = sys->get_clock() + (AurynTime)(max(0.0,die())/dt);
+				next_action_time = now + (AurynTime)(max(0.0,die())/dt);
 			} else {
-				next_action_time = sys->get_clock() + (AurynTime)(mean_off_period/dt);
+				next_action_time = now + (AurynTime)(mean_off_period/dt);
 			}
 		} else {
 			if ( active ) {
@@ -191,46 +299,80 @@ void StimulusGroup::evolve()
 					break;
 					case RANDOM:
 					default:
-						double draw = order_die();
-						double cummulative = 0; // TODO make this less greedy and do not compute this every draw
-						cur_stim_index = 0;
-						// cout.precision(5);
-						// cout << " draw " << draw <<  endl;
-						for ( unsigned int i = 0 ; i < probabilities.size() ; ++i ) {
-							cummulative += probabilities[i];
-							// cout << cummulative << endl;
-							if ( draw <= cummulative ) {
-								cur_stim_index = i;
-								break;
-							}
-						}
+						cur_stim_index = draw_stimulus();
 					break;
 				}
-				set_active_pattern( cur_stim_index );
+				switch_to_pattern( cur_stim_index );
 				stimulus_active = true;
 
 				if ( randomintervals ) {
 					boost::normal_distribution<> dist(mean_on_period,mean_on_period/3);
 					boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > die(order_gen, dist);
-					next_action_time = sys->get_clock() + (AurynTime)(max(0.0,die())/dt);
+					next_action_time = now + (AurynTime)(max(0.0,die())/dt);
 				} else {
-					next_action_time = sys->get_clock() + (AurynTime)(mean_on_period/dt);
+					next_action_time = now + (AurynTime)(mean_on_period/dt);
 				}
 			}
 		}
-		write_sequence_file(dt*(sys->get_clock()+1));
+		write_sequence_file(dt*(now+1));
+		return false;
 	}
+	return silent;
+}
+
+void StimulusGroup::enable_prefetching(AurynTime batch_steps, unsigned int num_batches)
+{
+	if ( !evolve_locally() || prefetcher != NULL ) return;
+	// from the first produced step on units are scheduled from producer_time
+	prefetching = true;
+	try {
+		prefetcher = new SpikePrefetcher(this,sys->get_clock(),batch_steps,num_batches);
+	} catch ( AurynPrefetcherException & e ) {
+		prefetching = false;
+		throw;
+	}
+	wake(); // the group has to pop every step
+	logger->msg("StimulusGroup:: Generating spikes and stimuli in a producer thread",NOTIFICATION);
 }
 
 void StimulusGroup::set_activity(NeuronID i, AurynFloat val)
 {
 	activity[i] = max((double)val,1e-9);
+	if ( active_index[i] < 0 ) {
+		active_index[i] = active_units.size();
+		active_units.push_back(i);
+	}
+	schedule(i);
+	if ( !prefetching ) wake();
 }
 
 void StimulusGroup::set_all(AurynFloat val)
 {
-	for ( unsigned int i = 0 ; i < get_rank_size() ; ++i )
-		activity[i] = val;
+	check_not_prefetching("activities");
+	activate_all(val);
+}
+
+void StimulusGroup::activate_all(AurynFloat val)
+{
+	if ( val > 0.0 ) {
+		for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) {
+			activity[i] = val;
+			if ( active_index[i] < 0 ) {
+				active_index[i] = active_units.size();
+				active_units.push_back(i);
+			}
+			schedule(i);
+		}
+	} else {
+		// only active units need to be touched
+		for ( vector<NeuronID>::const_iterator iter = active_units.begin() ; iter != active_units.end() ; ++iter ) {
+			activity[*iter] = val;
+			active_index[*iter] = -1;
+			++schedule_count[*iter];
+		}
+		active_units.clear();
+	}
+	if ( !prefetching ) wake();
 }
 
 AurynFloat StimulusGroup::get_activity(NeuronID i)
@@ -243,6 +385,7 @@ AurynFloat StimulusGroup::get_activity(NeuronID i)
 
 void StimulusGroup::load_patterns( string filename )
 {
+		check_not_prefetching("patterns");
 		ifstream fin (filename.c_str());
 		if (!fin) {
 			stringstream oss;
@@ -312,6 +455,12 @@ void StimulusGroup::load_patterns( string filename )
 }
 
 void StimulusGroup::set_pattern_activity(unsigned int i)
+{
+	check_not_prefetching("activities");
+	activate_pattern(i);
+}
+
+void StimulusGroup::activate_pattern(unsigned int i)
 {
 	type_pattern current = stimuli[i];
 	type_pattern::iterator iter;
@@ -331,6 +480,7 @@ void StimulusGroup::set_pattern_activity(unsigned int i)
 
 void StimulusGroup::set_pattern_activity(unsigned int i,AurynFloat setrate)
 {
+	check_not_prefetching("activities");
 	type_pattern current = stimuli[i];
 	type_pattern::iterator iter;
 
@@ -343,19 +493,27 @@ void StimulusGroup::set_pattern_activity(unsigned int i,AurynFloat setrate)
 
 void StimulusGroup::set_active_pattern(unsigned int i)
 {
-	stringstream oss;
-	oss << "StimulusGroup:: Setting active pattern " << i ;
-	logger->msg(oss.str(),DEBUG);
+	check_not_prefetching("active pattern");
+	switch_to_pattern(i);
+}
 
-	set_all( 0.0 );
+void StimulusGroup::switch_to_pattern(unsigned int i)
+{
+	if ( !prefetching ) { // no logging from the producer thread
+		stringstream oss;
+		oss << "StimulusGroup:: Setting active pattern " << i ;
+		logger->msg(oss.str(),DEBUG);
+	}
+
+	activate_all( 0.0 );
 	if ( i < stimuli.size() ) {
-		set_pattern_activity(i);
+		activate_pattern(i);
 	}
-	redraw();
 }
 
 void StimulusGroup::set_distribution( vector<double> probs )
 {
+	check_not_prefetching("distribution");
 	stringstream oss;
 	oss << "StimulusGroup: Set distribution [";
 	for ( unsigned int i = 0 ; i < stimuli.size() ; ++i ) {
@@ -380,13 +538,17 @@ double StimulusGroup::get_distribution( int i )
 
 void StimulusGroup::flat_distribution( ) 
 {
+	check_not_prefetching("distribution");
+	probabilities.clear();
 	for ( unsigned int i = 0 ; i < stimuli.size() ; ++i ) {
 		probabilities.push_back(1./((double)stimuli.size()));
 	}
+	compute_alias_table();
 }
 
 void StimulusGroup::normalize_distribution()
 {
+	check_not_prefetching("distribution");
 	stringstream oss;
 	oss << "StimulusGroup: Normalizing distribution [";
 	double sum = 0 ;
@@ -402,6 +564,44 @@ void StimulusGroup::normalize_distribution()
 
 	oss << " ]";
 	logger->msg(oss.str(),DEBUG);
+
+	compute_alias_table();
+}
+
+void StimulusGroup::compute_alias_table()
+{
+	// Vose's alias method
+	const unsigned int n = stimuli.size();
+	alias_probability.assign(n,1.0);
+	alias.assign(n,0);
+	vector<double> scaled(n);
+	vector<unsigned int> small;
+	vector<unsigned int> large;
+	for ( unsigned int i = 0 ; i < n ; ++i ) {
+		alias[i] = i;
+		scaled[i] = probabilities[i]*n;
+		if ( scaled[i] < 1.0 ) small.push_back(i);
+		else large.push_back(i);
+	}
+	while ( !small.empty() && !large.empty() ) {
+		const unsigned int s = small.back(); small.pop_back();
+		const unsigned int l = large.back(); large.pop_back();
+		alias_probability[s] = scaled[s];
+		alias[s] = l;
+		scaled[l] += scaled[s]-1.0;
+		if ( scaled[l] < 1.0 ) small.push_back(l);
+		else large.push_back(l);
+	}
+}
+
+unsigned int StimulusGroup::draw_stimulus()
+{
+	if ( alias.empty() ) return 0;
+	const double u = order_die()*alias.size();
+	unsigned int k = (unsigned int) u;
+	if ( k >= alias.size() ) k = alias.size()-1;
+	if ( u-k < alias_probability[k] ) return k;
+	return alias[k];
 }
 
 vector<type_pattern> * StimulusGroup::get_patterns()
@@ -410,11 +610,14 @@ vector<type_pattern> * StimulusGroup::get_patterns()
 }
 
 void StimulusGroup::set_next_action_time( double time ) {
+	check_not_prefetching("next action time");
 	next_action_time = sys->get_clock() + time/dt;
+	wake();
 }
 
 void StimulusGroup::set_off_pattern( int i )
 {
+	check_not_prefetching("off pattern");
 	if ( i < stimuli.size() ) {
 		off_pattern = i;
 		stringstream oss;
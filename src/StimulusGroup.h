@@ -25,6 +25,7 @@
 #include "auryn_definitions.h"
 #include "System.h"
 #include "SpikingGroup.h"
+#include "SpikePrefetcher.h"
 
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_01.hpp>
@@ -33,39 +34,94 @@
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
 
+#include <deque>
+#include <pthread.h>
+
 #define BASERATE 1.0
 #define SOFTSTARTTIME 0.1
 #define STIMULUSGROUP_LOAD_MULTIPLIER 0.1
+/*! Number of time steps covered by one revolution of the timing wheel (power of two) */
+#define STIMULUSGROUP_WHEEL_SIZE 4096
 
 using namespace std;
 
 
 /*! \brief Provides a poisson stimulus at random intervals in one or more
- *         predefined subsets of the group that are read from a file. */
-class StimulusGroup : public SpikingGroup
+ *         predefined subsets of the group that are read from a file. 
+ *
+ * The next spike times of all active units are kept in a timing wheel with
+ * one bucket per time step, so that each step only touches the units due to 
+ * fire. Spike times beyond one revolution of the wheel stay in their bucket 
+ * until their revolution comes up. Changing the activity of a unit 
+ * reschedules only that unit; outdated wheel entries are recognized by a 
+ * per-unit schedule counter and dropped when their bucket is processed.
+ * In RANDOM mode the next stimulus is drawn from an alias table. 
+ *
+ * With enable_prefetching() the spikes and the stimulus switching are 
+ * generated in a background thread ahead of the simulation. The lines of the
+ * stimulus time series file are then written when the simulation reaches 
+ * them. The producer thread then owns the stimulus protocol, so the setters
+ * throw AurynPrefetcherException and the public flags must not be changed 
+ * anymore. */
+class StimulusGroup : public SpikingGroup, public SpikeProducer
 {
 private:
 	AurynTime * clk;
+	/*! Time step in which each unit fires next */
 	AurynTime * ttl;
+	/*! Incremented whenever a unit is rescheduled to invalidate older wheel entries */
+	unsigned int * schedule_count;
+	/*! Entry of the timing wheel */
+	struct WheelEntry { 
+		NeuronID unit; 
+		unsigned int count; 
+	};
+	/*! Timing wheel with one bucket of scheduled units per time step */
+	vector< vector<WheelEntry> > wheel;
+	/*! Bucket swapped out of the wheel while it is processed */
+	vector<WheelEntry> due;
+	/*! Last time step whose bucket was processed */
+	AurynTime wheel_time;
+	/*! Units with nonzero activity */
+	vector<NeuronID> active_units;
+	/*! Position of each unit in active_units or -1 */
+	int * active_index;
 	vector<type_pattern> stimuli;
 	AurynFloat * activity;
 	ofstream tiserfile;
+	/*! Lines of the tiserfile generated ahead by the producer thread and the time step at which they are due */
+	deque< pair<AurynTime,string> > tiser_lines;
+	pthread_mutex_t tiser_mutex;
 	AurynFloat base_rate;
 
 	int off_pattern;
 
-	/*! pseudo random number generators */
-	static boost::mt19937 poisson_gen; 
+	/*! pseudo random number generators of this instance */
+	boost::mt19937 poisson_gen; 
 
 	/*! generates info for what stimulus is active. Is supposed to give the same result on all nodes (hence same seed required) */
-	static boost::mt19937 order_gen; 
-	static boost::uniform_01<boost::mt19937> order_die; 
+	boost::mt19937 order_gen; 
+	boost::uniform_01<boost::mt19937> order_die; 
+	/*! Number of instances created so far, used to give each instance its own seeds */
+	static unsigned int num_instances;
+	/*! Set while the spikes are generated in a producer thread */
+	bool prefetching;
+	/*! Producer thread generating ahead or NULL */
+	SpikePrefetcher * prefetcher;
+	/*! Time step which is being generated by the producer thread */
+	AurynTime producer_time;
+	/*! Exponential interval generator on poisson_gen */
+	boost::variate_generator<boost::mt19937&, boost::exponential_distribution<> > * poisson_die;
 
 	/*! Stimulus order */
 	StimulusGroupModeType stimulus_order ;
 
 	/*! stimulus probabilities */
 	vector<double> probabilities ;
+	/*! Acceptance probabilities of the alias table for the stimulus probabilities */
+	vector<double> alias_probability ;
+	/*! Alias stimulus index for each entry of the alias table */
+	vector<unsigned int> alias ;
 
 	/*! current stimulus index */
 	unsigned int cur_stim_index ;
@@ -76,6 +132,27 @@ private:
 
 	/*! Standard initialization */
 	void init(string filename, StimulusGroupModeType stimulusmode, string outputfile, AurynFloat baserate);
+	/*! Draws the next spike time of unit i, delayed by offset time steps, and enters it into the wheel */
+	void schedule( NeuronID i, AurynDouble offset=0.0 );
+	/*! Time step from which units are scheduled */
+	AurynTime current_time();
+	/*! Processes the wheel bucket of time step t and appends the units due at time step now to out */
+	void process_bucket( AurynTime t, AurynTime now, SpikeContainer * out );
+	/*! Appends the spikes of time step now to out and switches the stimulus 
+	 * if due. Returns true if the group can sleep until the next switch. */
+	bool generate( AurynTime now, SpikeContainer * out );
+	/*! Builds the alias table from probabilities */
+	void compute_alias_table();
+	/*! Draws a stimulus index from the alias table */
+	unsigned int draw_stimulus();
+	/*! Throws AurynPrefetcherException if the producer thread owns the stimulus protocol */
+	void check_not_prefetching(string what);
+	/*! Sets the activity of all units, also from the producer thread */
+	void activate_all( AurynFloat val );
+	/*! Sets the activity of the units in pattern i, also from the producer thread */
+	void activate_pattern( unsigned int i );
+	/*! Switches to pattern i as the only active one, also from the producer thread */
+	void switch_to_pattern( unsigned int i );
 	/*! Draw all Time-To-Live (ttls) typically after changing the any of the activiteis */
 	void redraw();
 
@@ -84,6 +161,10 @@ private:
 
 	/*! write current stimulus to timeseriesfile */
 	void write_sequence_file(AurynDouble time);
+	/*! Formats the tiserfile line for the stimulus shown from time on */
+	string sequence_line(AurynDouble time);
+	/*! Writes the tiserfile lines generated ahead which are due at time step now */
+	void write_pending_sequence(AurynTime now);
 
 	/*! Sets the activity for a given unit on the local rank. Activity determines the freq as baserate*activity */
 	void set_activity( NeuronID i, AurynFloat val=0.0 );
@@ -114,6 +195,11 @@ public:
 	virtual ~StimulusGroup();
 	/*! Standard virtual evolve function */
 	virtual void evolve();
+	virtual void produce_spikes(AurynTime t, SpikeContainer * out);
+	/*! Generates the spikes and switches the stimuli in a background thread
+	 * in batches of batch_steps time steps. Afterwards the setters throw 
+	 * AurynPrefetcherException. */
+	void enable_prefetching(AurynTime batch_steps=SPIKEPREFETCHER_BATCH_STEPS, unsigned int num_batches=SPIKEPREFETCHER_NUM_BATCHES);
 	/*! Sets the baserate that is the rate at 1 activity */
 	void set_baserate(AurynFloat baserate);
 	void set_maxrate(AurynFloat baserate); // TODO remove deprecated
@@ -72,6 +72,11 @@ StructuredPoissonGroup::~StructuredPoissonGroup()
 	}
 }
 
+bool StructuredPoissonGroup::can_skip_steps()
+{
+	return false;
+}
+
 void StructuredPoissonGroup::evolve()
 {
 	if ( sys->get_clock() >= next_event ) {
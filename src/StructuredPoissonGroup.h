@@ -59,6 +59,10 @@ private:
 
 	void init ( AurynFloat duration, AurynFloat mean_interval, NeuronID no , string outputfile );
 	
+protected:
+	/*! The rate changes in evolve(), no time steps can be skipped */
+	virtual bool can_skip_steps();
+
 public:
 	StructuredPoissonGroup(NeuronID n, AurynFloat duration, AurynFloat interval, NeuronID stimuli = 1,  AurynDouble rate=5. ,
 			string tiserfile = "stimulus.dat" );
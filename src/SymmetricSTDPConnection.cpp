@@ -126,6 +126,10 @@ inline void SymmetricSTDPConnection::propagate_backward()
 
 void SymmetricSTDPConnection::propagate()
 {
+	if ( consolidated ) {
+		SparseConnection::propagate();
+		return;
+	}
 	// propagate
 	propagate_forward();
 	propagate_backward();
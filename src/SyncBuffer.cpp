@@ -100,7 +100,7 @@ void SyncBuffer::pop(SpikeDelay * delay, NeuronID size)
 {
 	for (NeuronID i = 1 ; i < MINDELAY+1 ; ++i ) {
 		delay->get_spikes(i)->clear();
-		delay->get_spikes(i)->clear();
+		delay->get_attributes(i)->clear();
 	}
 
 
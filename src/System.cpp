@@ -34,6 +34,10 @@ void System::init() {
 		<< " ( compiled " << __DATE__ << " " << __TIME__ << " )";
 	logger->msg(oss.str(),NOTIFICATION);
 
+	oss.str("");
+	oss << "Vector kernels use " << auryn_simd_level_name(auryn_get_simd_level()) << " instructions";
+	logger->msg(oss.str(),NOTIFICATION);
+
 	oss.str("");
 	oss << "Current AurynTime good for simulations up to "
 		<< std::numeric_limits<AurynTime>::max()*dt << "s  "
@@ -213,15 +217,32 @@ void System::evolve_independent()
 void System::propagate()
 {
 	vector<Connection *>::const_iterator iter;
-	for ( iter = connections.begin() ; iter != connections.end() ; ++iter )
-		(*iter)->propagate(); 
+	for ( iter = connections.begin() ; iter != connections.end() ; ++iter ) {
+		Connection * con = *iter;
+		// spikes arriving at a quiescent group wake it up for the next step
+		if ( con->get_source() != NULL && con->get_destination() != NULL 
+				&& !con->get_source()->get_spikes()->empty() ) 
+			con->get_destination()->wake();
+		if ( !con->is_quiescent() ) {
+			con->propagate(); 
+			if ( con->tracks_targets() ) 
+				con->mark_targets();
+		}
+	}
+}
+
+void System::flush_monitors()
+{
+	for ( unsigned int i = 0 ; i < monitors.size() ; ++i )
+		monitors[i]->flush();
 }
 
 bool System::monitor(bool checking)
 {
 	vector<Monitor *>::const_iterator iter;
 	for ( iter = monitors.begin() ; iter != monitors.end() ; ++iter )
-		(*iter)->propagate();
+		if ( (*iter)->active ) 
+			(*iter)->propagate();
 
 	for ( unsigned int i = 0 ; i < checkers.size() ; ++i )
 		if (!checkers[i]->propagate() && checking) {
@@ -336,8 +357,10 @@ bool System::run(AurynTime starttime, AurynTime stoptime, AurynFloat total_time,
 		evolve();
 		propagate();
 
-		if (!monitor(checking))
+		if (!monitor(checking)) {
+			flush_monitors();
 			return false;
+		}
 
 		evolve_independent(); // used to run in parallel to the sync (and could still in principle)
 		// what is important for event based integration such as done in LinearTrace that this stays
@@ -360,6 +383,10 @@ bool System::run(AurynTime starttime, AurynTime stoptime, AurynFloat total_time,
 	oss << "Simulation finished. Ran for " << elapsed << "s with SpeedFactor=" << elapsed/runtime;
 	logger->msg(oss.str(),NOTIFICATION);
 
+	// complete the output files of this run
+	flush_monitors();
+	AsyncIOService::instance()->log_statistics();
+
 	return true;
 }
 
@@ -402,6 +429,11 @@ void System::set_simulation_name(string name)
 	simulation_name = name;
 }
 
+void System::set_quiet(bool q)
+{
+	quiet = q;
+}
+
 void System::save_network_state(string basename)
 {
 	char filename [255];
@@ -79,6 +79,8 @@ public:
 	System(mpi::communicator * communicator);
 	void init();
 	void set_simulation_name(string name);
+	/*! Turns the progress bar off (true) or on (false) */
+	void set_quiet(bool q);
 	virtual ~System();
 	void free();
 
@@ -109,6 +111,9 @@ public:
 	/*! Calls all monitors. */
 	bool monitor(bool checking);
 
+	/*! Writes buffered output of all monitors to their files. */
+	void flush_monitors();
+
 	/*! Registers an instance of SpikingGroup to the spiking_groups vector. */
 	void register_spiking_group(SpikingGroup * spiking_group);
 
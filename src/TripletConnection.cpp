@@ -179,6 +179,10 @@ void TripletConnection::propagate_backward()
 
 void TripletConnection::propagate()
 {
+	if ( consolidated ) {
+		SparseConnection::propagate();
+		return;
+	}
 	propagate_forward();
 	propagate_backward();
 }
@@ -29,6 +29,10 @@ void TripletDecayConnection::init(AurynFloat decay, AurynWeight wrest)
 	decay_timestep = -log(TRIPLETDECAYCONNECTION_EULERUPGRADE_STEP)*tau_decay/dt;
 	decay_count = decay_timestep;
 
+	lazy_decay = false;
+	decay_epoch = 0;
+	row_decay_epoch.assign(get_m_rows(),0);
+
 	stringstream oss;
 	oss << "TripletDecayConnection: (" << get_name() << "):"
 		<< " decay_timestep= " << decay_timestep 
@@ -43,6 +47,7 @@ void TripletDecayConnection::free()
 
 TripletDecayConnection::TripletDecayConnection(SpikingGroup * source, NeuronGroup * destination, TransmitterType transmitter) : TripletConnection(source, destination, transmitter)
 {
+	init(1e-3,0.); // defaults of the other constructors
 }
 
 TripletDecayConnection::TripletDecayConnection(SpikingGroup * source, NeuronGroup * destination, 
@@ -81,15 +86,149 @@ TripletDecayConnection::~TripletDecayConnection()
 	free();
 }
 
+void TripletDecayConnection::decay_row(NeuronID i)
+{
+	AurynTime steps = decay_epoch-row_decay_epoch[i];
+	if ( steps == 0 ) return;
+	row_decay_epoch[i] = decay_epoch;
+
+	// n consecutive decay steps collapse into a single one with mul_decay^n
+	AurynWeight factor = mul_decay;
+	if ( steps > 1 ) 
+		factor = pow(mul_decay,(AurynFloat)steps);
+
+	AurynWeight * data = w->get_data_begin();
+	NeuronID * ind = w->get_ind_begin();
+	for ( NeuronID * c = w->get_row_begin(i) ; c != w->get_row_end(i) ; ++c ) {
+		AurynWeight * value = data + (c-ind);
+		*value = w_rest + factor*(*value-w_rest);
+	}
+}
+
+void TripletDecayConnection::decay_row_of(AurynLong k)
+{
+	NeuronID ** rowptrs = w->get_rowptrs();
+	NeuronID ** row = upper_bound(rowptrs, rowptrs+get_m_rows()+1, w->get_ind_begin()+k);
+	decay_row(row-rowptrs-1);
+}
+
+void TripletDecayConnection::decay_touched_rows()
+{
+	// rows of presynaptic spikes are read by propagate_forward
+	for (SpikeContainer::const_iterator spike = src->get_spikes()->begin() ; 
+			spike != src->get_spikes()->end() ; ++spike ) 
+		decay_row(*spike);
+
+	// rows of synapses onto postsynaptic spikes are changed by propagate_backward
+	if ( stdp_active ) {
+		for (SpikeContainer::const_iterator spike = dst->get_spikes_immediate()->begin() ; 
+				spike != dst->get_spikes_immediate()->end() ; ++spike ) {
+			for (NeuronID * c = bkw->get_row_begin(*spike) ; c != bkw->get_row_end(*spike) ; ++c ) 
+				decay_row(*c);
+		}
+	}
+}
+
+void TripletDecayConnection::apply_pending_decay()
+{
+	for ( NeuronID i = 0 ; i < row_decay_epoch.size() ; ++i ) 
+		decay_row(i);
+}
+
+void TripletDecayConnection::flush_weights()
+{
+	apply_pending_decay();
+}
+
+void TripletDecayConnection::set_lazy_decay(bool lazy)
+{
+	if ( lazy_decay && !lazy ) 
+		apply_pending_decay();
+	lazy_decay = lazy;
+
+	stringstream oss;
+	oss << "TripletDecayConnection: (" << get_name() << "):"
+		<< " lazy_decay= " << lazy_decay;
+	logger->msg(oss.str(),DEBUG);
+}
+
+void TripletDecayConnection::consolidate(AurynWeight quantum)
+{
+	apply_pending_decay();
+	TripletConnection::consolidate(quantum);
+}
+
+AurynWeight TripletDecayConnection::get(NeuronID i, NeuronID j)
+{
+	decay_row(i);
+	return TripletConnection::get(i,j);
+}
+
+AurynWeight * TripletDecayConnection::get_ptr(NeuronID i, NeuronID j)
+{
+	decay_row(i);
+	return TripletConnection::get_ptr(i,j);
+}
+
+AurynWeight TripletDecayConnection::get_data(NeuronID i)
+{
+	decay_row_of(i);
+	return TripletConnection::get_data(i);
+}
+
+void TripletDecayConnection::set_data(NeuronID i, AurynWeight value)
+{
+	decay_row_of(i);
+	TripletConnection::set_data(i,value);
+}
+
+void TripletDecayConnection::set(NeuronID i, NeuronID j, AurynWeight value)
+{
+	decay_row(i);
+	TripletConnection::set(i,j,value);
+}
+
+bool TripletDecayConnection::load_from_file(const char * filename)
+{
+	bool result = TripletConnection::load_from_file(filename);
+	// loaded weights are up to date
+	row_decay_epoch.assign(get_m_rows(),decay_epoch);
+	return result;
+}
+
+bool TripletDecayConnection::load_from_file(string filename)
+{
+	return load_from_file(filename.c_str());
+}
+
+void TripletDecayConnection::connect_random(AurynWeight weight, float sparseness, bool skip_diag)
+{
+	TripletConnection::connect_random(weight,sparseness,skip_diag);
+	// new weights are up to date
+	row_decay_epoch.assign(get_m_rows(),decay_epoch);
+}
+
 void TripletDecayConnection::propagate()
 {
+	if ( consolidated ) {
+		SparseConnection::propagate();
+		return;
+	}
+
+	if ( lazy_decay ) 
+		decay_touched_rows();
+
 	TripletConnection::propagate();
 	// decay of weights
 	if ( stdp_active ) {
 		if ( decay_count == 0 ) {
-			for ( AurynWeight * i = w->get_data_begin() ; i != w->get_data_end() ; ++i ) {
-				// *i *= mul_decay;
-				*i = w_rest + mul_decay*(*i-w_rest);
+			if ( lazy_decay ) {
+				decay_epoch++;
+			} else {
+				for ( AurynWeight * i = w->get_data_begin() ; i != w->get_data_end() ; ++i ) {
+					// *i *= mul_decay;
+					*i = w_rest + mul_decay*(*i-w_rest);
+				}
 			}
 			decay_count = decay_timestep;
 		}
@@ -97,4 +236,3 @@ void TripletDecayConnection::propagate()
 			decay_count--;
 	}
 }
-
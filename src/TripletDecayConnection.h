@@ -25,6 +25,8 @@
 #include "TripletConnection.h"
 #include "EulerTrace.h"
 
+#include <algorithm>
+
 #define TRIPLETDECAYCONNECTION_EULERUPGRADE_STEP 0.999
 
 using namespace std;
@@ -40,6 +42,19 @@ private:
 	AurynWeight w_rest;
 	AurynInt decay_count;
 
+	/*! Switches between the periodic sweep over all weights and lazy decay */
+	bool lazy_decay;
+	/*! Number of decay steps that have elapsed since the start of the simulation */
+	AurynTime decay_epoch;
+	/*! Per-row decay step up to which the weights of that row have been decayed */
+	vector<AurynTime> row_decay_epoch;
+
+	/*! Applies all pending decay steps to the weights of presynaptic row i */
+	void decay_row(NeuronID i);
+	/*! Applies all pending decay steps to the row which holds data element k */
+	void decay_row_of(AurynLong k);
+	void decay_touched_rows();
+
 public:
 	TripletDecayConnection(SpikingGroup * source, NeuronGroup * destination, TransmitterType transmitter);
 
@@ -61,6 +76,38 @@ public:
 	void init(AurynFloat decay, AurynWeight wrest);
 	void free();
 
+	/*! Enables or disables lazy weight decay. When enabled the weights are
+	 * not decayed by a periodic sweep over the whole weight matrix. Instead
+	 * the number of elapsed decay steps is stored per row and the decay is
+	 * applied analytically to a row before any of its weights is read or
+	 * changed by the plasticity rule. Disabling applies all pending decay. */
+	void set_lazy_decay(bool lazy=true);
+
+	/*! Brings all weights up to date. The accessors, the whole-matrix 
+	 * operations and the weight monitors do this themselves. It only has 
+	 * to be called before reading the weights through get_data_begin or 
+	 * through a pointer from get_ptr obtained earlier in the run, when 
+	 * lazy decay is enabled. */
+	void apply_pending_decay();
+	/*! Applies all pending decay */
+	virtual void flush_weights();
+
+	/*! Applies pending decay before consolidating the connection. */
+	virtual void consolidate(AurynWeight quantum=0.0);
+
+	virtual AurynWeight get(NeuronID i, NeuronID j);
+	/*! Decays the row of the element before returning a pointer to it */
+	virtual AurynWeight * get_ptr(NeuronID i, NeuronID j);
+	virtual AurynWeight get_data(NeuronID i);
+	virtual void set_data(NeuronID i, AurynWeight value);
+	/*! Decays the row before setting the element, such that the pending 
+	 * decay is not applied to the new value again */
+	virtual void set(NeuronID i, NeuronID j, AurynWeight value);
+	virtual bool load_from_file(const char * filename);
+	virtual bool load_from_file(string filename);
+	/*! Connects randomly and marks the new weights as up to date */
+	virtual void connect_random(AurynWeight weight=1.0, float sparseness=0.05, bool skip_diag=false);
+
 	virtual void propagate();
 
 };
@@ -30,7 +30,10 @@
 
 using namespace std;
 
-/*! \brief Records the membrane potential from one unit from the source neuron group to a file.*/
+/*! \brief Records the membrane potential from one unit from the source neuron group to a file.
+ *
+ * To record many neurons use StateRecorder which writes all of them to a single binary file.
+ */
 class VoltageMonitor : protected Monitor
 {
 protected:
@@ -25,12 +25,22 @@ WeightSumMonitor::WeightSumMonitor(Connection * source, string filename, AurynTi
 	init(source,filename,stepsize);
 }
 
+WeightSumMonitor::WeightSumMonitor(Connection * source, OutputContainer * out, string streamname, AurynTime stepsize) : Monitor()
+{
+	init(source,streamname,stepsize);
+	if ( !source->get_destination()->evolve_locally() ) return;
+	container = out;
+	stream = container->add_stream(streamname,CONTAINER_WEIGHTS,2);
+}
+
 WeightSumMonitor::~WeightSumMonitor()
 {
 }
 
 void WeightSumMonitor::init(Connection * source, string filename,AurynTime stepsize)
 {
+	container = NULL;
+	stream = 0;
 	if ( !source->get_destination()->evolve_locally() ) return;
 
 	sys->register_monitor(this);
@@ -45,7 +55,17 @@ void WeightSumMonitor::propagate()
 	if (sys->get_clock()%ssize==0) {
 		AurynFloat mean,std;
 		src->stats(mean,std);
-		outfile << (sys->get_time()) << " " << mean << " "  << std << endl;
+		if ( container != NULL ) {
+			const AurynFloat values [2] = { mean, std };
+			container->append(stream,sys->get_clock(),values);
+		} else
+			outfile << (sys->get_time()) << " " << mean << " "  << std << endl;
 	}
 
 }
+
+void WeightSumMonitor::flush()
+{
+	Monitor::flush();
+	if ( container != NULL ) container->flush();
+}
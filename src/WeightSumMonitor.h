@@ -25,6 +25,7 @@
 #include "Monitor.h"
 #include "System.h"
 #include "Connection.h"
+#include "OutputContainer.h"
 #include <fstream>
 #include <iomanip>
 
@@ -32,6 +33,9 @@ using namespace std;
 
 /*! \brief Records sum and standard deviation of a weight matrix in predefined
  *         intervals.
+ *
+ * Mean and standard deviation can alternatively be written as a stream of 
+ * an OutputContainer with two AurynFloat values per record.
  */
 class WeightSumMonitor : protected Monitor
 {
@@ -39,12 +43,17 @@ protected:
 	Connection * src;
 	AurynTime ssize;
 	NeuronID data_size_limit;
+	OutputContainer * container;
+	unsigned int stream;
 	void init(Connection * source, string filename, AurynTime stepsize);
 	
 public:
 	WeightSumMonitor(Connection * source, string filename, AurynTime stepsize=10000);
+	/*! Writes mean and standard deviation to the stream streamname of container */
+	WeightSumMonitor(Connection * source, OutputContainer * container, string streamname, AurynTime stepsize=10000);
 	virtual ~WeightSumMonitor();
 	void propagate();
+	void flush();
 };
 
 #endif /*WEIGHTSUMMONITOR_H_*/
@@ -39,31 +39,273 @@ const int align)   /* required alignment, in bytes */
 
 NeuronID calculate_vector_size(NeuronID i)
 {
-	if ( i%SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS==0 ) 
+	if ( i%SIMD_VECTOR_PADDING==0 ) 
 		return i;
-	return i+(SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS-i%SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS);
+	return i+(SIMD_VECTOR_PADDING-i%SIMD_VECTOR_PADDING);
 }
 
-inline __m128 sse_load( float * i ) 
+gsl_vector_float * auryn_vector_float_alloc(const NeuronID n)
 {
-#ifdef CODE_ALIGNED_SIMD_INSTRUCTIONS
-	return _mm_load_ps( i );
-#else
-	return _mm_loadu_ps( i );
-#endif
+	gsl_block_float * block = (gsl_block_float *) malloc( sizeof(gsl_block_float) );
+	void * data = NULL;
+	if ( block == NULL || posix_memalign( &data, SIMD_MEMORY_ALIGNMENT, n*sizeof(float) ) ) {
+		::free( block );
+		throw AurynMemoryAlignmentException();
+	}
+	block->size = n;
+	block->data = (float *) data;
+	gsl_vector_float * v = gsl_vector_float_alloc_from_block( block, 0, n, 1 );
+	v->owner = 1; // let gsl_vector_float_free release the block
+	return v;
+}
+
+
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+
+static AurynSimdLevel auryn_detect_simd_level()
+{
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports("avx512f") ) 
+		return AURYN_SIMD_AVX512;
+	if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ) 
+		return AURYN_SIMD_AVX2;
+	return AURYN_SIMD_SSE;
+}
+
+static const AurynSimdLevel auryn_simd_supported = auryn_detect_simd_level();
+static AurynSimdLevel auryn_simd_level = auryn_simd_supported;
+
+/*! Picks the widest kernel which divides the vector size n. Vectors 
+ * allocated by Auryn are padded to SIMD_VECTOR_PADDING, others may 
+ * fall back to narrower kernels. */
+static inline AurynSimdLevel auryn_simd_dispatch(const size_t n)
+{
+	if ( auryn_simd_level == AURYN_SIMD_AVX512 && n%16 == 0 ) 
+		return AURYN_SIMD_AVX512;
+	if ( auryn_simd_level >= AURYN_SIMD_AVX2 && n%8 == 0 ) 
+		return AURYN_SIMD_AVX2;
+	return AURYN_SIMD_SSE;
+}
+
+// AVX2 and FMA kernels. Loads and stores are unaligned such that vectors 
+// which were not allocated by auryn_vector_float_alloc remain safe.
+
+__attribute__((target("avx2,fma")))
+static void avx2_vector_mul( float * a, const float * b, const size_t n )
+{
+	for ( float * i = a ; i != a+n ; i += 8, b += 8 )
+		_mm256_storeu_ps( i, _mm256_mul_ps( _mm256_loadu_ps(i), _mm256_loadu_ps(b) ) );
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_vector_add( float * a, const float * b, const size_t n )
+{
+	for ( float * i = a ; i != a+n ; i += 8, b += 8 )
+		_mm256_storeu_ps( i, _mm256_add_ps( _mm256_loadu_ps(i), _mm256_loadu_ps(b) ) );
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_vector_sub( float * a, const float * b, const size_t n )
+{
+	for ( float * i = a ; i != a+n ; i += 8, b += 8 )
+		_mm256_storeu_ps( i, _mm256_sub_ps( _mm256_loadu_ps(i), _mm256_loadu_ps(b) ) );
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_vector_add_constant( float * a, const float b, const size_t n )
+{
+	const __m256 scalar = _mm256_set1_ps(b);
+	for ( float * i = a ; i != a+n ; i += 8 )
+		_mm256_storeu_ps( i, _mm256_add_ps( _mm256_loadu_ps(i), scalar ) );
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_vector_scale( const float a, float * b, const size_t n )
+{
+	const __m256 scalar = _mm256_set1_ps(a);
+	for ( float * i = b ; i != b+n ; i += 8 )
+		_mm256_storeu_ps( i, _mm256_mul_ps( _mm256_loadu_ps(i), scalar ) );
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_vector_scale_blocks( const float * a, float * b, const size_t blocksize, const size_t nblocks )
+{
+	for ( float * i = b ; i != b+blocksize ; i += 8 ) {
+		float * j = i;
+		for ( size_t k = 0 ; k < nblocks ; ++k ) {
+			_mm256_storeu_ps( j, _mm256_mul_ps( _mm256_loadu_ps(j), _mm256_set1_ps(a[k]) ) );
+			j += blocksize;
+		}
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_vector_saxpy( const float a, const float * x, float * y, const size_t n )
+{
+	// multiply and add separately to round like the SSE kernel
+	const __m256 alpha = _mm256_set1_ps(a);
+	for ( float * i = y ; i != y+n ; i += 8, x += 8 )
+		_mm256_storeu_ps( i, _mm256_add_ps( _mm256_mul_ps( alpha, _mm256_loadu_ps(x) ), _mm256_loadu_ps(i) ) );
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_vector_clip( float * v, const float a, const float b, const size_t n )
+{
+	const __m256 lo = _mm256_set1_ps(a);
+	const __m256 hi = _mm256_set1_ps(b);
+	for ( float * i = v ; i != v+n ; i += 8 )
+		_mm256_storeu_ps( i, _mm256_max_ps( _mm256_min_ps( _mm256_loadu_ps(i), hi ), lo ) );
+}
+
+// AVX-512 kernels
+
+__attribute__((target("avx512f")))
+static void avx512_vector_mul( float * a, const float * b, const size_t n )
+{
+	for ( float * i = a ; i != a+n ; i += 16, b += 16 )
+		_mm512_storeu_ps( i, _mm512_mul_ps( _mm512_loadu_ps(i), _mm512_loadu_ps(b) ) );
+}
+
+__attribute__((target("avx512f")))
+static void avx512_vector_add( float * a, const float * b, const size_t n )
+{
+	for ( float * i = a ; i != a+n ; i += 16, b += 16 )
+		_mm512_storeu_ps( i, _mm512_add_ps( _mm512_loadu_ps(i), _mm512_loadu_ps(b) ) );
+}
+
+__attribute__((target("avx512f")))
+static void avx512_vector_sub( float * a, const float * b, const size_t n )
+{
+	for ( float * i = a ; i != a+n ; i += 16, b += 16 )
+		_mm512_storeu_ps( i, _mm512_sub_ps( _mm512_loadu_ps(i), _mm512_loadu_ps(b) ) );
+}
+
+__attribute__((target("avx512f")))
+static void avx512_vector_add_constant( float * a, const float b, const size_t n )
+{
+	const __m512 scalar = _mm512_set1_ps(b);
+	for ( float * i = a ; i != a+n ; i += 16 )
+		_mm512_storeu_ps( i, _mm512_add_ps( _mm512_loadu_ps(i), scalar ) );
+}
+
+__attribute__((target("avx512f")))
+static void avx512_vector_scale( const float a, float * b, const size_t n )
+{
+	const __m512 scalar = _mm512_set1_ps(a);
+	for ( float * i = b ; i != b+n ; i += 16 )
+		_mm512_storeu_ps( i, _mm512_mul_ps( _mm512_loadu_ps(i), scalar ) );
+}
+
+__attribute__((target("avx512f")))
+static void avx512_vector_scale_blocks( const float * a, float * b, const size_t blocksize, const size_t nblocks )
+{
+	for ( float * i = b ; i != b+blocksize ; i += 16 ) {
+		float * j = i;
+		for ( size_t k = 0 ; k < nblocks ; ++k ) {
+			_mm512_storeu_ps( j, _mm512_mul_ps( _mm512_loadu_ps(j), _mm512_set1_ps(a[k]) ) );
+			j += blocksize;
+		}
+	}
+}
+
+__attribute__((target("avx512f")))
+static void avx512_vector_saxpy( const float a, const float * x, float * y, const size_t n )
+{
+	// multiply and add separately to round like the SSE kernel
+	const __m512 alpha = _mm512_set1_ps(a);
+	for ( float * i = y ; i != y+n ; i += 16, x += 16 )
+		_mm512_storeu_ps( i, _mm512_add_ps( _mm512_mul_ps( alpha, _mm512_loadu_ps(x) ), _mm512_loadu_ps(i) ) );
+}
+
+__attribute__((target("avx512f")))
+static void avx512_vector_clip( float * v, const float a, const float b, const size_t n )
+{
+	const __m512 lo = _mm512_set1_ps(a);
+	const __m512 hi = _mm512_set1_ps(b);
+	for ( float * i = v ; i != v+n ; i += 16 ) {
+		const __m512 chunk = _mm512_loadu_ps(i);
+		_mm512_mask_storeu_ps( i, _mm512_cmp_ps_mask( chunk, hi, _CMP_GT_OQ ), hi );
+		_mm512_mask_storeu_ps( i, _mm512_cmp_ps_mask( chunk, lo, _CMP_LT_OQ ), lo );
+	}
 }
 
-inline void sse_store( float * i, __m128 d ) 
+__attribute__((target("avx512f")))
+static NeuronID avx512_check_thresholds( float * m, float * t, const float thr_rest, 
+		const float reset_mem, const float reset_thr, const NeuronID n, 
+		SpikeContainer * crossings, float * a, const float dadapt )
 {
-#ifdef CODE_ALIGNED_SIMD_INSTRUCTIONS
-	_mm_store_ps( i, d );
+	const NeuronID count = crossings->size();
+	const __m512 c_thr = _mm512_set1_ps(thr_rest);
+	const __m512 r_mem = _mm512_set1_ps(reset_mem);
+	const __m512 r_thr = _mm512_set1_ps(reset_thr);
+	const __m512 d_adapt = _mm512_set1_ps(dadapt);
+	for ( NeuronID i = 0 ; i < n ; i += 16 ) {
+		unsigned int mask = _mm512_cmp_ps_mask( _mm512_loadu_ps(m+i), 
+				_mm512_add_ps( c_thr, _mm512_loadu_ps(t+i) ), _CMP_GT_OQ );
+		if ( n-i < 16 ) mask &= (1u<<(n-i))-1; // padding units must not spike
+		if ( mask == 0 ) continue;
+		_mm512_mask_storeu_ps( m+i, mask, r_mem );
+		_mm512_mask_storeu_ps( t+i, mask, r_thr );
+		if ( a != NULL ) 
+			_mm512_mask_storeu_ps( a+i, mask, _mm512_add_ps( _mm512_loadu_ps(a+i), d_adapt ) );
+		while ( mask ) {
+			crossings->push_back( i+__builtin_ctz(mask) );
+			mask &= mask-1;
+		}
+	}
+	return crossings->size()-count;
+}
+
+AurynSimdLevel auryn_get_simd_level()
+{
+	return auryn_simd_level;
+}
+
+void auryn_set_simd_level(AurynSimdLevel level)
+{
+	if ( level <= auryn_simd_supported ) 
+		auryn_simd_level = level;
+}
+
 #else
-	_mm_storeu_ps( i, d );
+
+AurynSimdLevel auryn_get_simd_level()
+{
+	return AURYN_SIMD_SSE;
+}
+
+void auryn_set_simd_level(AurynSimdLevel level)
+{
+}
+
 #endif
+
+string auryn_simd_level_name(AurynSimdLevel level)
+{
+	switch ( level ) {
+		case AURYN_SIMD_AVX512:
+			return "AVX-512";
+		case AURYN_SIMD_AVX2:
+			return "AVX2+FMA";
+		default:
+			return "SSE";
+	}
 }
 
 void auryn_vector_float_mul( gsl_vector_float * a, gsl_vector_float * b)
 {
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(a->size) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_mul( a->data, b->data, a->size );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_mul( a->data, b->data, a->size );
+			return;
+		default:
+			break;
+	}
+#endif
 #ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
 	float * bd = b->data;
 	for ( float * i = a->data ; i != a->data+a->size ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS )
@@ -80,6 +322,18 @@ void auryn_vector_float_mul( gsl_vector_float * a, gsl_vector_float * b)
 
 void auryn_vector_float_add_constant( gsl_vector_float * a, const float b )
 {
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(a->size) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_add_constant( a->data, b, a->size );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_add_constant( a->data, b, a->size );
+			return;
+		default:
+			break;
+	}
+#endif
 #ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
 	const __m128 scalar = _mm_set1_ps(b);
 	for ( float * i = a->data ; i != a->data+a->size ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS )
@@ -98,6 +352,18 @@ void auryn_vector_float_add_constant( gsl_vector_float * a, const float b )
 
 void auryn_vector_float_scale( const float a, const gsl_vector_float * b )
 {
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(b->size) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_scale( a, b->data, b->size );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_scale( a, b->data, b->size );
+			return;
+		default:
+			break;
+	}
+#endif
 #ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
 	const __m128 scalar = _mm_set1_ps(a);
 	for ( float * i = b->data ; i != b->data+b->size ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS )
@@ -113,8 +379,57 @@ void auryn_vector_float_scale( const float a, const gsl_vector_float * b )
 #endif
 }
 
+void auryn_vector_float_scale_blocks( const float * a, const gsl_vector_float * b, const NeuronID blocksize )
+{
+	const NeuronID nblocks = b->size/blocksize;
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(blocksize) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_scale_blocks( a, b->data, blocksize, nblocks );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_scale_blocks( a, b->data, blocksize, nblocks );
+			return;
+		default:
+			break;
+	}
+#endif
+#ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
+	for ( float * i = b->data ; i != b->data+blocksize ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS )
+	{
+		float * j = i;
+		for ( NeuronID k = 0 ; k < nblocks ; ++k ) {
+			__m128 chunk = sse_load( j );
+			__m128 result = _mm_mul_ps(chunk, _mm_set1_ps(a[k]));
+			sse_store( j, result );
+			j += blocksize;
+		}
+	}
+#else
+	for ( NeuronID i = 0 ; i < blocksize ; ++i ) {
+		float * j = b->data+i;
+		for ( NeuronID k = 0 ; k < nblocks ; ++k ) {
+			*j *= a[k];
+			j += blocksize;
+		}
+	}
+#endif
+}
+
 void auryn_vector_float_saxpy( const float a, const gsl_vector_float * x, const gsl_vector_float * y )
 {
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(y->size) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_saxpy( a, x->data, y->data, y->size );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_saxpy( a, x->data, y->data, y->size );
+			return;
+		default:
+			break;
+	}
+#endif
 	float * xp = x->data;
 #ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
 	const __m128 alpha = _mm_set1_ps(a);
@@ -136,6 +451,18 @@ void auryn_vector_float_saxpy( const float a, const gsl_vector_float * x, const
 
 void auryn_vector_float_add( gsl_vector_float * a, gsl_vector_float * b)
 {
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(a->size) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_add( a->data, b->data, a->size );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_add( a->data, b->data, a->size );
+			return;
+		default:
+			break;
+	}
+#endif
 #ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
 	float * bd = b->data;
 	for ( float * i = a->data ; i != a->data+a->size ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS )
@@ -152,6 +479,18 @@ void auryn_vector_float_add( gsl_vector_float * a, gsl_vector_float * b)
 
 void auryn_vector_float_sub( gsl_vector_float * a, gsl_vector_float * b)
 {
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(a->size) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_sub( a->data, b->data, a->size );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_sub( a->data, b->data, a->size );
+			return;
+		default:
+			break;
+	}
+#endif
 #ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
 	float * bd = b->data;
 	for ( float * i = a->data ; i != a->data+a->size ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS )
@@ -167,6 +506,18 @@ void auryn_vector_float_sub( gsl_vector_float * a, gsl_vector_float * b)
 }
 
 void auryn_vector_float_clip( gsl_vector_float * v, const float a, const float b ) {
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(v->size) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_clip( v->data, a, b, v->size );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_clip( v->data, a, b, v->size );
+			return;
+		default:
+			break;
+	}
+#endif
 #ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
 	const __m128 lo = _mm_set1_ps(a);
 	const __m128 hi = _mm_set1_ps(b);
@@ -189,6 +540,18 @@ void auryn_vector_float_clip( gsl_vector_float * v, const float a, const float b
 }
 
 void auryn_vector_float_clip( gsl_vector_float * v, const float a ) {
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	switch ( auryn_simd_dispatch(v->size) ) {
+		case AURYN_SIMD_AVX512:
+			avx512_vector_clip( v->data, a, 0., v->size );
+			return;
+		case AURYN_SIMD_AVX2:
+			avx2_vector_clip( v->data, a, 0., v->size );
+			return;
+		default:
+			break;
+	}
+#endif
 #ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
 	const __m128 lo = _mm_set1_ps(a);
 	const __m128 hi = _mm_set1_ps(0.);
@@ -203,3 +566,51 @@ void auryn_vector_float_clip( gsl_vector_float * v, const float a ) {
 	auryn_vector_float_clip( v, a, 1e127 );
 #endif
 }
+
+NeuronID auryn_vector_float_check_thresholds( gsl_vector_float * mem, gsl_vector_float * thr, 
+		const float thr_rest, const float reset_mem, const float reset_thr, const NeuronID n, 
+		SpikeContainer * crossings, gsl_vector_float * adapt, const float dadapt )
+{
+	float * m = mem->data;
+	float * t = thr->data;
+	float * a = ( adapt != NULL ) ? adapt->data : NULL;
+#if defined(CODE_USE_RUNTIME_SIMD_DISPATCH) && defined(USE_SIMD_INSTRUCTIONS_EXPLICITLY)
+	if ( auryn_simd_dispatch(mem->size) == AURYN_SIMD_AVX512 ) 
+		return avx512_check_thresholds( m, t, thr_rest, reset_mem, reset_thr, n, crossings, a, dadapt );
+#endif
+	const NeuronID count = crossings->size();
+#ifdef USE_SIMD_INSTRUCTIONS_EXPLICITLY
+	const __m128 c_thr = _mm_set1_ps(thr_rest);
+	const __m128 r_mem = _mm_set1_ps(reset_mem);
+	const __m128 r_thr = _mm_set1_ps(reset_thr);
+	const __m128 d_adapt = _mm_set1_ps(dadapt);
+	const __m128i lanes = _mm_set_epi32(3,2,1,0);
+	for ( NeuronID i = 0 ; i < n ; i += SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS ) {
+		__m128 v_mem = sse_load(m+i);
+		__m128 v_thr = sse_load(t+i);
+		__m128 sel = _mm_cmpgt_ps( v_mem, _mm_add_ps( c_thr, v_thr ) );
+		if ( n-i < SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS ) // padding units must not spike
+			sel = _mm_and_ps( sel, _mm_castsi128_ps( _mm_cmplt_epi32( lanes, _mm_set1_epi32(n-i) ) ) );
+		int mask = _mm_movemask_ps( sel );
+		if ( mask == 0 ) continue;
+		sse_store( m+i, _mm_or_ps( _mm_and_ps( sel, r_mem ), _mm_andnot_ps( sel, v_mem ) ) );
+		sse_store( t+i, _mm_or_ps( _mm_and_ps( sel, r_thr ), _mm_andnot_ps( sel, v_thr ) ) );
+		if ( a != NULL ) 
+			sse_store( a+i, _mm_add_ps( sse_load(a+i), _mm_and_ps( sel, d_adapt ) ) );
+		while ( mask ) {
+			crossings->push_back( i+__builtin_ctz(mask) );
+			mask &= mask-1;
+		}
+	}
+#else
+	for ( NeuronID i = 0 ; i < n ; ++i ) {
+		if ( m[i] > ( thr_rest + t[i] ) ) {
+			crossings->push_back(i);
+			m[i] = reset_mem;
+			t[i] = reset_thr;
+			if ( a != NULL ) a[i] += dadapt;
+		}
+	}
+#endif
+	return crossings->size()-count;
+}
@@ -31,6 +31,7 @@
 #include <limits>
 
 #include <emmintrin.h> // SSE+SSE2
+#include <immintrin.h> // AVX2, FMA and AVX-512 for the dispatched kernels
 
 #include <gsl/gsl_vector_float.h>
 #include <boost/mpi.hpp>
@@ -59,6 +60,40 @@ namespace mpi = boost::mpi;
 
 #define SIMD_NUM_OF_PARALLEL_FLOAT_OPERATIONS 4 //!< SSE can process 4 floats in parallel
 
+#define SIMD_VECTOR_PADDING 16 //!< State vectors are padded to multiples of 16 floats (one AVX-512 register)
+#define SIMD_MEMORY_ALIGNMENT 64 //!< Alignment of state vectors in bytes (one cache line)
+
+/*! Toggle the selection of AVX2+FMA and AVX-512 variants of the
+ * auryn_vector_float kernels at runtime. The widest instruction set
+ * supported by the CPU is determined once at startup via CPUID. The SSE
+ * kernels are used where the wider ones are not available. All variants
+ * multiply and add in separate instructions, such that they round alike
+ * and results do not depend on the CPU a node has. This only holds as
+ * long as the compiler does not contract multiply-adds to FMA, which GCC 
+ * does by default in C++ code compiled for a target with FMA (for 
+ * instance with -march=native, and always in the AVX2 and AVX-512 
+ * variants). Compile with -ffp-contract=off for reproducible rounding
+ * across machines. Requires GCC >= 4.9 or clang on x86.
+ */
+#define CODE_USE_RUNTIME_SIMD_DISPATCH
+
+/*! Toggle transparent huge page backing of large state arenas (see 
+ * StateArena). Only blocks of at least 2MB are affected. */
+#define CODE_USE_HUGE_PAGES_FOR_STATE
+
+/*! Toggle the fused single-pass neuron updates of IFGroup, AIFGroup and
+ * IF2Group. With -ffp-contract=off and without -ffast-math the fused 
+ * kernels give results identical to the multi-pass vector code. Otherwise 
+ * the compiler is free to contract (FMA) and, with -ffast-math, to 
+ * reassociate the fused arithmetic, which changes results by rounding 
+ * errors (about one ulp of the state per time step). Undefine to 
+ * reproduce results of the multi-pass implementation bit by bit.
+ * The fused kernels do not write the intermediate state vectors t_exc, 
+ * t_inh and t_leak, which then can't be recorded with StateMonitor or 
+ * StateRecorder. Undefine to record them.
+ */
+#define CODE_USE_FUSED_NEURON_KERNELS
+
 // #define CODE_COLLECT_SYNC_TIMING_STATS //!< toggle  collection of timing data on sync/all_gather
 
 /*! System wide integration time step */
@@ -134,9 +169,47 @@ typedef vector<pattern_member> type_pattern;
  @param align required alignment, in bytes */
 int auryn_AlignOffset (const int N, const void *vp, const int inc, const int align);  
 
-/*! Rounds vector size to multiple of four to allow using the SSE optimizations. */
+/*! Rounds vector size to multiple of SIMD_VECTOR_PADDING to allow using the SIMD optimizations. */
 NeuronID calculate_vector_size(NeuronID i);
 
+/*! Allocates a gsl_vector_float of size n whose data is aligned to
+ * SIMD_MEMORY_ALIGNMENT bytes. The vector is freed with
+ * gsl_vector_float_free as usual. */
+gsl_vector_float * auryn_vector_float_alloc(const NeuronID n);
+
+/*! Instruction set extensions the auryn_vector_float kernels can dispatch to */
+enum AurynSimdLevel { AURYN_SIMD_SSE, AURYN_SIMD_AVX2, AURYN_SIMD_AVX512 };
+
+/*! Returns the widest instruction set currently used by the vector kernels. */
+AurynSimdLevel auryn_get_simd_level();
+
+/*! Limits the vector kernels to the given instruction set (e.g. to compare
+ * against the SSE kernels). Levels the CPU does not support are ignored. */
+void auryn_set_simd_level(AurynSimdLevel level);
+
+/*! Returns the name of the given instruction set level. */
+string auryn_simd_level_name(AurynSimdLevel level);
+
+/*! Loads four floats into an SSE register (aligned if CODE_ALIGNED_SIMD_INSTRUCTIONS is set). */
+inline __m128 sse_load( float * i ) 
+{
+#ifdef CODE_ALIGNED_SIMD_INSTRUCTIONS
+	return _mm_load_ps( i );
+#else
+	return _mm_loadu_ps( i );
+#endif
+}
+
+/*! Stores four floats from an SSE register (aligned if CODE_ALIGNED_SIMD_INSTRUCTIONS is set). */
+inline void sse_store( float * i, __m128 d ) 
+{
+#ifdef CODE_ALIGNED_SIMD_INSTRUCTIONS
+	_mm_store_ps( i, d );
+#else
+	_mm_storeu_ps( i, d );
+#endif
+}
+
 /*! Internal  version of gsl_vector_float_mul of gsl operations */
 void auryn_vector_float_mul( gsl_vector_float * a, gsl_vector_float * b);
 /*! Internal  version of gsl_vector_float_add gsl operations */
@@ -145,6 +218,9 @@ void auryn_vector_float_add_constant( gsl_vector_float * a, float b );
 void auryn_vector_float_saxpy( const float a, const gsl_vector_float * x, const gsl_vector_float * y );
 /*! Internal  version to scale a vector with a constant b  */
 void auryn_vector_float_scale(const float a, const gsl_vector_float * b );
+/*! Internal  version to scale consecutive blocks of length blocksize in vector b each with its own constant a[k]. 
+ * All blocks are processed in a single pass which is used to decay banks of traces simultaneously. */
+void auryn_vector_float_scale_blocks(const float * a, const gsl_vector_float * b, const NeuronID blocksize );
 /*! Internal  version to clip all the elements of a vector between [a:b]  */
 void auryn_vector_float_clip(gsl_vector_float * v, const float a , const float b );
 /*! Internal  version to clip all the elements of a vector between [a:0]  */
@@ -153,6 +229,13 @@ void auryn_vector_float_clip(gsl_vector_float * v, const float a );
 void auryn_vector_float_add( gsl_vector_float * a, gsl_vector_float * b);
 /*! Internal  version of to subtract GSL vectors */
 void auryn_vector_float_sub( gsl_vector_float * a, gsl_vector_float * b);
+/*! Internal  threshold detection for the first n units of a neuron group. 
+ * Units with mem > thr_rest + thr are appended in ascending order to crossings. 
+ * For these units mem is set to reset_mem, thr to reset_thr and, if adapt is not NULL, 
+ * dadapt is added to adapt using masked SIMD stores. Returns the number of crossings. */
+NeuronID auryn_vector_float_check_thresholds( gsl_vector_float * mem, gsl_vector_float * thr, 
+		const float thr_rest, const float reset_mem, const float reset_thr, const NeuronID n, 
+		SpikeContainer * crossings, gsl_vector_float * adapt = NULL, const float dadapt = 0.0 );
 
 
 class AurynOpenFileException: public exception
@@ -208,7 +291,7 @@ class AurynMemoryAlignmentException: public exception
 {
 	  virtual const char* what() const throw()
 		    {
-				    return "Memory not aligned to 16bytes.";
+				    return "Memory not aligned to SIMD_MEMORY_ALIGNMENT bytes.";
 		    }
 };
 
@@ -228,5 +311,37 @@ class AurynTimeOverFlowException: public exception
 		    }
 };
 
+class AurynBatchSizeException: public exception
+{
+	  virtual const char* what() const throw()
+		    {
+				    return "Group sizes have to be multiples of the number of trials which in turn has to be a multiple of the number of ranks.";
+		    }
+};
+
+class AurynSpikeFileException: public exception
+{
+	  virtual const char* what() const throw()
+		    {
+				    return "Not a valid binary spike file.";
+		    }
+};
+
+class AurynContainerException: public exception
+{
+	  virtual const char* what() const throw()
+		    {
+				    return "Not a valid output container file.";
+		    }
+};
+
+class AurynPrefetcherException: public exception
+{
+	  virtual const char* what() const throw()
+		    {
+				    return "Could not start the producer thread of a SpikePrefetcher or tried to change the state of a group while its producer thread owns it.";
+		    }
+};
+
 
 #endif /*AURYN_DEFINITIONS_H__*/
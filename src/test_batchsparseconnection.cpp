@@ -0,0 +1,151 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Compares the input which BatchSparseConnection delivers to each trial 
+ * with the input of separate single-trial SparseConnections using the same 
+ * matrix and the same presynaptic spikes. When run on several ranks the 
+ * batched groups are distributed while the single-trial groups are 
+ * locked to individual ranks. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "SpikingGroup.h"
+#include "NeuronGroup.h"
+#include "SparseConnection.h"
+#include "BatchSparseConnection.h"
+
+#define NUM_PRE 100
+#define NUM_POST 40
+#define TRIALS 6
+#define STOP_TIME 5000
+#define WEIGHT 0.1
+#define SPARSENESS 0.1
+
+/*! Deterministic spikes at irregular intervals. Unit i of the group 
+ * stands for neuron i*stride+offset. */
+class ClockworkGroup : public SpikingGroup
+{
+	NeuronID stride, offset;
+public:
+	ClockworkGroup(NeuronID n, NeuronID s=1, NeuronID o=0) : SpikingGroup(n) 
+	{
+		sys->register_spiking_group(this);
+		stride = s;
+		offset = o;
+	}
+	static bool fires(AurynTime t, NeuronID i) 
+	{
+		return t < STOP_TIME && ((boost::uint64_t)t*7919+(boost::uint64_t)i*104729)%1009 < 10;
+	}
+	virtual void evolve() 
+	{
+		for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) 
+			if ( fires(sys->get_clock(),rank2global(i)*stride+offset) ) 
+				push_spike(i);
+	}
+};
+
+/*! Sums up all AMPA input each unit receives */
+class SumGroup : public NeuronGroup
+{
+public:
+	vector<double> total;
+	SumGroup(NeuronID n) : NeuronGroup(n) 
+	{
+		sys->register_spiking_group(this);
+		total.resize(get_rank_size(),0.0);
+	}
+	virtual void clear() {}
+	virtual void evolve() 
+	{
+		for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) {
+			total[i] += g_ampa->data[i];
+			g_ampa->data[i] = 0.0;
+		}
+	}
+};
+
+int main(int ac, char* av[]) 
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.%d.log", ".", "test_batchsparseconnection", world.rank() );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	ClockworkGroup * batch_input = new ClockworkGroup(NUM_PRE*TRIALS);
+	SumGroup * batch_output = new SumGroup(NUM_POST*TRIALS);
+	BatchSparseConnection * batch = new BatchSparseConnection(batch_input,batch_output,TRIALS,WEIGHT,SPARSENESS);
+
+	// single-trial connections with a copy of the batched matrix
+	ForwardMatrix * w = batch->w;
+	SumGroup * outputs[TRIALS];
+	for ( NeuronID k = 0 ; k < TRIALS ; ++k ) {
+		ClockworkGroup * input = new ClockworkGroup(NUM_PRE,TRIALS,k);
+		outputs[k] = new SumGroup(NUM_POST);
+		SparseConnection * con = new SparseConnection(input,outputs[k],GLUT);
+		con->allocate_manually(w->get_nonzero());
+		for ( NeuronID i = 0 ; i < NUM_PRE ; ++i ) 
+			for ( NeuronID * c = w->get_row_begin(i) ; c != w->get_row_end(i) ; ++c ) 
+				con->push_back(i,*c,w->get_data_begin()[c-w->get_row_begin(0)]);
+		con->finalize();
+	}
+
+	sys->run((STOP_TIME+10*MINDELAY)*dt);
+
+	// gather the input of all units on all ranks
+	vector<double> local_batch(NUM_POST*TRIALS,0.0);
+	vector<double> local_single(NUM_POST*TRIALS,0.0);
+	for ( NeuronID i = 0 ; i < batch_output->get_rank_size() ; ++i ) 
+		local_batch[batch_output->rank2global(i)] = batch_output->total[i];
+	for ( NeuronID k = 0 ; k < TRIALS ; ++k ) 
+		for ( NeuronID i = 0 ; i < outputs[k]->get_rank_size() ; ++i ) 
+			local_single[outputs[k]->rank2global(i)*TRIALS+k] = outputs[k]->total[i];
+	vector<double> input_batch(NUM_POST*TRIALS);
+	vector<double> input_single(NUM_POST*TRIALS);
+	mpi::all_reduce(world, &local_batch[0], NUM_POST*TRIALS, &input_batch[0], std::plus<double>());
+	mpi::all_reduce(world, &local_single[0], NUM_POST*TRIALS, &input_single[0], std::plus<double>());
+	delete sys;
+
+	bool passed = true;
+	double sum = 0.0;
+	for ( NeuronID i = 0 ; i < NUM_POST*TRIALS ; ++i ) {
+		sum += input_single[i];
+		if ( fabs(input_batch[i]-input_single[i]) > 1e-5*fabs(input_single[i]) ) {
+			if ( world.rank() == 0 ) 
+				cout << "Unit " << i/TRIALS << " trial " << i%TRIALS << ": input " 
+					<< input_batch[i] << " instead of " << input_single[i] << endl;
+			passed = false;
+		}
+	}
+	if ( sum == 0.0 ) passed = false; // nothing was transmitted
+
+	if ( world.rank() == 0 ) 
+		cout << ( passed ? "PASSED" : "FAILED" ) << endl;
+	return passed ? 0 : 1;
+}
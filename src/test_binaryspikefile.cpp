@@ -0,0 +1,219 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Writes a binary spike file, checks the time index and replays it
+ * with a FileInputGroup. The same for a file partitioned by neuron ID. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "BinarySpikeFile.h"
+#include "FileInputGroup.h"
+#include "SpikeMonitor.h"
+
+#include <set>
+
+/*! Checks that the replayed ras files of all ranks together have the
+ * spikes at the right times */
+bool check_replay(const char * prefix, int ranks, const vector< pair<AurynTime,NeuronID> > & spikes)
+{
+	multiset< pair<AurynTime,NeuronID> > replayed;
+	for ( int r = 0 ; r < ranks ; ++r ) {
+		char filename [255];
+		sprintf(filename, "%s.%d.ras", prefix, r);
+		ifstream outfile(filename);
+		double time;
+		NeuronID i;
+		AurynTime last = 0;
+		while ( outfile >> time >> i ) {
+			const AurynTime step = (AurynTime)(time/dt+0.5);
+			if ( step < last ) {
+				cout << filename << ": Replayed spikes out of order" << endl;
+				return false;
+			}
+			last = step;
+			replayed.insert(make_pair(step,i));
+		}
+	}
+	if ( replayed != multiset< pair<AurynTime,NeuronID> >(spikes.begin(),spikes.end()) ) {
+		cout << prefix << ": Replayed " << replayed.size() << " spikes, which differ from the " 
+			<< spikes.size() << " written ones" << endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int ac, char* av[]) 
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.log", ".", "test_binaryspikefile" );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	bool passed = true;
+	const NeuronID size = 100;
+
+	// ras file with irregular gaps, including an empty index interval
+	vector< pair<AurynTime,NeuronID> > spikes;
+	AurynTime t = 3;
+	for ( int k = 0 ; k < 5000 ; ++k ) {
+		t += (k*7919)%13;
+		if ( k == 2500 ) t += 3*BINARYSPIKEFILE_INDEX_INTERVAL;
+		spikes.push_back(make_pair(t,(NeuronID)((k*104729)%size)));
+	}
+
+	// all ranks read the same files, so only rank 0 writes them
+	const NeuronID partitions = 4;
+	if ( world.rank() == 0 ) {
+		ofstream rasfile("test_binaryspikefile.ras");
+		rasfile.setf(ios::fixed);
+		rasfile.precision(4);
+		for ( unsigned int k = 0 ; k < spikes.size() ; ++k )
+			rasfile << spikes[k].first*dt << " " << spikes[k].second << endl;
+		rasfile.close();
+		BinarySpikeWriter::convert_ras("test_binaryspikefile.ras","test_binaryspikefile.bin");
+
+		BinarySpikeWriter * delta = new BinarySpikeWriter("test_binaryspikefile.dlt",dt,BINARYSPIKEFILE_INDEX_INTERVAL,BINARYSPIKE_DELTA);
+		for ( unsigned int k = 0 ; k < spikes.size() ; ++k )
+			delta->write(spikes[k].first,spikes[k].second);
+		delete delta;
+
+		BinarySpikeWriter::convert_ras("test_binaryspikefile.ras","test_binaryspikefile.part",dt,partitions);
+	}
+	world.barrier();
+
+	BinarySpikeFile * bin = new BinarySpikeFile("test_binaryspikefile.bin");
+	if ( bin->get_num_spikes() != spikes.size() || bin->get_size() != size ) {
+		cout << "Wrong number of spikes or size" << endl;
+		passed = false;
+	}
+	for ( unsigned int k = 0 ; k < spikes.size() ; ++k ) {
+		if ( bin->get_events()[k].time != spikes[k].first || bin->get_events()[k].neuron != spikes[k].second ) {
+			cout << "Spike " << k << " differs" << endl;
+			passed = false;
+			break;
+		}
+	}
+	for ( AurynTime q = 0 ; q < t+100 ; q += 97 ) {
+		boost::uint64_t expected = 0;
+		while ( expected < spikes.size() && spikes[expected].first < q ) ++expected;
+		if ( bin->find(q) != expected ) {
+			cout << "find(" << q << ") returned " << bin->find(q) << " instead of " << expected << endl;
+			passed = false;
+			break;
+		}
+	}
+	delete bin;
+
+	// delta encoding round trip
+	BinarySpikeReader reader("test_binaryspikefile.dlt");
+	AurynTime dtime;
+	NeuronID dneuron;
+	for ( unsigned int k = 0 ; k <= spikes.size() ; ++k ) {
+		const bool more = reader.next(dtime,dneuron);
+		if ( more != (k < spikes.size())
+				|| ( more && ( dtime != spikes[k].first || dneuron != spikes[k].second ) ) ) {
+			cout << "Delta-encoded spike " << k << " differs" << endl;
+			passed = false;
+			break;
+		}
+	}
+
+	// partitioned file, each partition only holds its own neurons
+	const set< pair<AurynTime,NeuronID> > all_spikes(spikes.begin(),spikes.end());
+	for ( NeuronID stride = 1 ; stride <= partitions ; ++stride ) {
+		for ( NeuronID residue = 0 ; residue < stride ; ++residue ) {
+			BinarySpikeFile * part = new BinarySpikeFile("test_binaryspikefile.part",stride,residue);
+			const bool selective = partitions%stride == 0;
+			if ( part->get_num_segments() != ( selective ? partitions/stride : partitions ) ) {
+				cout << "Stride " << stride << " selects " << part->get_num_segments() << " partitions" << endl;
+				passed = false;
+			}
+			set< pair<AurynTime,NeuronID> > selected;
+			for ( unsigned int s = 0 ; s < part->get_num_segments() ; ++s ) {
+				const BinarySpikeEvent * events = part->get_events(s);
+				for ( boost::uint64_t k = 0 ; k < part->get_segment_size(s) ; ++k ) {
+					if ( k > 0 && events[k].time < events[k-1].time ) passed = false;
+					selected.insert(make_pair(events[k].time,events[k].neuron));
+				}
+				for ( AurynTime q = 0 ; q < t+100 ; q += 97 ) {
+					const boost::uint64_t pos = part->find(q,s);
+					if ( ( pos > 0 && events[pos-1].time >= q ) 
+							|| ( pos < part->get_segment_size(s) && events[pos].time < q ) ) {
+						cout << "find(" << q << ") in partition " << s << " returned " << pos << endl;
+						passed = false;
+						break;
+					}
+				}
+			}
+			set< pair<AurynTime,NeuronID> > expected;
+			for ( set< pair<AurynTime,NeuronID> >::const_iterator iter = all_spikes.begin() ; iter != all_spikes.end() ; ++iter ) 
+				if ( !selective || iter->second%stride == residue ) expected.insert(*iter);
+			if ( selected != expected ) {
+				cout << "Stride " << stride << " residue " << residue << " selects the wrong spikes" << endl;
+				passed = false;
+			}
+			delete part;
+		}
+	}
+	// the sequential reader merges the partitions in time order
+	BinarySpikeReader part_reader("test_binaryspikefile.part");
+	set< pair<AurynTime,NeuronID> > merged;
+	AurynTime last = 0;
+	while ( part_reader.next(dtime,dneuron) ) {
+		if ( dtime < last ) passed = false;
+		last = dtime;
+		merged.insert(make_pair(dtime,dneuron));
+	}
+	if ( merged != all_spikes ) {
+		cout << "Partitioned file read sequentially differs" << endl;
+		passed = false;
+	}
+
+	// replay and record again, each rank its own neurons
+	FileInputGroup * input = new FileInputGroup(size,"test_binaryspikefile.bin");
+	sprintf(strbuf, "%s.%d.ras", "test_binaryspikefile.out", world.rank() );
+	new SpikeMonitor(input,strbuf);
+	FileInputGroup * part_input = new FileInputGroup(size,"test_binaryspikefile.part");
+	sprintf(strbuf, "%s.%d.ras", "test_binaryspikefile.part.out", world.rank() );
+	new SpikeMonitor(part_input,strbuf);
+	sys->run((t+10)*dt);
+	delete sys;
+	world.barrier();
+
+	if ( world.rank() == 0 ) {
+		if ( !check_replay("test_binaryspikefile.out",world.size(),spikes) ) passed = false;
+		if ( !check_replay("test_binaryspikefile.part.out",world.size(),spikes) ) passed = false;
+	}
+
+	bool all_passed;
+	mpi::all_reduce(world, passed, all_passed, std::logical_and<bool>());
+	if ( world.rank() == 0 ) 
+		cout << ( all_passed ? "PASSED" : "FAILED" ) << endl;
+	return all_passed ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Checks the accuracy of sub-sampled (multi-rate) integration of slow 
+ * variables against the full-rate integration. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "EulerTrace.h"
+#include "EulerTraceBank.h"
+#include "AIF2Group.h"
+#include "PoissonGroup.h"
+#include "IdentityConnection.h"
+
+AurynDouble mean_state(NeuronGroup * group, string key)
+{
+	gsl_vector_float * v = group->get_state_vector(key);
+	AurynDouble sum = 0.;
+	for ( NeuronID i = 0 ; i < group->get_rank_size() ; ++i ) 
+		sum += gsl_vector_float_get(v,i);
+	return sum/group->get_rank_size();
+}
+
+int main(int ac, char* av[]) 
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.log", ".", "test_multirate" );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	bool passed = true;
+	const unsigned int k = 10;
+
+	// traces against the exact solution
+	const double taus [] = { 0.1, 1.0, 20.0 };
+	for ( int t = 0 ; t < 3 ; ++t ) {
+		const double tau = taus[t];
+		EulerTrace * tr_full = new EulerTrace(4,tau);
+		EulerTrace * tr_slow = new EulerTrace(4,tau);
+		EulerTraceBank * bank_full = new EulerTraceBank(4);
+		EulerTraceBank * bank_slow = new EulerTraceBank(4,k,3);
+		bank_full->add(tr_full);
+		bank_slow->add(tr_slow);
+
+		double exact = 0.;
+		double err_full = 0.;
+		double err_slow = 0.;
+		for ( int i = 0 ; i < 500000 ; ++i ) {
+			if ( i % 317 == 0 || i % 1013 == 0 ) {
+				exact += 1.;
+				bank_full->inc(0);
+				bank_slow->inc(0);
+			}
+			bank_full->evolve();
+			bank_slow->evolve();
+			exact *= exp(-dt/tau);
+			err_full = max( err_full, fabs(tr_full->get(0)-exact)/exact );
+			err_slow = max( err_slow, fabs(tr_slow->get(0)-exact)/exact );
+		}
+
+		// the sub-sampled trace lags behind by at most k-1 time steps
+		const double bound = err_full + 1.-exp(-((k-1)*dt)/tau);
+		cout << "trace tau=" << tau << "s  max rel. error full rate " << err_full 
+			<< "  sub-sampled " << err_slow << "  (bound " << bound << ")" << endl;
+		if ( err_slow > bound ) passed = false;
+
+		delete bank_full;
+		delete bank_slow;
+		delete tr_full;
+		delete tr_slow;
+	}
+
+	// adaptation of neuron groups receiving identical input
+	PoissonGroup * poisson = new PoissonGroup(500,2000.);
+	AIF2Group * full = new AIF2Group(500);
+	AIF2Group * slow = new AIF2Group(500);
+	slow->set_adapt_subsampling(k);
+	new IdentityConnection(poisson,full,0.1);
+	new IdentityConnection(poisson,slow,0.1);
+
+	sys->run(5.0);
+
+	cout << scientific << setprecision(6); // reset after progress bar
+	const char * keys [] = { "g_adapt1", "g_adapt2" };
+	for ( int i = 0 ; i < 2 ; ++i ) {
+		AurynDouble a = mean_state(full,keys[i]);
+		AurynDouble b = mean_state(slow,keys[i]);
+		AurynDouble rel = fabs(a-b)/a;
+		cout << keys[i] << " mean full rate " << a << "  sub-sampled " << b 
+			<< "  rel. difference " << rel << endl;
+		if ( rel > 0.01 ) passed = false;
+	}
+
+	cout << ( passed ? "PASSED" : "FAILED" ) << endl;
+
+	delete sys;
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+/*
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+*
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Writes two containers with streams which overlap in time, reads back a
+ * time window, rebuilds the index of containers without footer and merges
+ * the two containers as aucmerge does. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "OutputContainer.h"
+
+#include <set>
+
+typedef multiset< pair<AurynTime,boost::uint32_t> > RecordSet;
+
+/*! Records of a stream with a single value between from and to */
+RecordSet select(const RecordSet & records, AurynTime from, AurynTime to)
+{
+	RecordSet selected;
+	for ( RecordSet::const_iterator iter = records.begin() ; iter != records.end() ; ++iter )
+		if ( iter->first >= from && iter->first <= to ) selected.insert(*iter);
+	return selected;
+}
+
+/*! Reads a stream with a single value and checks that it is sorted by time */
+bool read_stream(ContainerReader & reader, string name, AurynTime from, AurynTime to, RecordSet & records)
+{
+	records.clear();
+	const int stream = reader.find_stream(name);
+	if ( stream < 0 ) {
+		cout << "Stream " << name << " not found" << endl;
+		return false;
+	}
+	vector<AurynTime> times;
+	vector<boost::uint32_t> values;
+	reader.read(stream,from,to,times,values);
+	for ( unsigned int k = 0 ; k < times.size() ; ++k ) {
+		if ( k > 0 && times[k] < times[k-1] ) {
+			cout << "Records of " << name << " are not sorted" << endl;
+			return false;
+		}
+		records.insert(make_pair(times[k],values[k]));
+	}
+	return true;
+}
+
+string read_file(string filename)
+{
+	ifstream infile(filename.c_str(),ios::binary);
+	stringstream oss;
+	oss << infile.rdbuf();
+	return oss.str();
+}
+
+void write_file(string filename, string data)
+{
+	ofstream outfile(filename.c_str(),ios::binary);
+	outfile << data;
+}
+
+bool same_index(const vector<ContainerChunkEntry> & a, const vector<ContainerChunkEntry> & b)
+{
+	if ( a.size() != b.size() ) return false;
+	for ( unsigned int c = 0 ; c < a.size() ; ++c )
+		if ( a[c].stream != b[c].stream || a[c].num_records != b[c].num_records
+				|| a[c].t_first != b[c].t_first || a[c].t_last != b[c].t_last || a[c].offset != b[c].offset )
+			return false;
+	return true;
+}
+
+int main(int ac, char* av[])
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.log", ".", "test_outputcontainer" );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	bool passed = true;
+
+	sprintf(strbuf, "test_outputcontainer.%d", world.rank() );
+	const string prefix = strbuf;
+	const string name_a = prefix+".a.auc";
+	const string name_b = prefix+".b.auc";
+	const string name_merged = prefix+".merged.auc";
+
+	// the two containers share the spike stream, their state streams
+	// differ in the metadata, the rate stream is only in the second one
+	RecordSet spikes_a, spikes_b, states_a, states_b, rates_b;
+	const boost::uint32_t units_a [2] = { 0, 1 };
+	const boost::uint32_t units_b [2] = { 5, 6 };
+	OutputContainer * a = new OutputContainer(name_a,dt,1024,100);
+	const unsigned int a_spikes = a->add_stream("spikes",CONTAINER_SPIKES,1);
+	const unsigned int a_states = a->add_stream("mem",CONTAINER_STATES,1,units_a,sizeof(units_a));
+	for ( AurynTime t = 0 ; t < 3000 ; ++t ) {
+		if ( t%2 == 0 ) {
+			const boost::uint32_t i = t%97;
+			a->append(a_spikes,t,&i);
+			spikes_a.insert(make_pair(t,i));
+		}
+		a->append(a_states,t,&t);
+		states_a.insert(make_pair(t,t));
+	}
+	delete a;
+
+	OutputContainer * b = new OutputContainer(name_b,dt,1024,100);
+	const unsigned int b_spikes = b->add_stream("spikes",CONTAINER_SPIKES,1);
+	const unsigned int b_states = b->add_stream("mem",CONTAINER_STATES,1,units_b,sizeof(units_b));
+	const unsigned int b_rates = b->add_stream("rate",CONTAINER_RATES,1);
+	for ( AurynTime t = 1500 ; t < 4500 ; ++t ) {
+		if ( t%3 == 0 ) {
+			const boost::uint32_t i = (t*7)%89;
+			b->append(b_spikes,t,&i);
+			spikes_b.insert(make_pair(t,i));
+		}
+		const boost::uint32_t v = 2*t;
+		b->append(b_states,t,&v);
+		states_b.insert(make_pair(t,v));
+		if ( t%10 == 0 ) {
+			b->append(b_rates,t,&t);
+			rates_b.insert(make_pair(t,t));
+		}
+	}
+	delete b;
+
+	// merge as aucmerge does
+	vector<string> inputs;
+	inputs.push_back(name_a);
+	inputs.push_back(name_b);
+	const boost::uint64_t merged_records = OutputContainer::merge(name_merged,inputs);
+	if ( merged_records != spikes_a.size()+spikes_b.size()+states_a.size()+states_b.size()+rates_b.size() ) {
+		cout << "Merged " << merged_records << " records" << endl;
+		passed = false;
+	}
+	ContainerReader merged(name_merged);
+	RecordSet records;
+	RecordSet spikes = spikes_a;
+	spikes.insert(spikes_b.begin(),spikes_b.end());
+	if ( merged.get_num_streams() != 4 ) {
+		cout << "Merged container has " << merged.get_num_streams() << " streams" << endl;
+		passed = false;
+	}
+	if ( !read_stream(merged,"spikes",0,10000,records) || records != spikes ) {
+		cout << "Merged spike stream differs" << endl;
+		passed = false;
+	}
+	if ( !read_stream(merged,"mem",0,10000,records) || records != states_a ) {
+		cout << "Merged state stream of the first container differs" << endl;
+		passed = false;
+	}
+	if ( !read_stream(merged,"mem@1",0,10000,records) || records != states_b ) {
+		cout << "Renamed state stream of the second container differs" << endl;
+		passed = false;
+	}
+	if ( merged.find_stream("mem@1") < 0
+			|| merged.get_metadata(merged.find_stream("mem@1")) != vector<char>((char*)units_b,(char*)units_b+sizeof(units_b)) ) {
+		cout << "Renamed state stream has the wrong metadata" << endl;
+		passed = false;
+	}
+	if ( !read_stream(merged,"rate",0,10000,records) || records != rates_b ) {
+		cout << "Merged rate stream differs" << endl;
+		passed = false;
+	}
+	const vector<ContainerChunkEntry> & merged_index = merged.get_index();
+	for ( unsigned int c = 1 ; c < merged_index.size() ; ++c ) {
+		if ( merged_index[c].t_first < merged_index[c-1].t_first ) {
+			cout << "Merged chunks are not sorted by time" << endl;
+			passed = false;
+			break;
+		}
+	}
+
+	// without footer the index is rebuilt from the chunk headers
+	const string data = read_file(name_a);
+	ContainerTrailer trailer;
+	memcpy(&trailer,&data[data.size()-sizeof(trailer)],sizeof(trailer));
+	vector<ContainerChunkEntry> index_a;
+	{
+		ContainerReader reader(name_a);
+		index_a = reader.get_index();
+	}
+	write_file(prefix+".nofooter.auc",data.substr(0,trailer.footer_offset));
+	ContainerReader nofooter(prefix+".nofooter.auc");
+	if ( !same_index(nofooter.get_index(),index_a) || nofooter.get_num_streams() != 2 ) {
+		cout << "Rebuilt index differs" << endl;
+		passed = false;
+	}
+	if ( !read_stream(nofooter,"spikes",0,10000,records) || records != spikes_a ) {
+		cout << "Spikes without footer differ" << endl;
+		passed = false;
+	}
+	// a chunk cut off in the middle is dropped
+	write_file(prefix+".truncated.auc",data.substr(0,index_a.back().offset+sizeof(ContainerChunkHeader)+10));
+	ContainerReader truncated(prefix+".truncated.auc");
+	vector<ContainerChunkEntry> complete(index_a.begin(),index_a.end()-1);
+	if ( !same_index(truncated.get_index(),complete) ) {
+		cout << "Index of truncated container differs" << endl;
+		passed = false;
+	}
+
+	// reading a time window only touches overlapping chunks, which is
+	// checked by breaking the headers of all other chunks
+	const AurynTime from = 1234;
+	const AurynTime to = 1876;
+	string broken = data;
+	unsigned int num_broken = 0;
+	for ( unsigned int c = 0 ; c < index_a.size() ; ++c ) {
+		if ( index_a[c].t_last < from || index_a[c].t_first > to ) {
+			memset(&broken[index_a[c].offset],0,sizeof(boost::uint32_t));
+			++num_broken;
+		}
+	}
+	write_file(prefix+".window.auc",broken);
+	ContainerReader window(prefix+".window.auc");
+	try {
+		if ( !read_stream(window,"spikes",from,to,records) || records != select(spikes_a,from,to) ) {
+			cout << "Spikes in time window differ" << endl;
+			passed = false;
+		}
+		if ( !read_stream(window,"mem",from,to,records) || records != select(states_a,from,to) ) {
+			cout << "States in time window differ" << endl;
+			passed = false;
+		}
+	} catch ( AurynContainerException & e ) {
+		cout << "Read chunks outside of the time window" << endl;
+		passed = false;
+	}
+	if ( num_broken+10 > index_a.size() ) {
+		cout << "Too few chunks outside of the time window" << endl;
+		passed = false;
+	}
+
+	delete sys;
+
+	if ( passed ) {
+		cout << "PASSED" << endl;
+		return 0;
+	}
+	cout << "FAILED" << endl;
+	return 1;
+}
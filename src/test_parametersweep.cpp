@@ -0,0 +1,127 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Runs a ParameterSweep with a monitor which was created before the sweep 
+ * and checks that all children complete and that each child continued the 
+ * output of that monitor. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "PoissonGroup.h"
+#include "IFGroup.h"
+#include "SparseConnection.h"
+#include "SpikeMonitor.h"
+#include "PopulationRateMonitor.h"
+#include "ParameterSweep.h"
+
+#include <unistd.h>
+
+struct SweepNetwork
+{
+	PoissonGroup * input;
+	IFGroup * neurons;
+};
+
+void setup_point(unsigned int point, string prefix, void * data)
+{
+	SweepNetwork * net = (SweepNetwork *)data;
+	net->input->set_rate(5.0+5.0*point);
+	new SpikeMonitor(net->neurons,prefix+".ras");
+}
+
+int main(int ac, char* av[]) 
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.log", ".", "test_parametersweep" );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	bool passed = true;
+	const unsigned int points = 3;
+	const AurynFloat warmup = 0.1;
+	const AurynFloat simtime = 0.2;
+
+	SweepNetwork net;
+	net.input = new PoissonGroup(1000,5.0);
+	net.neurons = new IFGroup(1000);
+	new SparseConnection(net.input,net.neurons,0.3,0.05);
+	new PopulationRateMonitor(net.neurons,"test_parametersweep.prate",1e-2);
+	sys->run(warmup);
+
+	ParameterSweep sweep(setup_point,&net);
+	for ( unsigned int i = 0 ; i < points ; ++i ) {
+		stringstream oss;
+		oss << "test_parametersweep.p" << i;
+		sweep.add_point(oss.str(),simtime);
+	}
+	alarm(600); // a child which does not finish would block the test forever
+	if ( !sweep.run() ) {
+		cout << "Sweep failed" << endl;
+		passed = false;
+	}
+	alarm(0);
+
+	vector<SweepResult> results = sweep.get_results();
+	for ( unsigned int i = 0 ; i < results.size() ; ++i ) {
+		ifstream rasfile((results[i].prefix+".ras").c_str());
+		double time;
+		NeuronID neuron;
+		if ( !( rasfile >> time >> neuron ) ) {
+			cout << "No spikes of point " << i << endl;
+			passed = false;
+		}
+	}
+
+	// every bin after the warmup is written once by each child 
+	ifstream ratefile("test_parametersweep.prate");
+	map<AurynTime,unsigned int> bins;
+	double time, rate;
+	while ( ratefile >> time >> rate ) 
+		if ( time > warmup ) bins[(AurynTime)(time/dt+0.5)]++;
+	if ( bins.empty() ) {
+		cout << "Children did not write to the monitor created before the sweep" << endl;
+		passed = false;
+	}
+	for ( map<AurynTime,unsigned int>::iterator b = bins.begin() ; b != bins.end() ; ++b ) {
+		if ( b->second != points ) {
+			cout << "Bin at " << b->first*dt << "s written " << b->second << " times" << endl;
+			passed = false;
+			break;
+		}
+	}
+
+	delete sys;
+
+	if ( passed ) {
+		cout << "PASSED" << endl;
+		return 0;
+	}
+	cout << "FAILED" << endl;
+	return 1;
+}
@@ -0,0 +1,175 @@
+/*
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+*
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Checks that input groups which prefetch their spikes in a producer
+ * thread give the same spikes as without prefetching. Two ParameterSweep
+ * children continue from the same state, one synchronously and one with
+ * prefetching. A third child is forked while the producer threads of the
+ * parent are running and has to give the same spikes again. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "FileInputGroup.h"
+#include "StimulusGroup.h"
+#include "CorrelatedPoissonGroup.h"
+#include "BinarySpikeFile.h"
+#include "SpikeMonitor.h"
+#include "ParameterSweep.h"
+
+#include <unistd.h>
+
+#define NUM_INPUTS 6
+
+struct PrefetchNetwork
+{
+	FileInputGroup * text;
+	FileInputGroup * binary;
+	StimulusGroup * stimulus [2];
+	CorrelatedPoissonGroup * correlated [2];
+
+	SpikingGroup * get_input(unsigned int k) {
+		SpikingGroup * inputs [NUM_INPUTS] = { text, binary, stimulus[0], stimulus[1], correlated[0], correlated[1] };
+		return inputs[k];
+	}
+
+	void enable_prefetching() {
+		text->enable_prefetching();
+		binary->enable_prefetching();
+		for ( int k = 0 ; k < 2 ; ++k ) {
+			stimulus[k]->enable_prefetching();
+			correlated[k]->enable_prefetching();
+		}
+	}
+};
+
+void setup_point(unsigned int point, string prefix, void * data)
+{
+	PrefetchNetwork * net = (PrefetchNetwork *)data;
+	// the second point of the first sweep starts prefetching in the child
+	if ( point == 1 ) net->enable_prefetching();
+	for ( unsigned int k = 0 ; k < NUM_INPUTS ; ++k ) {
+		stringstream oss;
+		oss << prefix << "." << k << ".ras";
+		new SpikeMonitor(net->get_input(k),oss.str());
+	}
+}
+
+string read_file(string filename)
+{
+	ifstream infile(filename.c_str());
+	stringstream oss;
+	oss << infile.rdbuf();
+	return oss.str();
+}
+
+int main(int ac, char* av[])
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.log", ".", "test_prefetching" );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	bool passed = true;
+	const NeuronID size = 200;
+	const AurynFloat simtime = 2.0;
+
+	// input files
+	ofstream rasfile("test_prefetching.ras");
+	rasfile.setf(ios::fixed);
+	rasfile.precision(4);
+	for ( int k = 0 ; k < 2000 ; ++k )
+		rasfile << (k+1)*2e-4 << " " << (k*104729)%size << endl;
+	rasfile.close();
+	BinarySpikeWriter::convert_ras("test_prefetching.ras","test_prefetching.bin");
+	ofstream patfile("test_prefetching.pat");
+	for ( int p = 0 ; p < 4 ; ++p ) {
+		for ( int i = 0 ; i < 20 ; ++i )
+			patfile << (p*37+i*7)%size << endl;
+		patfile << endl;
+	}
+	patfile.close();
+
+	PrefetchNetwork net;
+	net.text = new FileInputGroup(size,"test_prefetching.ras",true,0.01);
+	net.binary = new FileInputGroup(size,"test_prefetching.bin",true,0.01);
+	for ( int k = 0 ; k < 2 ; ++k ) {
+		net.stimulus[k] = new StimulusGroup(size,"test_prefetching.pat","",RANDOM,5.);
+		net.stimulus[k]->scale = 50.;
+		net.stimulus[k]->set_mean_on_period(0.05);
+		net.stimulus[k]->set_mean_off_period(0.1);
+		net.correlated[k] = new CorrelatedPoissonGroup(size,10.,20,0.02);
+	}
+	net.correlated[1]->set_target_amplitude(2.);
+	sys->run(0.1);
+
+	ParameterSweep sweep(setup_point,&net);
+	sweep.add_point("test_prefetching.sync",simtime);
+	sweep.add_point("test_prefetching.prefetch",simtime);
+	alarm(600); // a child which does not finish would block the test forever
+	if ( !sweep.run() ) {
+		cout << "Sweep failed" << endl;
+		passed = false;
+	}
+
+	// the producer threads are running when the child is forked
+	net.enable_prefetching();
+	ParameterSweep fork_sweep(setup_point,&net);
+	fork_sweep.add_point("test_prefetching.fork",simtime);
+	if ( !fork_sweep.run() ) {
+		cout << "Sweep of prefetching parent failed" << endl;
+		passed = false;
+	}
+	alarm(0);
+
+	const char * modes [2] = { "prefetch", "fork" };
+	for ( unsigned int k = 0 ; k < NUM_INPUTS ; ++k ) {
+		sprintf(strbuf, "test_prefetching.%s.%d.ras", "sync", k);
+		const string expected = read_file(strbuf);
+		if ( expected.size() < 1000 ) {
+			cout << "Too few spikes of input " << k << endl;
+			passed = false;
+		}
+		for ( int m = 0 ; m < 2 ; ++m ) {
+			sprintf(strbuf, "test_prefetching.%s.%d.ras", modes[m], k);
+			if ( read_file(strbuf) != expected ) {
+				cout << "Spikes of input " << k << " differ with " << modes[m] << endl;
+				passed = false;
+			}
+		}
+	}
+
+	delete sys;
+
+	if ( passed ) {
+		cout << "PASSED" << endl;
+		return 0;
+	}
+	cout << "FAILED" << endl;
+	return 1;
+}
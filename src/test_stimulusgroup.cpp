@@ -0,0 +1,245 @@
+/*
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+*
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Checks the spike statistics and the stimulus order of StimulusGroup.
+ * Units fire at their pattern rate while their pattern is shown and not
+ * at all otherwise. Spike times further ahead than one revolution of the
+ * timing wheel follow the exponential interval distribution. Stimuli are
+ * drawn according to a non-uniform distribution. Counts have to lie within
+ * four standard deviations of their expectation. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "StimulusGroup.h"
+#include "SpikeMonitor.h"
+
+#define NUM_PATTERNS 4
+#define PATTERN_SIZE 10
+
+/*! Returns true if count is within four standard deviations of a binomial or Poisson expectation */
+bool plausible(double count, double expected, double p=0.0)
+{
+	return fabs(count-expected) <= 4.0*sqrt(expected*(1.0-p))+1.0;
+}
+
+/*! Reads a ras file into one list of spike times per unit */
+vector< vector<AurynTime> > read_spikes(string filename, NeuronID size)
+{
+	vector< vector<AurynTime> > spikes(size);
+	ifstream infile(filename.c_str());
+	double time;
+	NeuronID i;
+	while ( infile >> time >> i )
+		spikes[i].push_back((AurynTime)(time/dt+0.5));
+	return spikes;
+}
+
+/*! Reads a stimulus time series file as time steps and the index of the shown pattern or -1 */
+vector< pair<AurynTime,int> > read_sequence(string filename)
+{
+	vector< pair<AurynTime,int> > sequence;
+	ifstream infile(filename.c_str());
+	string line;
+	while ( getline(infile,line) ) {
+		istringstream iss(line);
+		double time;
+		iss >> time;
+		int shown = -1;
+		int flag;
+		for ( int k = 0 ; iss >> flag ; ++k )
+			if ( flag ) shown = k;
+		sequence.push_back(make_pair((AurynTime)(time/dt+0.5),shown));
+	}
+	return sequence;
+}
+
+int main(int ac, char* av[])
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.log", ".", "test_stimulusgroup" );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	bool passed = true;
+	const NeuronID size = 100;
+	const AurynFloat simtime = 50.0;
+	const AurynTime steps = (AurynTime)(simtime/dt+0.5);
+	const AurynFloat on_rate = 50.0;
+	const AurynFloat base_rate = 5.0;
+	const AurynFloat slow_rate = 0.2;
+
+	// disjoint patterns, units from NUM_PATTERNS*PATTERN_SIZE on are in none
+	if ( world.rank() == 0 ) {
+		ofstream patfile("test_stimulusgroup.pat");
+		for ( int p = 0 ; p < NUM_PATTERNS ; ++p ) {
+			for ( int i = 0 ; i < PATTERN_SIZE ; ++i )
+				patfile << p*PATTERN_SIZE+i << " 1" << endl;
+			patfile << endl;
+		}
+		patfile.close();
+		ofstream slowfile("test_stimulusgroup.slow.pat");
+		for ( NeuronID i = 0 ; i < size ; ++i )
+			slowfile << i << endl;
+		slowfile << endl;
+		slowfile.close();
+	}
+	world.barrier();
+
+	// rates during on and off periods
+	sprintf(strbuf, "test_stimulusgroup.rates.%d", world.rank() );
+	const string rates_prefix = strbuf;
+	StimulusGroup * rates = new StimulusGroup(size,"test_stimulusgroup.pat",rates_prefix+".tiser",RANDOM,base_rate);
+	rates->scale = on_rate;
+	rates->set_mean_on_period(0.2);
+	rates->set_mean_off_period(0.3);
+	new SpikeMonitor(rates,rates_prefix+".ras");
+
+	// one pattern shown throughout with intervals of mostly more than one wheel revolution
+	sprintf(strbuf, "test_stimulusgroup.slow.%d", world.rank() );
+	const string slow_prefix = strbuf;
+	StimulusGroup * slow = new StimulusGroup(size,"test_stimulusgroup.slow.pat","",SEQUENTIAL,0.0);
+	slow->scale = slow_rate;
+	slow->randomintervals = false;
+	slow->set_mean_on_period(2*simtime);
+	new SpikeMonitor(slow,slow_prefix+".ras");
+
+	// stimulus order with a non-uniform distribution
+	sprintf(strbuf, "test_stimulusgroup.order.%d", world.rank() );
+	const string order_prefix = strbuf;
+	StimulusGroup * order = new StimulusGroup(size,"test_stimulusgroup.pat",order_prefix+".tiser",RANDOM,0.0);
+	order->randomintervals = false;
+	order->set_mean_on_period(10*dt);
+	order->set_mean_off_period(10*dt);
+	double probs [NUM_PATTERNS] = { 0.5, 0.0, 0.125, 0.375 };
+	order->set_distribution(vector<double>(probs,probs+NUM_PATTERNS));
+
+	sys->run(simtime);
+	// deleting System deletes the groups
+	vector<bool> local(size);
+	for ( NeuronID i = 0 ; i < size ; ++i )
+		local[i] = rates->localrank(i);
+	const NeuronID slow_rank_size = slow->get_rank_size();
+	const bool order_local = order->evolve_locally();
+	delete sys;
+
+	// time steps each pattern was shown and the spikes in and outside of them
+	vector< pair<AurynTime,int> > sequence = read_sequence(rates_prefix+".tiser");
+	vector< vector<AurynTime> > spikes = read_spikes(rates_prefix+".ras",size);
+	vector<AurynTime> shown_steps(NUM_PATTERNS,0);
+	for ( unsigned int k = 0 ; k < sequence.size() ; ++k ) {
+		const AurynTime end = k+1 < sequence.size() ? sequence[k+1].first : steps;
+		if ( sequence[k].second >= 0 ) shown_steps[sequence[k].second] += end-sequence[k].first;
+	}
+	unsigned int implausible = 0;
+	unsigned int spikes_outside = 0;
+	for ( NeuronID i = 0 ; i < size ; ++i ) {
+		if ( !local[i] ) continue;
+		const int pattern = i < NUM_PATTERNS*PATTERN_SIZE ? i/PATTERN_SIZE : -1;
+		unsigned int inside = 0;
+		unsigned int k = 0;
+		for ( unsigned int s = 0 ; s < spikes[i].size() ; ++s ) {
+			// a spike belongs to the last entry at or before its time step
+			while ( k+1 < sequence.size() && sequence[k+1].first <= spikes[i][s] ) ++k;
+			if ( pattern >= 0 && sequence[k].second == pattern ) ++inside;
+			else ++spikes_outside;
+		}
+		if ( pattern >= 0 && !plausible(inside,(on_rate+base_rate)*shown_steps[pattern]*dt) ) {
+			cout << "Unit " << i << " fired " << inside << " times in "
+				<< shown_steps[pattern]*dt << "s of its pattern" << endl;
+			++implausible;
+		}
+	}
+	if ( implausible > 0 || spikes_outside > 0 ) {
+		cout << spikes_outside << " spikes outside of the patterns" << endl;
+		passed = false;
+	}
+
+	// exponential intervals, also beyond one revolution of the wheel
+	spikes = read_spikes(slow_prefix+".ras",size);
+	const unsigned int num_bins = 12;
+	vector<unsigned int> histogram(num_bins,0);
+	unsigned int num_intervals = 0;
+	unsigned int num_spikes = 0;
+	for ( NeuronID i = 0 ; i < size ; ++i ) {
+		num_spikes += spikes[i].size();
+		for ( unsigned int s = 1 ; s < spikes[i].size() ; ++s ) {
+			const AurynTime interval = spikes[i][s]-spikes[i][s-1];
+			histogram[min(interval/STIMULUSGROUP_WHEEL_SIZE,num_bins-1)]++;
+			++num_intervals;
+		}
+	}
+	const double expected_spikes = slow_rate*simtime*slow_rank_size;
+	if ( !plausible(num_spikes,expected_spikes) ) {
+		cout << "Slow units fired " << num_spikes << " instead of " << expected_spikes << " times" << endl;
+		passed = false;
+	}
+	// the interval is one step more than the drawn number of steps
+	const double lambda = slow_rate*dt;
+	for ( unsigned int b = 0 ; b < num_bins ; ++b ) {
+		const double p_from = exp(-lambda*((double)b*STIMULUSGROUP_WHEEL_SIZE-1.0));
+		const double p_to = b+1 < num_bins ? exp(-lambda*((b+1.0)*STIMULUSGROUP_WHEEL_SIZE-1.0)) : 0.0;
+		const double p = min(1.0,p_from)-p_to;
+		if ( !plausible(histogram[b],num_intervals*p,p) ) {
+			cout << histogram[b] << " intervals in revolution " << b
+				<< " of the wheel instead of " << num_intervals*p << endl;
+			passed = false;
+		}
+	}
+
+	// each line after a switch shows the new stimulus, small groups
+	// are locked to one rank which writes the stimulus file
+	if ( order_local ) {
+		sequence = read_sequence(order_prefix+".tiser");
+		vector<unsigned int> presentations(NUM_PATTERNS,0);
+		unsigned int num_presentations = 0;
+		for ( unsigned int k = 1 ; k < sequence.size() ; k += 2 ) {
+			if ( sequence[k].second < 0 ) continue;
+			presentations[sequence[k].second]++;
+			++num_presentations;
+		}
+		if ( num_presentations < 10000 ) {
+			cout << "Only " << num_presentations << " stimuli shown" << endl;
+			passed = false;
+		}
+		for ( int p = 0 ; p < NUM_PATTERNS ; ++p ) {
+			if ( !plausible(presentations[p],num_presentations*probs[p],probs[p])
+					|| ( probs[p] == 0.0 && presentations[p] > 0 ) ) {
+				cout << "Pattern " << p << " shown " << presentations[p] << " of "
+					<< num_presentations << " times" << endl;
+				passed = false;
+			}
+		}
+	}
+
+	bool all_passed;
+	mpi::all_reduce(world, passed, all_passed, std::logical_and<bool>());
+	if ( world.rank() == 0 )
+		cout << ( all_passed ? "PASSED" : "FAILED" ) << endl;
+	return all_passed ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+/* 
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+* 
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+* 
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Checks the efficacies transmitted by STPConnection in the sender-side
+ * and the receiver-side mode against an offline computation. Each 
+ * postsynaptic group has a single neuron, so when run on two ranks one 
+ * rank has no postsynaptic neurons. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "SpikingGroup.h"
+#include "NeuronGroup.h"
+#include "STPConnection.h"
+
+#define NUM_PRE 200
+#define STOP_TIME 5000
+#define WEIGHT 0.1
+
+/*! Deterministic presynaptic spikes at irregular intervals */
+class ClockworkGroup : public SpikingGroup
+{
+public:
+	ClockworkGroup(NeuronID n) : SpikingGroup(n) 
+	{
+		sys->register_spiking_group(this);
+	}
+	static bool fires(AurynTime t, NeuronID i) 
+	{
+		return t < STOP_TIME && ((boost::uint64_t)t*7919+(boost::uint64_t)i*104729)%1009 < 10;
+	}
+	virtual void evolve() 
+	{
+		for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) 
+			if ( fires(sys->get_clock(),rank2global(i)) ) 
+				push_spike(i);
+	}
+};
+
+/*! Sums up all AMPA input it receives */
+class SumGroup : public NeuronGroup
+{
+public:
+	double total;
+	SumGroup() : NeuronGroup(1) 
+	{
+		sys->register_spiking_group(this);
+		total = 0.0;
+	}
+	virtual void clear() {}
+	virtual void evolve() 
+	{
+		for ( NeuronID i = 0 ; i < get_rank_size() ; ++i ) {
+			total += g_ampa->data[i];
+			g_ampa->data[i] = 0.0;
+		}
+	}
+};
+
+int main(int ac, char* av[]) 
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.%d.log", ".", "test_stpconnection", world.rank() );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	ClockworkGroup * input = new ClockworkGroup(NUM_PRE);
+	SumGroup * sender = new SumGroup();
+	SumGroup * receiver = new SumGroup();
+	STPConnection * con_sender = new STPConnection(input,sender,WEIGHT,1.0);
+	STPConnection * con_receiver = new STPConnection(input,receiver,WEIGHT,1.0);
+	con_receiver->set_receiver_side();
+
+	sys->run((STOP_TIME+10*MINDELAY)*dt);
+
+	// offline computation of the efficacies with the same float state
+	vector<double> efficacy_sum(NUM_PRE,0.0);
+	vector<float> state_x(NUM_PRE,1.0);
+	vector<float> state_u(NUM_PRE,con_sender->Ujump);
+	vector<AurynTime> last_update(NUM_PRE,0);
+	for ( AurynTime t = 0 ; t < STOP_TIME ; ++t ) {
+		for ( NeuronID i = 0 ; i < NUM_PRE ; ++i ) {
+			if ( !ClockworkGroup::fires(t,i) ) continue;
+			const AurynDouble elapsed = dt*(t-last_update[i]);
+			last_update[i] = t;
+			const double x = 1.0 - (1.0-state_x[i])*exp(-elapsed/con_sender->tau_d);
+			const double u = con_sender->Ujump + (state_u[i]-con_sender->Ujump)*exp(-elapsed/con_sender->tau_f);
+			state_x[i] = x-u*x;
+			state_u[i] = u+con_sender->Ujump*(1-u);
+			efficacy_sum[i] += x*u;
+		}
+	}
+
+	bool passed = true;
+	SumGroup * groups[2] = { sender, receiver };
+	STPConnection * cons[2] = { con_sender, con_receiver };
+	const char * names[2] = { "sender-side", "receiver-side" };
+	for ( int k = 0 ; k < 2 ; ++k ) {
+		if ( !groups[k]->evolve_locally() ) continue;
+		double expected = 0.0;
+		ForwardMatrix * w = cons[k]->w;
+		for ( NeuronID i = 0 ; i < NUM_PRE ; ++i ) 
+			for ( NeuronID * c = w->get_row_begin(i) ; c != w->get_row_end(i) ; ++c ) 
+				expected += w->get_data_begin()[c-w->get_row_begin(0)]*efficacy_sum[i];
+		if ( fabs(groups[k]->total-expected) > 1e-5*expected ) {
+			cout << "Rank " << world.rank() << ": " << names[k] << " input " 
+				<< groups[k]->total << " instead of " << expected << endl;
+			passed = false;
+		}
+	}
+	delete sys;
+
+	bool all_passed;
+	mpi::all_reduce(world, passed, all_passed, std::logical_and<bool>());
+	if ( world.rank() == 0 ) 
+		cout << ( all_passed ? "PASSED" : "FAILED" ) << endl;
+	return all_passed ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/*
+* Copyright 2014 Friedemann Zenke
+*
+* This file is part of Auryn, a simulation package for plastic
+* spiking neural networks.
+*
+* Auryn is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Auryn is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Auryn.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Checks TripletDecayConnection with lazy decay against the same
+ * connection with the periodic decay sweep. Weights which are set in the
+ * middle of the run and then read back through the accessors, the stats
+ * and a WeightMonitor have to carry the decay of the remaining run. */
+
+#include "auryn_global.h"
+#include "System.h"
+#include "Logger.h"
+#include "PoissonGroup.h"
+#include "IFGroup.h"
+#include "TripletDecayConnection.h"
+#include "WeightMonitor.h"
+
+#define WREST 0.05
+#define WSET 0.5
+
+vector<double> read_weights(const char * filename)
+{
+	vector<double> weights;
+	ifstream infile(filename);
+	double time,first,second;
+	while ( infile >> time >> first >> second ) {
+		weights.push_back(first);
+		weights.push_back(second);
+	}
+	return weights;
+}
+
+int main(int ac, char* av[])
+{
+	// BEGIN Global stuff
+	mpi::environment env(ac, av);
+	mpi::communicator world;
+	communicator = &world;
+
+	char strbuf [255];
+	sprintf(strbuf, "%s/%s.log", ".", "test_tripletdecayconnection" );
+	string logfile = strbuf;
+	logger = new Logger(logfile,world.rank(),PROGRESS,EVERYTHING);
+
+	sys = new System(&world);
+	// END Global stuff
+
+	bool passed = true;
+
+	PoissonGroup * poisson = new PoissonGroup(200,5.);
+	IFGroup * neurons = new IFGroup(100);
+
+	// decay time scale of 10s, i.e. one decay step every 100 time steps
+	TripletDecayConnection * lazy = new TripletDecayConnection(poisson,neurons,0.1,0.1,10.,1.,10.,3.,WREST,1.);
+	lazy->set_lazy_decay();
+	lazy->write_to_file("test_tripletdecayconnection.wmat");
+	TripletDecayConnection * eager = new TripletDecayConnection(poisson,neurons,
+			"test_tripletdecayconnection.wmat",10.,1.,10.,3.,WREST,1.);
+
+	// the first element of row 0 and one in the middle of the data
+	NeuronID i = 0;
+	NeuronID j = *(lazy->w->get_row_begin(i));
+	NeuronID k = lazy->w->get_nonzero()/2;
+	WeightMonitor * lazy_monitor = new WeightMonitor(lazy,"test_tripletdecayconnection.lazy.syn",0.1);
+	lazy_monitor->add_to_list(i,j);
+	lazy_monitor->add_to_list(lazy->w->get_data_begin()+k);
+	WeightMonitor * eager_monitor = new WeightMonitor(eager,"test_tripletdecayconnection.eager.syn",0.1);
+	eager_monitor->add_to_list(i,j);
+	eager_monitor->add_to_list(eager->w->get_data_begin()+k);
+
+	sys->run(1.0);
+	lazy->set(i,j,WSET);
+	eager->set(i,j,WSET);
+	lazy->set_data(k,WSET);
+	eager->set_data(k,WSET);
+	sys->run(2.0);
+
+	// without the decay the set weights would stay at WSET
+	const AurynWeight decayed = WREST+pow(TRIPLETDECAYCONNECTION_EULERUPGRADE_STEP,200)*(WSET-WREST);
+	cout << endl << scientific << "set weight " << lazy->get(i,j)
+		<< " (periodic decay " << eager->get(i,j) << ", without spikes " << decayed << ")" << endl;
+	if ( fabs(lazy->get(i,j)-eager->get(i,j)) > 1e-5 ) passed = false;
+	if ( lazy->get(i,j) > 0.5*(decayed+WSET) ) passed = false;
+	if ( fabs(lazy->get_data(k)-eager->get_data(k)) > 1e-5 ) passed = false;
+
+	AurynFloat lazy_mean, lazy_std, eager_mean, eager_std;
+	lazy->stats(lazy_mean,lazy_std);
+	eager->stats(eager_mean,eager_std);
+	cout << "mean weight " << lazy_mean << " (periodic decay " << eager_mean << ")" << endl;
+	if ( fabs(lazy_mean-eager_mean) > 1e-5 || fabs(lazy_std-eager_std) > 1e-5 ) passed = false;
+
+	AurynDouble max_diff = 0.;
+	for ( AurynLong l = 0 ; l < lazy->w->get_nonzero() ; ++l )
+		max_diff = max( max_diff, (AurynDouble)fabs(lazy->get_data(l)-eager->get_data(l)) );
+	cout << "max. weight difference " << max_diff << endl;
+	if ( max_diff > 1e-5 ) passed = false;
+
+	delete sys;
+
+	vector<double> lazy_trace = read_weights("test_tripletdecayconnection.lazy.syn");
+	vector<double> eager_trace = read_weights("test_tripletdecayconnection.eager.syn");
+	if ( lazy_trace.size() != eager_trace.size() || lazy_trace.size() < 60 )
+		passed = false;
+	else
+		for ( unsigned int l = 0 ; l < lazy_trace.size() ; ++l )
+			if ( fabs(lazy_trace[l]-eager_trace[l]) > 1e-5 ) passed = false;
+
+	if ( passed ) {
+		cout << "PASSED" << endl;
+		return 0;
+	}
+	cout << "FAILED" << endl;
+	return 1;
+}